@@ -32,12 +32,16 @@ Centroid::Centroid()
 {
   inSize_ = DEFAULT_WIN_SIZE;
   outSize_ = 1;
+  featSize_ = outSize_;
+  featNames_.push_back("Centroid");
 }
 
 Centroid::Centroid(unsigned int inSize)
 {
   inSize_ = inSize;
   outSize_ = 1;
+  featSize_ = outSize_;
+  featNames_.push_back("Centroid");
 }
 
 Centroid::~Centroid()
@@ -27,6 +27,10 @@ of communicator.
 
 
 #include "Communicator.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
 
 
 Communicator::Communicator()
@@ -39,5 +43,50 @@ Communicator::~Communicator()
 }
 
 
+void
+Communicator::send_vector(const float *data, unsigned int size)
+{
+  unsigned int i;
+  char buf[256];
+  sprintf(buf, "%i\n", size);
+  send_message(buf);
+  for (i=0; i<size; i++)
+    {
+      sprintf(buf, "%f\n", data[i]);
+      send_message(buf);
+    }
+  cerr << "fvec::send " << size << " numbers were sent to the client\n";
+}
+
+
+unsigned int
+Communicator::text_to_vector(string message, float *data, unsigned int capacity)
+{
+  const char *p = message.c_str();
+  char *end;
+  unsigned int n = 0;
+  while (n < capacity)
+    {
+      double value = strtod(p, &end);
+      if (end == p)
+	break;
+      data[n++] = (float)value;
+      p = end;
+    }
+  return n;
+}
+
+
+void
+Communicator::vector_to_text(const float *data, unsigned int size, char *message)
+{
+  unsigned int i;
+  int len = 0;
+  message[0] = '\0';
+  for (i=0; i<size && len < MAX_MESSAGE - 20; i++)
+    len += sprintf(message + len, i ? " %g" : "%g", data[i]);
+}
+
+
 
 	
@@ -22,7 +22,8 @@
     \brief Abstract base class for communicator
 
     Abstract base class for a send/receive string message type 
-of communicator. 
+of communicator. Vectors (see fvec::send) go out as text messages 
+unless a communicator can carry them directly (send_vector).
 */
 
 
@@ -43,6 +44,13 @@ public:
   virtual ~Communicator();
   virtual void send_message(string message) =0;
   virtual void receive_message(char *message)=0;
+  // one whole vector; by default its size and values as text messages
+  virtual void send_vector(const float *data, unsigned int size);
+
+protected:
+  // whitespace separated numbers <-> vector (text at most MAX_MESSAGE)
+  static unsigned int text_to_vector(string message, float *data, unsigned int capacity);
+  static void vector_to_text(const float *data, unsigned int size, char *message);
 };
 
 
@@ -40,6 +40,8 @@ Flux::Flux()
   prevWindow_.create(inSize_);
   diffWindow_.create(inSize_);
   normWindow_.create(inSize_);
+  featSize_ = outSize_;
+  featNames_.push_back("Flux");
 }
 
 Flux::Flux(unsigned int inSize)
@@ -50,6 +52,8 @@ Flux::Flux(unsigned int inSize)
   prevWindow_.create(inSize_);
   diffWindow_.create(inSize_);
   normWindow_.create(inSize_);
+  featSize_ = outSize_;
+  featNames_.push_back("Flux");
 }
 
 Flux::~Flux()
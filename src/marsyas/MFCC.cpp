@@ -61,11 +61,6 @@ MFCC::init()
   unsigned int i,j;
   unsigned int chan;
   
-  if (inSize_ != DEFAULT_WIN_SIZE) 
-    {
-      cerr << "MFCC::init warning inSize_ != 512\n" << endl ;
-    }
-  
   // Initialize frequency boundaries for the filters 
   freqs_.create(42);
   lowestFrequency_ = 133.3333f;
@@ -105,7 +100,8 @@ MFCC::init()
   for (i=0; i<totalFilters_; i++)
     triangle_heights_(i) = 2.0 / (upper_(i) - lower_(i));
  
-  fftSize_ = 512;
+  // filterbank covers the (mirrored) magnitude, one weight per bin
+  fftSize_ = inSize_;
   samplingRate_ = 22050;
   fftFreqs_.create(fftSize_);
   cepstralCoefs_ = 13;
@@ -33,12 +33,16 @@ RMS::RMS()
 {
   inSize_ = DEFAULT_WIN_SIZE;
   outSize_ = 1;
+  featSize_ = outSize_;
+  featNames_.push_back("RMS");
 }
 
 RMS::RMS(unsigned int inSize)
 {
   inSize_ = inSize;
   outSize_ = 1;
+  featSize_ = outSize_;
+  featNames_.push_back("RMS");
 }
 
 RMS::~RMS()
@@ -37,6 +37,7 @@ Rolloff::Rolloff()
   outSize_ = 1;
   perc_ = 0.80f;
   sumWindow_.create(DEFAULT_WIN_SIZE);
+  initNames();
 }
 
 Rolloff::Rolloff(unsigned int inSize, float perc)
@@ -45,6 +46,17 @@ Rolloff::Rolloff(unsigned int inSize, float perc)
   perc_ = perc;
   outSize_ = 1;
   sumWindow_.create(inSize_);
+  initNames();
+}
+
+void
+Rolloff::initNames()
+{
+  // e.g. Rolloff80 for the 80% rolloff
+  char name[32];
+  sprintf(name, "Rolloff%02d", (int)(perc_ * 100 + 0.5f));
+  featSize_ = outSize_;
+  featNames_.push_back(name);
 }
 
 
@@ -30,6 +30,7 @@ class Rolloff: public System
 private:
   float perc_;
   fvec sumWindow_;
+  void initNames();
 public:
   Rolloff();
   Rolloff(unsigned int inSize, float perc);
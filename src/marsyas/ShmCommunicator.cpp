@@ -0,0 +1,297 @@
+/**
+   \class ShmCommunicator
+   \brief Communicator over a ring of vectors in POSIX shared memory
+
+   Layout of the shared memory: one 64-byte header, then 'slots'
+slots, each a 64-byte aligned (seq, size, data[capacity]).
+*/
+
+#include "ShmCommunicator.h"
+#include <stdio.h>
+#include <string.h>
+#include <iostream>
+
+#if !defined(_WIN32)
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define SHM_MAGIC "MRSRING1"
+#define SHM_VERSION 1
+#define SHM_ALIGN 64
+
+struct ShmRingHeader
+{
+  char magic[8];
+  unsigned int version;
+  unsigned int slots;
+  unsigned int capacity;
+  unsigned int slotBytes;
+  // last published sequence number (0: nothing yet)
+  volatile unsigned long long head;
+  char pad[SHM_ALIGN - 32];
+};
+
+struct ShmSlot
+{
+  // sequence number of the vector in the slot, 0 while it's rewritten
+  volatile unsigned long long seq;
+  unsigned int size;
+  unsigned int pad;
+  float data[1];
+};
+
+// orders the slot's number and data between processes
+static inline void
+shm_fence()
+{
+#if defined(__GNUC__)
+  __sync_synchronize();
+#endif
+}
+
+
+ShmCommunicator::ShmCommunicator(string name, unsigned int capacity, unsigned int slots)
+{
+  name_ = name[0] == '/' ? name : "/" + name;
+  writer_ = true;
+  slots_ = slots ? slots : 1;
+  capacity_ = capacity ? capacity : 1;
+  slotBytes_ = (sizeof(ShmSlot) - sizeof(float) + capacity_ * sizeof(float) + SHM_ALIGN - 1)
+    & ~(SHM_ALIGN - 1);
+  base_ = NULL;
+  header_ = NULL;
+  next_ = 1;
+
+  if (!map(true))
+    cerr << "ShmCommunicator: cannot create " << name_ << endl;
+}
+
+
+ShmCommunicator::ShmCommunicator(string name)
+{
+  name_ = name[0] == '/' ? name : "/" + name;
+  writer_ = false;
+  slots_ = capacity_ = slotBytes_ = 0;
+  base_ = NULL;
+  header_ = NULL;
+  next_ = 1;
+
+  if (!map(false))
+    cerr << "ShmCommunicator: cannot open " << name_ << endl;
+  else
+    next_ = latest() + 1;
+}
+
+
+ShmCommunicator::~ShmCommunicator()
+{
+#if !defined(_WIN32)
+  if (base_)
+    munmap(base_, baseSize_);
+  // readers keep their mapping, new ones won't find it
+  if (base_ && writer_)
+    shm_unlink(name_.c_str());
+#endif
+}
+
+
+bool
+ShmCommunicator::map(bool writer)
+{
+#if defined(_WIN32)
+  return false;
+#else
+  int fd;
+  if (writer)
+    {
+      shm_unlink(name_.c_str());
+      fd = shm_open(name_.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+      baseSize_ = sizeof(ShmRingHeader) + (unsigned long)slots_ * slotBytes_;
+      if (fd < 0)
+	return false;
+      if (ftruncate(fd, baseSize_) < 0)
+	{
+	  close(fd);
+	  shm_unlink(name_.c_str());
+	  return false;
+	}
+    }
+  else
+    {
+      struct stat st;
+      fd = shm_open(name_.c_str(), O_RDONLY, 0);
+      if (fd < 0)
+	return false;
+      if (fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(ShmRingHeader))
+	{
+	  close(fd);
+	  return false;
+	}
+      baseSize_ = st.st_size;
+    }
+
+  void *p = mmap(NULL, baseSize_, writer ? PROT_READ | PROT_WRITE : PROT_READ,
+		 MAP_SHARED, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED)
+    {
+      if (writer)
+	shm_unlink(name_.c_str());
+      return false;
+    }
+  base_ = (unsigned char *)p;
+  header_ = (ShmRingHeader *)base_;
+
+  if (writer)
+    {
+      // fresh pages are zero: every slot empty, head 0
+      header_->version = SHM_VERSION;
+      header_->slots = slots_;
+      header_->capacity = capacity_;
+      header_->slotBytes = slotBytes_;
+      shm_fence();
+      memcpy(header_->magic, SHM_MAGIC, 8);
+      return true;
+    }
+
+  // reader: take the geometry from the writer
+  if (memcmp(header_->magic, SHM_MAGIC, 8) || header_->version != SHM_VERSION ||
+      sizeof(ShmRingHeader) + (unsigned long)header_->slots * header_->slotBytes > baseSize_)
+    {
+      munmap(base_, baseSize_);
+      base_ = NULL;
+      header_ = NULL;
+      return false;
+    }
+  slots_ = header_->slots;
+  capacity_ = header_->capacity;
+  slotBytes_ = header_->slotBytes;
+  return true;
+#endif
+}
+
+
+bool
+ShmCommunicator::ok()
+{
+  return base_ != NULL;
+}
+
+
+ShmSlot *
+ShmCommunicator::slot(unsigned long long seq)
+{
+  return (ShmSlot *)(base_ + sizeof(ShmRingHeader) + (seq % slots_) * slotBytes_);
+}
+
+
+unsigned int
+ShmCommunicator::capacity()
+{
+  return capacity_;
+}
+
+
+void
+ShmCommunicator::send_vector(const float *data, unsigned int size)
+{
+  if (!base_ || !writer_)
+    return;
+
+  unsigned long long seq = header_->head + 1;
+  ShmSlot *s = slot(seq);
+
+  if (size > capacity_)
+    size = capacity_;
+
+  // readers of the old vector will see the change
+  s->seq = 0;
+  shm_fence();
+  s->size = size;
+  memcpy(s->data, data, size * sizeof(float));
+  shm_fence();
+  s->seq = seq;
+  shm_fence();
+  header_->head = seq;
+}
+
+
+void
+ShmCommunicator::send_message(string message)
+{
+  float *data = new float[capacity_];
+  unsigned int size = text_to_vector(message, data, capacity_);
+  send_vector(data, size);
+  delete [] data;
+}
+
+
+unsigned long long
+ShmCommunicator::latest()
+{
+  return base_ ? header_->head : 0;
+}
+
+
+const float *
+ShmCommunicator::peek(unsigned long long seq, unsigned int &size)
+{
+  if (!base_ || !seq)
+    return NULL;
+
+  ShmSlot *s = slot(seq);
+  if (s->seq != seq)
+    return NULL;
+  shm_fence();
+  size = s->size < capacity_ ? s->size : capacity_;
+  return s->data;
+}
+
+
+bool
+ShmCommunicator::valid(unsigned long long seq)
+{
+  shm_fence();
+  return base_ && seq && slot(seq)->seq == seq;
+}
+
+
+bool
+ShmCommunicator::read(unsigned long long seq, float *out, unsigned int &size)
+{
+  const float *data = peek(seq, size);
+  if (!data)
+    return false;
+  memcpy(out, data, size * sizeof(float));
+  return valid(seq);
+}
+
+
+void
+ShmCommunicator::receive_message(char *message)
+{
+  message[0] = '\0';
+  if (!base_)
+    return;
+
+  unsigned long long head = latest();
+  // fell behind: skip what has been overwritten
+  if (head >= slots_ && next_ <= head - slots_)
+    next_ = head - slots_ + 1;
+
+  float *data = new float[capacity_];
+  unsigned int size;
+  while (next_ <= head)
+    {
+      if (read(next_++, data, size))
+	{
+	  vector_to_text(data, size, message);
+	  break;
+	}
+    }
+  delete [] data;
+}
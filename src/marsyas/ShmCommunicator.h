@@ -0,0 +1,69 @@
+/**
+   \class ShmCommunicator
+   \brief Communicator over a ring of vectors in POSIX shared memory
+
+   The writer puts every vector (e.g. one frame of features) into the
+next slot of a ring in shared memory and numbers it; any number of
+readers in other processes map the same ring read-only and read the
+slots where they are, without copying. The writer never waits for
+readers: a reader more than a ring behind finds its slots reused
+(read() and valid() fail) and picks up again from latest().
+
+   Each slot carries the sequence number of the vector in it, which
+the writer clears while it rewrites the slot, so a reader knows the
+data it looked at was whole if the number is the same before and
+after (a seqlock).
+*/
+
+#if !defined(__ShmCommunicator_h)
+#define __ShmCommunicator_h
+
+#include "Communicator.h"
+
+struct ShmRingHeader;
+struct ShmSlot;
+
+class ShmCommunicator: public Communicator
+{
+public:
+  // writer: creates the ring (replacing an old one of the same name)
+  ShmCommunicator(string name, unsigned int capacity, unsigned int slots = 256);
+  // reader: maps an existing ring
+  ShmCommunicator(string name);
+  ~ShmCommunicator();
+  bool ok();
+
+  // writer: numbers in the text as one vector
+  void send_message(string message);
+  // reader: the next vector as text, "" if there is none yet
+  void receive_message(char *message);
+  // writer: one vector (values past the capacity are dropped)
+  void send_vector(const float *data, unsigned int size);
+
+  // reader: newest sequence number (0 if nothing yet)
+  unsigned long long latest();
+  // reader: the vector in place, NULL if it isn't (or no longer) there;
+  // check valid() after using the data
+  const float *peek(unsigned long long seq, unsigned int &size);
+  bool valid(unsigned long long seq);
+  // reader: copy out (capacity() floats at most), false if reused
+  bool read(unsigned long long seq, float *out, unsigned int &size);
+  unsigned int capacity();
+
+private:
+  ShmSlot *slot(unsigned long long seq);
+  bool map(bool writer);
+
+  string name_;
+  bool writer_;
+  unsigned int slots_;
+  unsigned int capacity_;
+  unsigned int slotBytes_;
+  unsigned char *base_;
+  unsigned long baseSize_;
+  ShmRingHeader *header_;
+  // reader: next vector for receive_message()
+  unsigned long long next_;
+};
+
+#endif
@@ -0,0 +1,215 @@
+/**
+   \class UnixCommunicator
+   \brief Communicator over UNIX-domain datagrams
+
+   A datagram is (8-byte sequence number, 4-byte size, 4 bytes pad,
+size floats); a subscriber's announcement is a single byte.
+*/
+
+#include "UnixCommunicator.h"
+#include <stdio.h>
+#include <string.h>
+#include <iostream>
+
+#if !defined(_WIN32)
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+#define UNIX_HEADER 16
+#define UNIX_MAX_SUBSCRIBERS 64
+
+
+UnixCommunicator::UnixCommunicator(string path, bool publisher)
+{
+  path_ = path;
+  publisher_ = publisher;
+  fd_ = -1;
+  seq_ = 0;
+  dropped_ = 0;
+
+#if !defined(_WIN32)
+  char pid[32];
+  sprintf(pid, ".%d", (int)getpid());
+  own_ = publisher ? path_ : path_ + pid;
+
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (own_.size() >= sizeof(addr.sun_path))
+    {
+      cerr << "UnixCommunicator: path too long: " << own_ << endl;
+      return;
+    }
+  strcpy(addr.sun_path, own_.c_str());
+
+  fd_ = socket(AF_UNIX, SOCK_DGRAM, 0);
+  unlink(own_.c_str());
+  if (fd_ < 0 || bind(fd_, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+      cerr << "UnixCommunicator: cannot bind " << own_ << endl;
+      if (fd_ >= 0)
+	close(fd_);
+      fd_ = -1;
+      return;
+    }
+
+  if (!publisher_)
+    subscribe();
+#endif
+}
+
+
+UnixCommunicator::~UnixCommunicator()
+{
+#if !defined(_WIN32)
+  if (fd_ >= 0)
+    {
+      close(fd_);
+      unlink(own_.c_str());
+    }
+#endif
+}
+
+
+bool
+UnixCommunicator::ok()
+{
+  return fd_ >= 0;
+}
+
+
+unsigned long
+UnixCommunicator::dropped()
+{
+  return dropped_;
+}
+
+
+bool
+UnixCommunicator::subscribe()
+{
+#if defined(_WIN32)
+  return false;
+#else
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, path_.c_str(), sizeof(addr.sun_path) - 1);
+  char hello = 1;
+  return fd_ >= 0 && sendto(fd_, &hello, 1, 0, (struct sockaddr *)&addr, sizeof(addr)) == 1;
+#endif
+}
+
+
+void
+UnixCommunicator::accept_subscribers()
+{
+#if !defined(_WIN32)
+  struct sockaddr_un from;
+  socklen_t len = sizeof(from);
+  char hello;
+  unsigned int i;
+
+  memset(&from, 0, sizeof(from));
+  while (recvfrom(fd_, &hello, 1, MSG_DONTWAIT, (struct sockaddr *)&from, &len) >= 0)
+    {
+      string who = from.sun_path;
+      for (i=0; i < subscribers_.size() && subscribers_[i] != who; i++)
+	;
+      if (!who.empty() && i == subscribers_.size() &&
+	  subscribers_.size() < UNIX_MAX_SUBSCRIBERS)
+	subscribers_.push_back(who);
+      len = sizeof(from);
+      memset(&from, 0, sizeof(from));
+    }
+#endif
+}
+
+
+void
+UnixCommunicator::send_vector(const float *data, unsigned int size)
+{
+#if !defined(_WIN32)
+  if (fd_ < 0 || !publisher_)
+    return;
+
+  accept_subscribers();
+
+  // numbered even if nobody listens, so gaps mean loss
+  unsigned long long seq = ++seq_;
+  packet_.resize(UNIX_HEADER + size * sizeof(float));
+  memset(&packet_[0], 0, UNIX_HEADER);
+  memcpy(&packet_[0], &seq, 8);
+  memcpy(&packet_[8], &size, 4);
+  if (size)
+    memcpy(&packet_[UNIX_HEADER], data, size * sizeof(float));
+
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  for (unsigned int i=0; i < subscribers_.size(); )
+    {
+      strncpy(addr.sun_path, subscribers_[i].c_str(), sizeof(addr.sun_path) - 1);
+      if (sendto(fd_, &packet_[0], packet_.size(), MSG_DONTWAIT,
+		 (struct sockaddr *)&addr, sizeof(addr)) >= 0)
+	i++;
+      else if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS)
+	{
+	  // not keeping up: its loss, not ours
+	  dropped_++;
+	  i++;
+	}
+      else
+	// gone
+	subscribers_.erase(subscribers_.begin() + i);
+    }
+#endif
+}
+
+
+void
+UnixCommunicator::send_message(string message)
+{
+  float data[MAX_MESSAGE];
+  send_vector(data, text_to_vector(message, data, MAX_MESSAGE));
+}
+
+
+unsigned long long
+UnixCommunicator::read(float *out, unsigned int &size, unsigned int capacity)
+{
+#if defined(_WIN32)
+  return 0;
+#else
+  if (fd_ < 0 || publisher_)
+    return 0;
+
+  packet_.resize(UNIX_HEADER + capacity * sizeof(float));
+  ssize_t got = recv(fd_, &packet_[0], packet_.size(), 0);
+  if (got < UNIX_HEADER)
+    return 0;
+
+  unsigned long long seq;
+  memcpy(&seq, &packet_[0], 8);
+  memcpy(&size, &packet_[8], 4);
+  if (size > (got - UNIX_HEADER) / sizeof(float))
+    size = (got - UNIX_HEADER) / sizeof(float);
+  memcpy(out, &packet_[UNIX_HEADER], size * sizeof(float));
+  return seq;
+#endif
+}
+
+
+void
+UnixCommunicator::receive_message(char *message)
+{
+  float data[MAX_MESSAGE];
+  unsigned int size = 0;
+  message[0] = '\0';
+  if (read(data, size, MAX_MESSAGE))
+    vector_to_text(data, size, message);
+}
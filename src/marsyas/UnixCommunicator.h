@@ -0,0 +1,56 @@
+/**
+   \class UnixCommunicator
+   \brief Communicator over UNIX-domain datagrams
+
+   The publisher binds a socket at a path and sends every vector, with
+its sequence number, as one datagram to each subscriber. Subscribers
+bind their own socket next to it and announce themselves by sending
+to the publisher's path. Sends never block: a subscriber that isn't
+reading loses vectors (the sequence numbers show the gap) and one
+that has gone away is forgotten.
+*/
+
+#if !defined(__UnixCommunicator_h)
+#define __UnixCommunicator_h
+
+#include "Communicator.h"
+#include <vector>
+
+class UnixCommunicator: public Communicator
+{
+public:
+  // publisher (binds 'path') or subscriber (binds "path.<pid>")
+  UnixCommunicator(string path, bool publisher);
+  ~UnixCommunicator();
+  bool ok();
+
+  // publisher: numbers in the text as one vector
+  void send_message(string message);
+  // subscriber: waits for the next vector, as text
+  void receive_message(char *message);
+  // publisher: one vector to every subscriber
+  void send_vector(const float *data, unsigned int size);
+
+  // subscriber: (again) ask the publisher for vectors
+  bool subscribe();
+  // subscriber: waits for the next vector (capacity floats at most);
+  // its sequence number, 0 on error
+  unsigned long long read(float *out, unsigned int &size, unsigned int capacity);
+  // publisher: vectors not delivered because a subscriber was full
+  unsigned long dropped();
+
+private:
+  void accept_subscribers();
+
+  string path_;
+  string own_;
+  bool publisher_;
+  int fd_;
+  unsigned long long seq_;
+  unsigned long dropped_;
+  vector<string> subscribers_;
+  // datagram being built / received
+  vector<char> packet_;
+};
+
+#endif
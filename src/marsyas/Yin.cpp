@@ -0,0 +1,169 @@
+/*
+** Copyright (C) 2000 George Tzanetakis <gtzan@cs.princeton.edu>
+**  
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+** 
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+** 
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software 
+** Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+/**
+   \class Yin
+   \brief Pitch (period and voicing) of a time-domain frame, by YIN
+
+   out(0) is the period in samples (0: unvoiced), out(1) the
+voicing confidence, from 0 to 1.
+*/
+
+
+
+#include "Yin.h"
+
+// shortest period looked at (samples)
+#define YIN_MIN_LAG 2
+
+Yin::Yin()
+{
+  inSize_ = DEFAULT_WIN_SIZE;
+  threshold_ = 0.15;
+  init();
+}
+
+Yin::Yin(unsigned int inSize, float threshold)
+{
+  inSize_ = inSize;
+  threshold_ = threshold;
+  init();
+}
+
+Yin::~Yin()
+{
+}
+
+void
+Yin::init()
+{
+  outSize_ = 2;
+  featSize_ = outSize_;
+  featNames_.push_back("YinPeriod");
+  featNames_.push_back("YinConfidence");
+  period_ = 0.0;
+  confidence_ = 0.0;
+  whole_.create(inSize_);
+  half_.create(inSize_);
+  diff_.create(inSize_/2);
+  energy_.resize(inSize_+1);
+}
+
+float 
+Yin::period()
+{
+  return period_;
+}
+
+float 
+Yin::confidence()
+{
+  return confidence_;
+}
+
+
+void 
+Yin::process(fvec& in, fvec& out) 
+{
+  unsigned int i, t;
+  unsigned int len = inSize_;
+  unsigned int w = inSize_/2;
+  assert((in.size() == inSize_) && (out.size() == outSize_));
+  float *a = half_.getData();
+  float *b = whole_.getData();
+
+  /* Energy of any stretch, from the running sum */
+  energy_[0] = 0.0;
+  for (i=0; i < len; i++)
+    energy_[i+1] = energy_[i] + (double)in(i) * in(i);
+
+  /* Products of the first half with the stretch at each lag: one
+     FFT cross-correlation (no stretch reaches past the frame, so it
+     doesn't wrap) */
+  for (i=0; i < len; i++)
+    {
+      b[i] = in(i);
+      a[i] = (i < w) ? in(i) : 0.0;
+    }
+  fft_.rfft(b, len/2, FFT_FORWARD);
+  fft_.rfft(a, len/2, FFT_FORWARD);
+  b[0] *= a[0];				// DC
+  b[1] *= a[1];				// Nyquist
+  for (i=2; i < len; i+=2)
+    {
+      float re = a[i] * b[i] + a[i+1] * b[i+1];
+      float im = a[i] * b[i+1] - a[i+1] * b[i];
+      b[i] = re;
+      b[i+1] = im;
+    }
+  fft_.rfft(b, len/2, FFT_INVERSE);
+
+  /* Difference, normalized by its mean over the lags so far */
+  double sum = 0.0;
+  diff_(0) = 1.0;
+  for (t=1; t < w; t++)
+    {
+      double d = (energy_[w] - energy_[0]) + (energy_[t+w] - energy_[t]) 
+	- 2.0 * len * b[t];
+      if (d < 0.0) d = 0.0;
+      sum += d;
+      diff_(t) = (sum > 0.0) ? (float)(d * t / sum) : 1.0;
+    }
+
+  /* The first dip under the threshold, down to its bottom */
+  for (t=YIN_MIN_LAG; t < w; t++)
+    if (diff_(t) < threshold_)
+      {
+	while (t+1 < w && diff_(t+1) < diff_(t))
+	  t++;
+	break;
+      }
+
+  if (t >= w)
+    {
+      /* Unvoiced: how close the best lag came */
+      float least = 1.0;
+      for (t=YIN_MIN_LAG; t < w; t++)
+	if (diff_(t) < least) 
+	  least = diff_(t);
+      period_ = 0.0;
+      confidence_ = 1.0 - least;
+    }
+  else 
+    {
+      /* Parabolic interpolation around the minimum */
+      float depth = diff_(t);
+      period_ = (float)t;
+      if (t+1 < w)
+	{
+	  float curve = diff_(t-1) - 2.0 * diff_(t) + diff_(t+1);
+	  if (curve > 0.0)
+	    {
+	      float shift = 0.5 * (diff_(t-1) - diff_(t+1)) / curve;
+	      period_ += shift;
+	      depth -= 0.25 * (diff_(t-1) - diff_(t+1)) * shift;
+	    }
+	}
+      if (depth < 0.0) depth = 0.0;
+      if (depth > 1.0) depth = 1.0;
+      confidence_ = 1.0 - depth;
+    }
+
+  out(0) = period_;
+  out(1) = confidence_;
+}
@@ -0,0 +1,61 @@
+/*
+** Copyright (C) 2000 George Tzanetakis <gtzan@cs.princeton.edu>
+**  
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+** 
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+** 
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software 
+** Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+/**
+   \class Yin
+   \brief Pitch (period and voicing) of a time-domain frame, by YIN
+
+   YIN (de Cheveigne and Kawahara): the squared difference of the
+frame against itself at each lag, normalized by its running mean,
+is searched for the first dip under a threshold; the lag, refined
+by a parabola through its neighbors, is the period in samples (0
+for unvoiced frames), and one minus the dip's depth the voicing
+confidence. The difference function comes from running energies
+and one FFT cross-correlation, O(N log N) per frame. Periods up
+to half the frame are found.
+*/
+
+#if !defined(__Yin_h)
+#define __Yin_h
+
+#include "System.h"
+#include "MagFFT.h"
+
+
+class Yin: public System
+{
+private:
+  float threshold_;
+  float period_;
+  float confidence_;
+  fvec whole_;
+  fvec half_;
+  fvec diff_;
+  vector<double> energy_;
+  MagFFT fft_;
+public:
+  Yin();
+  Yin(unsigned int inSize, float threshold = 0.15);
+  ~Yin();
+  void init();
+  float period();
+  float confidence();
+  void process(fvec& in, fvec& out);
+};
+
+#endif
@@ -305,19 +305,7 @@ fvec::minus(const fvec& vec1, const fvec& vec2)
 void 
 fvec::send(Communicator *com)
 { 
-  unsigned int i;
-  static char *buf = new char[256];
-  string message;
-  sprintf(buf, "%i\n", size_);
-  message = buf;
-  com->send_message(message);
-  for (i=0; i<size_; i++)
-    {
-      sprintf(buf, "%f\n", data_[i]);
-      message = buf;
-      com->send_message(message);
-    }
-  cerr << "fvec::send " << size_ << " numbers were sent to the client\n";
+  com->send_vector(data_, size_);
 }
 
 void
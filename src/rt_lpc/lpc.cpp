@@ -21,20 +21,32 @@
 
 
 
+// line spectral frequencies: search grid (over 0..pi), bisections per root
+#define LPC_LSF_GRID        1024
+#define LPC_LSF_BISECT      10
+#define LPC_LSF_PI          3.14159265359f
+// interpolated synthesis: samples per parameter update
+#define LPC_INTERP_BLOCK    32
+
 // internal data structure
 struct lpc_data_
 {
     SAMPLE * corr;
     SAMPLE * Zs;
     SAMPLE * Zss;
+    SAMPLE * Zsave;
+    // lattice state: each stage's backward error, one sample back
+    SAMPLE * Zb;
+    // levinson scratch
+    float * tmp;
     SAMPLE * alt;
-    thematrix * R;
-    thematrix * res;
     int order;
     int len;
     int alt_len;
     int ticker;
     int which;
+    // noise (xorshift32, never 0)
+    unsigned int seed;
 };
 
 // data for glot_pop.raw...
@@ -117,8 +129,12 @@ SAMPLE glot_pop_data[] = {
 //-----------------------------------------------------------------------------
 lpc_data lpc_create( )
 {
+    static unsigned int instances = 0;
     lpc_data instance = new lpc_data_;
     memset( instance, 0, sizeof(lpc_data_) );
+    // each instance its own noise
+    instance->seed = 2463534242u + 0x9e3779b9u * instances++;
+    if( !instance->seed ) instance->seed = 1;
     // set the default glottal pulse
     lpc_alt( instance, glot_pop_data, glot_pop_size );
 
@@ -138,12 +154,18 @@ void lpc_destroy( lpc_data & instance )
     {
         if( instance->corr )
             delete [] instance->corr;
-        if( instance->R )
-            delete instance->R;
-        if( instance->res )
-            delete instance->res;
         if( instance->alt )
             delete [] instance->alt;
+        if( instance->Zs )
+            delete [] instance->Zs;
+        if( instance->Zss )
+            delete [] instance->Zss;
+        if( instance->Zsave )
+            delete [] instance->Zsave;
+        if( instance->Zb )
+            delete [] instance->Zb;
+        if( instance->tmp )
+            delete [] instance->tmp;
 
         delete instance;
         instance = NULL;
@@ -195,14 +217,11 @@ float lpc_predict( lpc_data lpc, SAMPLE * x, int len, float * coefs, int order,
 
 
 //-----------------------------------------------------------------------------
-// name: lpc_analyze()
-// desc: ...
+// name: lpc_allocate()
+// desc: scratch for len-sample frames, filter state for order
 //-----------------------------------------------------------------------------
-void lpc_analyze( lpc_data lpc, SAMPLE * x, int len, float * coefs, int order,
-                  float * power, float * pitch, SAMPLE * residue )
+static void lpc_allocate( lpc_data lpc, int len, int order )
 {
-    int i, j;
-
     // allocate
     if( lpc->len != len )
     {
@@ -211,40 +230,46 @@ void lpc_analyze( lpc_data lpc, SAMPLE * x, int len, float * coefs, int order,
         lpc->len = len;
     }
     
-    // allocate the matrix
+    // allocate the filter state
     if( lpc->order != order )
     {
-        if( lpc->R ) delete lpc->R;
-        if( lpc->res ) delete lpc->res;
         if( lpc->Zs ) delete [] lpc->Zs;
         if( lpc->Zss ) delete [] lpc->Zss;
-        lpc->R = new thematrix( order, order );
-        lpc->res = new thematrix( order, order );
+        if( lpc->Zsave ) delete [] lpc->Zsave;
+        if( lpc->Zb ) delete [] lpc->Zb;
+        if( lpc->tmp ) delete [] lpc->tmp;
         lpc->Zs = new float[order];
         lpc->Zss = new float[order];
+        lpc->Zsave = new float[order];
+        lpc->Zb = new float[order];
+        lpc->tmp = new float[order];
         memset( lpc->Zss, 0, order * sizeof(float) );
+        memset( lpc->Zb, 0, order * sizeof(float) );
         lpc->order = order;
         lpc->ticker = 0;
     }
+}
 
-    // find the autocorrelation of the signal, with pitch
-    *pitch = autocorrelate( x, len, lpc->corr );
 
-    // construct the R matrix
-    for( i = 1; i <= order; i++ )
-        for( j = 1; j <= order; j++ )
-             (*(lpc->R))[i-1][j-1] = lpc->corr[abs((int)(i-j))];
 
-    // invert R
-    lpc->R->invert( *(lpc->res) );
 
-    // find the coefficients A = P*R^(-1)
-    for( i = 0; i < order; i++ )
-    {
-        coefs[i] = 0.0f;
-        for( j = 0; j < order; j++ )
-            coefs[i] += (*(lpc->R))[i][j] * lpc->corr[1+j];
-    }
+//-----------------------------------------------------------------------------
+// name: lpc_analyze()
+// desc: ...
+//-----------------------------------------------------------------------------
+void lpc_analyze( lpc_data lpc, SAMPLE * x, int len, float * coefs, int order,
+                  float * power, float * pitch, SAMPLE * residue, float * refl )
+{
+    lpc_allocate( lpc, len, order );
+
+    // find the autocorrelation of the signal, with pitch (only the lags
+    // either of them looks at; no pitch wanted, only the filter's)
+    int lags = pitch && len / 4 + 2 > order + 1 ? len / 4 + 2 : order + 1;
+    float found = autocorrelate( x, len, lpc->corr, lags < len ? lags : len );
+    if( pitch ) *pitch = found;
+
+    // solve the (toeplitz) normal equations R A = P
+    lpc_levinson( lpc->corr, order, coefs, refl, lpc->tmp );
 
     // do the linear prediction to find residue
     *power = lpc_predict( lpc, x, len, coefs, order, residue );
@@ -253,6 +278,94 @@ void lpc_analyze( lpc_data lpc, SAMPLE * x, int len, float * coefs, int order,
 
 
 
+//-----------------------------------------------------------------------------
+// name: lpc_analyze_corr()
+// desc: the autocorrelation (order+1 lags) comes from elsewhere, and the
+//       power is the prediction error levinson leaves; no pass over x
+//       but the pitch's (pitch NULL: none at all)
+//-----------------------------------------------------------------------------
+void lpc_analyze_corr( lpc_data lpc, SAMPLE * x, int len, const float * corr,
+                       float * coefs, int order, float * power, float * pitch,
+                       SAMPLE * residue, float * refl )
+{
+    int i;
+
+    lpc_allocate( lpc, len, order );
+
+    // pitch, from its own lags (if wanted): a pass of len * len / 4,
+    // which the tracked lags don't save (see yin.h for a cheaper one)
+    if( pitch )
+        *pitch = autocorrelate( x, len, lpc->corr, len / 4 + 2 );
+
+    // solve, and what's left unpredicted
+    float error = lpc_levinson( corr, order, coefs, refl, lpc->tmp );
+    *power = error > 0.0f ? (float)sqrt( error ) / ( len - order ) : 0.0f;
+
+    // (what lpc_predict() shows as the residue)
+    if( residue )
+    {
+        memset( residue, 0, order * sizeof(SAMPLE) );
+        for( i = order; i < len; i++ )
+            residue[i] = x[i] - x[i-1];
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: noise()
+// desc: uniform in [-1, 1), from the instance's own generator
+//-----------------------------------------------------------------------------
+static inline float noise( lpc_data lpc )
+{
+    unsigned int x = lpc->seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    lpc->seed = x;
+    return (int)x * ( 1.0f / 2147483648.0f );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: excite()
+// desc: the next excitation sample: noise (pitch 0), pulses, or glottal
+//-----------------------------------------------------------------------------
+static inline SAMPLE excite( lpc_data lpc, float power, float pitch, int alt )
+{
+    SAMPLE output = 0.0f;
+    int j;
+
+    if( pitch == 0 )
+    {
+        lpc->ticker = 0;
+        return power * 20.0f * noise( lpc );
+    }
+
+    lpc->ticker--;
+    if( lpc->ticker <= 0 ) {
+        lpc->ticker = (int)(pitch + .5f);
+        if( !alt || !lpc->alt )
+            output = power * pitch * 1.0f;
+    }
+
+    if( alt && lpc->alt )
+    {
+        j = (int)(pitch+.5) - lpc->ticker + 0;
+        if( j >= 0 && (j*4) < lpc->alt_len )
+            output = power * pitch * lpc->alt[j*4] / (float)SHRT_MAX;
+        else output *= .9f;
+    }
+
+    return output;
+}
+
+
+
+
 //-----------------------------------------------------------------------------
 // name: lpc_synthesize()
 // desc: ...
@@ -264,41 +377,397 @@ void lpc_synthesize( lpc_data lpc, SAMPLE * y, int len, float * coefs,
     int i, j;
     
     for( i = 0; i < len; i++ ) {
-        output = 0.0f;
+        output = excite( lpc, power, pitch, alt );
+        if( pitch == 0 && ( i == (len - 1) || i == 0 ) )
+            memset( lpc->Zss, 0, lpc->order * sizeof(float) );
+
+        for( j = 0; j < order; j++ )
+            output += lpc->Zss[j] * coefs[j];
+
+        for( j = order - 1; j > 0; j-- )
+            lpc->Zss[j] = lpc->Zss[j-1];
+
+        lpc->Zss[0] = output;
+
+        y[i] = output;
+    }
+}
+
+
+
 
-        if( pitch == 0 )
+//-----------------------------------------------------------------------------
+// name: lpc_filter_lattice()
+// desc: the same all-pole filter as a lattice: order stages of two
+//       multiply-adds each, nothing shifted; stable for any |refl| < 1
+//-----------------------------------------------------------------------------
+void lpc_filter_lattice( lpc_data lpc, SAMPLE * y, int len, const float * refl,
+                         int order )
+{
+    SAMPLE * b, f;
+    int i, j;
+
+    // the state is the instance's (an instance only synthesizing gets it here)
+    if( order != lpc->order )
+        lpc_allocate( lpc, lpc->len, order );
+    b = lpc->Zb;
+
+    for( i = 0; i < len; i++ )
+    {
+        f = y[i];
+
+        // from the last stage down: forward error in, backward error on
+        // (the last stage's backward error goes nowhere)
+        if( order > 0 )
+            f += refl[order-1] * b[order-1];
+        for( j = order - 2; j >= 0; j-- )
         {
-            output = power * 20.0f * ( 2.0f * rand() / RAND_MAX - 1.0f );
-            lpc->ticker = 0;
-            if( i == (len - 1) || i == 0 )
-                memset( lpc->Zss, 0, lpc->order * sizeof(float) );
+            f += refl[j] * b[j];
+            b[j+1] = b[j] - refl[j] * f;
         }
-        else {
-            lpc->ticker--;
-            if( lpc->ticker <= 0 ) {
-                lpc->ticker = (int)(pitch + .5f);
-                if( !alt || !lpc->alt )
-                    output = power * pitch * 1.0f;
-            }
+        b[0] = f;
 
-            if( alt && lpc->alt )
+        y[i] = f;
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: lpc_synthesize_lattice()
+// desc: ...
+//-----------------------------------------------------------------------------
+void lpc_synthesize_lattice( lpc_data lpc, SAMPLE * y, int len, float * refl,
+                             int order, float power, float pitch, int alt )
+{
+    for( int i = 0; i < len; i++ )
+        y[i] = excite( lpc, power, pitch, alt );
+
+    lpc_filter_lattice( lpc, y, len, refl, order );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: lpc_filter_frame()
+// desc: for overlap-add: the first hop carries on from the last frame, the
+//       rest is this frame's alone
+//-----------------------------------------------------------------------------
+void lpc_filter_frame( lpc_data lpc, SAMPLE * y, int len, int hop,
+                       const float * refl, int order )
+{
+    lpc_filter_lattice( lpc, y, hop < len ? hop : len, refl, order );
+    if( len <= hop ) return;
+
+    // where the next frame starts from
+    memcpy( lpc->Zsave, lpc->Zb, lpc->order * sizeof(SAMPLE) );
+    lpc_filter_lattice( lpc, y + hop, len - hop, refl, order );
+    memcpy( lpc->Zb, lpc->Zsave, lpc->order * sizeof(SAMPLE) );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: lpc_synthesize_frame()
+// desc: for overlap-add: the first hop carries on from the last frame, the
+//       rest is this frame's alone
+//-----------------------------------------------------------------------------
+void lpc_synthesize_frame( lpc_data lpc, SAMPLE * y, int len, int hop,
+                           float * refl, int order, float power, float pitch,
+                           int alt )
+{
+    int i, ticker = lpc->ticker;
+
+    // the excitation, also only moving on by hop
+    for( i = 0; i < len; i++ )
+    {
+        if( i == hop ) ticker = lpc->ticker;
+        y[i] = excite( lpc, power, pitch, alt );
+    }
+    if( hop < len ) lpc->ticker = ticker;
+
+    lpc_filter_frame( lpc, y, len, hop, refl, order );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: lsf_eval()
+// desc: the sum and difference polynomials on the unit circle, linear
+//       phase taken out (so both are real)
+//-----------------------------------------------------------------------------
+static void lsf_eval( const float * P, const float * Q, int n, float w,
+                      float * fp, float * fq )
+{
+    // angles (c - m) w, c = (n-1)/2, by rotation
+    float c = cosf( (n - 1) * .5f * w ), s = sinf( (n - 1) * .5f * w );
+    float cw = cosf( w ), sw = sinf( w ), t;
+    float sp = 0.0f, sq = 0.0f;
+
+    for( int m = 0; m < n; m++ )
+    {
+        sp += P[m] * c;
+        sq += Q[m] * s;
+        t = c * cw + s * sw;
+        s = s * cw - c * sw;
+        c = t;
+    }
+
+    *fp = sp;
+    *fq = sq;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: lpc_to_lsf()
+// desc: the roots (on the unit circle) of A(z) +/- z^-(order+1) A(1/z),
+//       found on a grid and refined by bisection; they alternate, sum
+//       polynomial first
+//-----------------------------------------------------------------------------
+bool lpc_to_lsf( const float * coefs, int order, float * lsf )
+{
+    float P[LPC_MAX_ORDER+2], Q[LPC_MAX_ORDER+2], A[LPC_MAX_ORDER+2];
+    // (lsf stays as it is unless they are all found)
+    float found[LPC_MAX_ORDER];
+    float lo, hi, mid, fp, fq, fpl, fql, f0, f1, w, prev_p, prev_q;
+    int n = order + 2, np = 0, nq = 0, m, g, i, which;
+
+    if( order < 1 || order > LPC_MAX_ORDER )
+        return false;
+
+    // A(z) = 1 - sum coefs z^-j
+    A[0] = 1.0f;
+    for( m = 1; m <= order; m++ )
+        A[m] = -coefs[m-1];
+    A[order+1] = 0.0f;
+    for( m = 0; m < n; m++ )
+    {
+        P[m] = A[m] + A[order+1-m];
+        Q[m] = A[m] - A[order+1-m];
+    }
+
+    // (the trivial roots, at 0 and/or pi, are left out)
+    lsf_eval( P, Q, n, LPC_LSF_PI / LPC_LSF_GRID, &prev_p, &prev_q );
+    for( g = 2; g < LPC_LSF_GRID && np + nq <= order; g++ )
+    {
+        w = g * LPC_LSF_PI / LPC_LSF_GRID;
+        lsf_eval( P, Q, n, w, &fp, &fq );
+
+        // a sign change in either: narrow it down
+        for( which = 0; which < 2; which++ )
+        {
+            f0 = which ? prev_q : prev_p;
+            f1 = which ? fq : fp;
+            if( ( f0 < 0.0f ) == ( f1 < 0.0f ) )
+                continue;
+
+            lo = w - LPC_LSF_PI / LPC_LSF_GRID; hi = w;
+            for( i = 0; i < LPC_LSF_BISECT; i++ )
             {
-                j = (int)(pitch+.5) - lpc->ticker + 0;
-                if( j >= 0 && (j*4) < lpc->alt_len )
-                    output = power * pitch * lpc->alt[j*4] / (float)SHRT_MAX;
-                else output *= .9f;
+                mid = .5f * ( lo + hi );
+                lsf_eval( P, Q, n, mid, &fpl, &fql );
+                if( ( ( which ? fql : fpl ) < 0.0f ) == ( f0 < 0.0f ) ) lo = mid;
+                else hi = mid;
             }
+
+            // sum roots at the even places, difference roots at the odd
+            if( !which && 2*np < order ) found[2*np++] = .5f * ( lo + hi );
+            else if( which && 2*nq+1 < order ) found[2*nq++ + 1] = .5f * ( lo + hi );
+            else return false;
         }
 
-        for( j = 0; j < order; j++ )
-            output += lpc->Zss[j] * coefs[j];
+        prev_p = fp;
+        prev_q = fq;
+    }
 
-        for( j = order - 1; j > 0; j-- )
-            lpc->Zss[j] = lpc->Zss[j-1];
+    // all of them, in order
+    if( np != ( order + 1 ) / 2 || nq != order / 2 )
+        return false;
+    for( i = 1; i < order; i++ )
+        if( found[i] <= found[i-1] ) return false;
 
-        lpc->Zss[0] = output;
+    memcpy( lsf, found, order * sizeof(float) );
+    return true;
+}
 
-        y[i] = output;
+
+
+
+//-----------------------------------------------------------------------------
+// name: lsf_to_lpc()
+// desc: A(z) = ( P(z) + Q(z) ) / 2, the polynomials from their roots
+//-----------------------------------------------------------------------------
+void lsf_to_lpc( const float * lsf, int order, float * coefs )
+{
+    double P[LPC_MAX_ORDER+2], Q[LPC_MAX_ORDER+2], c;
+    int np = 1, nq = 1, i, m;
+
+    if( order < 1 || order > LPC_MAX_ORDER )
+        return;
+
+    // the trivial roots: -1 for the sum (even order), +1 and (odd
+    // order) -1 for the difference
+    P[0] = Q[0] = 1.0;
+    if( order % 2 == 0 )
+    {
+        P[1] = 1.0; Q[1] = -1.0;
+        np = nq = 2;
+    }
+    else
+    {
+        Q[1] = 0.0; Q[2] = -1.0;
+        nq = 3;
+    }
+
+    // times ( 1 - 2 cos(w) z^-1 + z^-2 ) for each
+    for( i = 0; i < order; i++ )
+    {
+        double * X = i % 2 ? Q : P;
+        int & n = i % 2 ? nq : np;
+        c = -2.0 * cos( lsf[i] );
+        X[n] = X[n+1] = 0.0;
+        for( m = n + 1; m >= 2; m-- )
+            X[m] += c * X[m-1] + X[m-2];
+        X[1] += c * X[0];
+        n += 2;
+    }
+
+    for( m = 1; m <= order; m++ )
+        coefs[m-1] = (float)( -.5 * ( P[m] + Q[m] ) );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: lsf_interpolate()
+// desc: ...
+//-----------------------------------------------------------------------------
+void lsf_interpolate( const float * lsf0, const float * lsf1, int order, float t,
+                      float * lsf )
+{
+    for( int i = 0; i < order; i++ )
+        lsf[i] = lsf0[i] + t * ( lsf1[i] - lsf0[i] );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: lpc_to_reflection()
+// desc: step-down (levinson backwards); false if some |k| >= 1
+//-----------------------------------------------------------------------------
+bool lpc_to_reflection( const float * coefs, int order, float * refl, float * tmp )
+{
+    float k, d;
+    int i, j;
+
+    memcpy( tmp, coefs, order * sizeof(float) );
+    for( i = order - 1; i >= 0; i-- )
+    {
+        k = refl[i] = tmp[i];
+        if( k >= 1.0f || k <= -1.0f )
+            return false;
+
+        // the order i predictor
+        d = 1.0f / ( 1.0f - k * k );
+        for( j = 0; j < i / 2; j++ )
+        {
+            float a = tmp[j], b = tmp[i-j-1];
+            tmp[j] = ( a + k * b ) * d;
+            tmp[i-j-1] = ( b + k * a ) * d;
+        }
+        if( i % 2 )
+            tmp[i/2] *= ( 1.0f + k ) * d;
+    }
+
+    return true;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: interp_refl()
+// desc: the filter t of the way from one frame's to the next's
+//-----------------------------------------------------------------------------
+static void interp_refl( lpc_data lpc, const float * lsf0, const float * lsf1,
+                         int order, float t, float * refl )
+{
+    float lsf[LPC_MAX_ORDER], coefs[LPC_MAX_ORDER];
+
+    // ordered lsfs make a stable filter; the step-down can still round
+    // its way out of one
+    lsf_interpolate( lsf0, lsf1, order, t, lsf );
+    lsf_to_lpc( lsf, order, coefs );
+    if( !lpc_to_reflection( coefs, order, refl, lpc->tmp ) )
+        memset( refl, 0, order * sizeof(float) );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: lpc_synthesize_interp()
+// desc: a block at a time, the filter (by way of the line spectral
+//       frequencies), gain and pitch part of the way from the one frame to
+//       the next; pitch moves only between two voiced frames, otherwise it
+//       switches half way
+//-----------------------------------------------------------------------------
+void lpc_synthesize_interp( lpc_data lpc, SAMPLE * y, int len,
+                            const float * lsf0, const float * lsf1, int order,
+                            float power0, float power1, float pitch0, float pitch1,
+                            int alt )
+{
+    float refl[LPC_MAX_ORDER];
+    float t, pitch, power;
+    int i, j, n;
+
+    if( order > lpc->order ) order = lpc->order;
+
+    for( i = 0; i < len; i += n )
+    {
+        n = len - i < LPC_INTERP_BLOCK ? len - i : LPC_INTERP_BLOCK;
+        // the middle of the block
+        t = ( i + .5f * n ) / len;
+
+        if( pitch0 > 0 && pitch1 > 0 ) pitch = pitch0 + t * ( pitch1 - pitch0 );
+        else pitch = t < .5f ? pitch0 : pitch1;
+        power = power0 + t * ( power1 - power0 );
+        for( j = 0; j < n; j++ )
+            y[i+j] = excite( lpc, power, pitch, alt );
+
+        interp_refl( lpc, lsf0, lsf1, order, t, refl );
+        lpc_filter_lattice( lpc, y + i, n, refl, order );
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: lpc_filter_interp()
+// desc: lpc_synthesize_interp()'s filter, over the excitation in y
+//-----------------------------------------------------------------------------
+void lpc_filter_interp( lpc_data lpc, SAMPLE * y, int len,
+                        const float * lsf0, const float * lsf1, int order )
+{
+    float refl[LPC_MAX_ORDER];
+    int i, n;
+
+    if( order > lpc->order ) order = lpc->order;
+
+    for( i = 0; i < len; i += n )
+    {
+        n = len - i < LPC_INTERP_BLOCK ? len - i : LPC_INTERP_BLOCK;
+        interp_refl( lpc, lsf0, lsf1, order, ( i + .5f * n ) / len, refl );
+        lpc_filter_lattice( lpc, y + i, n, refl, order );
     }
 }
 
@@ -446,17 +915,230 @@ int thematrix::invert( thematrix & res )
 
 
 
+//-----------------------------------------------------------------------------
+// name: struct lpc_corr_
+// desc: sliding (or recursive) autocorrelation
+//-----------------------------------------------------------------------------
+struct lpc_corr_
+{
+    int len;
+    int lags;
+    float decay;
+    // the last len (sliding) or lags (recursive) samples, circular
+    SAMPLE * hist;
+    int size;
+    long pos;
+    // the lags, and samples since they were last summed from scratch
+    double * r;
+    long since;
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: lpc_corr_create()
+// desc: ...
+//-----------------------------------------------------------------------------
+lpc_corr lpc_corr_create( int len, int lags, float decay )
+{
+    if( len <= 0 || lags <= 0 || lags > len || decay < 0.0f || decay >= 1.0f )
+        return NULL;
+
+    lpc_corr c = new lpc_corr_;
+    c->len = len;
+    c->lags = lags;
+    c->decay = decay;
+    c->size = decay > 0.0f ? lags : len;
+    c->hist = new SAMPLE[c->size];
+    c->r = new double[lags];
+    lpc_corr_reset( c );
+
+    return c;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: lpc_corr_destroy()
+// desc: ...
+//-----------------------------------------------------------------------------
+void lpc_corr_destroy( lpc_corr & c )
+{
+    if( c )
+    {
+        delete [] c->hist;
+        delete [] c->r;
+        delete c;
+        c = NULL;
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: lpc_corr_reset()
+// desc: ...
+//-----------------------------------------------------------------------------
+void lpc_corr_reset( lpc_corr c )
+{
+    memset( c->hist, 0, c->size * sizeof(SAMPLE) );
+    memset( c->r, 0, c->lags * sizeof(double) );
+    c->pos = 0;
+    c->since = 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: lpc_corr_lags()
+// desc: ...
+//-----------------------------------------------------------------------------
+int lpc_corr_lags( lpc_corr c )
+{
+    return c->lags;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: lpc_corr_push()
+// desc: per sample: (sliding) the one leaving takes its products out, the
+//       one entering puts its in; (recursive) the old decay a little
+//-----------------------------------------------------------------------------
+void lpc_corr_push( lpc_corr c, const SAMPLE * x, int n )
+{
+    int size = c->size, lags = c->lags, k, m;
+    double * r = c->r;
+    SAMPLE * h = c->hist;
+
+    for( int i = 0; i < n; i++ )
+    {
+        long t = c->pos;
+        SAMPLE in = x[i];
+
+        if( c->decay > 0.0f )
+        {
+            h[t % size] = in;
+            for( k = 0; k < lags && k <= t; k++ )
+                r[k] = c->decay * r[k] + in * h[(t - k) % size];
+        }
+        else
+        {
+            // out with the oldest, and what it made with the rest
+            if( t >= size )
+            {
+                long o = t - size;
+                SAMPLE out = h[o % size];
+                for( k = 0; k < lags; k++ )
+                    r[k] -= out * h[(o + k) % size];
+            }
+
+            h[t % size] = in;
+            for( k = 0; k < lags && k <= t; k++ )
+                r[k] += in * h[(t - k) % size];
+
+            // adding and taking away drifts: now and then, start over
+            if( ++c->since >= size )
+            {
+                long first = t + 1 > size ? t + 1 - size : 0;
+                for( k = 0; k < lags; k++ )
+                {
+                    double sum = 0.0;
+                    for( m = first; m + k <= t; m++ )
+                        sum += h[m % size] * h[(m + k) % size];
+                    r[k] = sum;
+                }
+                c->since = 0;
+            }
+        }
+
+        c->pos++;
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: lpc_corr_get()
+// desc: scaled as a len-sample sum, tapered like autocorrelate()'s
+//-----------------------------------------------------------------------------
+void lpc_corr_get( lpc_corr c, float * corr, int lags )
+{
+    double scale = c->decay > 0.0f ? c->len * ( 1.0 - c->decay ) : 1.0;
+
+    if( lags > c->lags ) lags = c->lags;
+    for( int k = 0; k < lags; k++ )
+        corr[k] = (float)( c->r[k] * scale * ( c->len - k ) / c->len );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: lpc_levinson()
+// desc: levinson-durbin: predictor coefficients and reflection
+//       coefficients from the autocorrelation, in O(order^2); the
+//       reflection coefficients are kept inside the unit circle
+//-----------------------------------------------------------------------------
+float lpc_levinson( const SAMPLE * corr, int order, float * coefs, float * refl,
+                    float * tmp )
+{
+    float error = corr[0], acc, k;
+    int i, j;
+
+    memset( coefs, 0, order * sizeof(float) );
+    if( refl ) memset( refl, 0, order * sizeof(float) );
+    // silence
+    if( error <= 0.0f ) return 0.0f;
+
+    for( i = 0; i < order; i++ )
+    {
+        // how much of what's left the next lag predicts
+        acc = corr[i+1];
+        for( j = 0; j < i; j++ )
+            acc -= coefs[j] * corr[i-j];
+        k = acc / error;
+        if( k > .999f ) k = .999f;
+        else if( k < -.999f ) k = -.999f;
+
+        // the order i+1 predictor
+        for( j = 0; j < i; j++ )
+            tmp[j] = coefs[j] - k * coefs[i-j-1];
+        memcpy( coefs, tmp, i * sizeof(float) );
+        coefs[i] = k;
+        if( refl ) refl[i] = k;
+
+        error *= 1.0f - k * k;
+    }
+
+    return error;
+}
+
+
+
+
 //-----------------------------------------------------------------------------
 // name: autocorrelate()
 // desc: ...
 //-----------------------------------------------------------------------------
-float autocorrelate( SAMPLE * x, int len, SAMPLE * y )
+float autocorrelate( SAMPLE * x, int len, SAMPLE * y, int lags )
 {
     float norm, temp;
     int n, i, j, k;
 
+    // no pitch is found past len/4: no need to look further (but one lag
+    // past it, to tell a peak from a slope still rising)
+    if( lags <= 0 || lags > len ) lags = len;
+    int reach = len / 4 + 2 < lags ? len / 4 + 2 : lags;
+
     // refer to pp. 89 for variable name consistency
-    for ( n = 0; n < len; n++ )
+    for ( n = 0; n < lags; n++ )
     {
         temp = 0.0;
         for ( i = 0; i < len - n - 1; i++ )
@@ -469,7 +1151,7 @@ float autocorrelate( SAMPLE * x, int len, SAMPLE * y )
     // why?
     j = (unsigned int)(len * 0.02);
     // loop to the point y stops descreasing
-    while( y[j] < temp && j < len )
+    while( j < reach && y[j] < temp )
     {
         temp = y[j];
         j++;
@@ -478,7 +1160,7 @@ float autocorrelate( SAMPLE * x, int len, SAMPLE * y )
     // yes
     temp = 0.0;
     // find the max between j and the end
-    for( i = j; i < len/2; i++ )
+    for( i = j; i < reach; i++ )
     {
         if( y[i] > temp)
         {
@@ -486,16 +1168,19 @@ float autocorrelate( SAMPLE * x, int len, SAMPLE * y )
             temp = y[i];
         }
     }
+    // only a peak: the edge of the search may be on its way up to one
+    // further out, which is no pitch here
+    if( j + 1 >= reach || y[j] < y[j+1] ) j = reach;
 
     // why are we doing this?
     norm = 1.0f / len;
     k = len;
 
     // normalize, we think
-    for( i = 0; i < len; i++ )
+    for( i = 0; i < lags; i++ )
         y[i] *= (k-i) * norm;
 
-    if( (y[j] / y[0]) < 0.4 ) j = 0;
+    if( j >= reach || (y[j] / y[0]) < 0.4 ) j = 0;
     if( j > len / 4 ) j = 0;
 
     // we return the pitch information
@@ -550,3 +1235,16 @@ void lpc_alt( lpc_data lpc, SAMPLE * alt, int len )
     memcpy( lpc->alt, alt, len * sizeof(SAMPLE) );
     lpc->alt_len = len;
 }
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: lpc_glottal()
+// desc: ...
+//-----------------------------------------------------------------------------
+const SAMPLE * lpc_glottal( lpc_data lpc, int * len )
+{
+    *len = lpc->alt_len;
+    return lpc->alt;
+}
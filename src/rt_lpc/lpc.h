@@ -20,19 +20,53 @@
 #endif
 
 
+// the largest order the line spectral frequency helpers take
+#define LPC_MAX_ORDER 100
+
 // forward reference
 typedef struct lpc_data_ * lpc_data;
+typedef struct lpc_corr_ * lpc_corr;
 
 
 // init
 lpc_data lpc_create( );
 // analysis
+// (refl, if not NULL, gets the order reflection coefficients; pitch, if
+// NULL, isn't looked for, see yin.h)
 void lpc_analyze( lpc_data instance, SAMPLE * x, int len, float * coefs, 
                   int order, float * power, float * pitch, 
-                  SAMPLE * residue = NULL );
+                  SAMPLE * residue = NULL, float * refl = NULL );
+// analysis from autocorrelation lags (order+1, see lpc_corr below); the
+// pitch still costs its own len * len / 4 pass over x, so pass NULL and
+// take it from yin_pitch() to save it
+void lpc_analyze_corr( lpc_data instance, SAMPLE * x, int len, const float * corr,
+                       float * coefs, int order, float * power, float * pitch,
+                       SAMPLE * residue = NULL, float * refl = NULL );
 // synthesis
 void lpc_synthesize( lpc_data instance, SAMPLE * y, int len, float * coefs,
                      int order, float power, float pitch, int alt = 0 );
+// synthesis, lattice form, from the reflection coefficients
+void lpc_synthesize_lattice( lpc_data instance, SAMPLE * y, int len, float * refl,
+                             int order, float power, float pitch, int alt = 0 );
+// synthesis (lattice) of overlapping frames: len samples, but the state
+// moves on by only hop of them (where the next frame starts)
+void lpc_synthesize_frame( lpc_data instance, SAMPLE * y, int len, int hop,
+                           float * refl, int order, float power, float pitch,
+                           int alt = 0 );
+// synthesis (lattice) moving from one frame to the next over len samples:
+// filter (as line spectral frequencies), power and pitch
+void lpc_synthesize_interp( lpc_data instance, SAMPLE * y, int len,
+                            const float * lsf0, const float * lsf1, int order,
+                            float power0, float power1, float pitch0, float pitch1,
+                            int alt = 0 );
+// the filters alone, over an excitation in y (in place): lattice; for
+// overlapping frames; interpolated between frames
+void lpc_filter_lattice( lpc_data instance, SAMPLE * y, int len, const float * refl,
+                         int order );
+void lpc_filter_frame( lpc_data instance, SAMPLE * y, int len, int hop,
+                       const float * refl, int order );
+void lpc_filter_interp( lpc_data instance, SAMPLE * y, int len,
+                        const float * lsf0, const float * lsf1, int order );
 // apply filter
 void lpc_apply_filter( SAMPLE * y, int len, float * coefs,
                        int order, float power );
@@ -40,16 +74,44 @@ void lpc_apply_filter( SAMPLE * y, int len, float * coefs,
 void lpc_destroy( lpc_data & instance );
 
 
-// helper -- autocorrelation
-float autocorrelate( SAMPLE * x, int len, SAMPLE * y );
+// helper -- autocorrelation (the first lags of it, 0: all); returns the
+// pitch (lag), a peak at most len/4 out (lags past len/4 + 1 are not
+// looked at)
+float autocorrelate( SAMPLE * x, int len, SAMPLE * y, int lags = 0 );
+// helper -- levinson-durbin (tmp: order floats); returns the error power
+float lpc_levinson( const SAMPLE * corr, int order, float * coefs, float * refl,
+                    float * tmp );
 // helper -- lpc prediction 
 float lpc_predict( lpc_data lpc, SAMPLE * x, int len, float * coefs, int order );
+// helper -- predictor to reflection coefficients (tmp: order floats);
+// false if the filter is unstable
+bool lpc_to_reflection( const float * coefs, int order, float * refl, float * tmp );
+// helper -- predictor coefficients to line spectral frequencies (radians,
+// ascending); false if they weren't all found
+bool lpc_to_lsf( const float * coefs, int order, float * lsf );
+// helper -- line spectral frequencies to predictor coefficients
+void lsf_to_lpc( const float * lsf, int order, float * coefs );
+// helper -- line spectral frequencies, t of the way from lsf0 to lsf1
+void lsf_interpolate( const float * lsf0, const float * lsf1, int order, float t,
+                      float * lsf );
 // helper -- preemphasis
 void lpc_preemphasis( SAMPLE * x, int len, float alpha );
 // helper -- deemphasis
 void lpc_deemphasis( SAMPLE * y, int len, float alpha );
+// autocorrelation tracker: the first lags of the autocorrelation of the
+// last len samples pushed, kept up to date a sample at a time (O(lags)
+// per sample); or, decay > 0, of all of them, exponentially windowed
+lpc_corr lpc_corr_create( int len, int lags, float decay = 0 );
+void lpc_corr_push( lpc_corr c, const SAMPLE * x, int n );
+// the first lags of it, scaled and tapered like autocorrelate()
+void lpc_corr_get( lpc_corr c, float * corr, int lags );
+int lpc_corr_lags( lpc_corr c );
+void lpc_corr_reset( lpc_corr c );
+void lpc_corr_destroy( lpc_corr & c );
 // helper -- set alt src
 void lpc_alt( lpc_data lpc, SAMPLE * buffer, int len );
+// helper -- the alt src (glottal pulse, at 4x), and its length
+const SAMPLE * lpc_glottal( lpc_data lpc, int * len );
 
 
 
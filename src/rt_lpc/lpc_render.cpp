@@ -0,0 +1,531 @@
+/*----------------------------------------------------------------------------
+    lpc_render - offline LPC analysis/resynthesis and cross-synthesis
+
+    Copyright (c) 2004 Ananya Misra, Ge Wang, Perry R. Cook.  All rights reserved.
+      http://soundlab.cs.princeton.edu/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+    U.S.A.
+-----------------------------------------------------------------------------*/
+//-----------------------------------------------------------------------------
+// name: lpc_render.cpp
+// desc: rt_lpc's analysis/resynthesis, file to file, as fast as it goes
+//
+//       the modulator is analyzed a batch of frames at a time, the frames
+//       of a batch split between worker threads (each with its own lpc
+//       instance: frames don't depend on each other).  synthesis carries
+//       filter and excitation state from frame to frame, so it runs on
+//       its own, in order, overlap-adding frames as rt_lpc does (--ola1).
+//       the excitation is rt_lpc's (glottal pulses or a pulse train, and
+//       noise when unvoiced), or, given a carrier file, the carrier: each
+//       frame of it brought to the level of the modulator's residue and
+//       put through the modulator's filter.
+//
+//       the output is the modulator's length and rate, mono, float.
+//
+// usage: lpc_render --[options] modulator [carrier] output
+//-----------------------------------------------------------------------------
+#include <stdlib.h>
+#include <math.h>
+#include <stdio.h>
+#include <memory.h>
+#include <string.h>
+
+// libsndfile
+#if defined(__USE_SNDFILE_NATIVE__)
+#include <sndfile.h>
+#else
+#include "util_sndfile.h"
+#endif
+
+#include <pthread.h>
+
+#if defined(__OS_WINDOWS__)
+  #include <windows.h>
+#else
+  #include <unistd.h>
+  #include <sys/time.h>
+#endif
+
+#include "lpc.h"
+#include "ola.h"
+#include "yin.h"
+
+
+
+
+//-----------------------------------------------------------------------------
+// global variables and #defines
+//-----------------------------------------------------------------------------
+#define RENDER_MAX_WIN          16384
+// frames analyzed per batch
+#define RENDER_BATCH            1024
+#define RENDER_MAX_THREADS      64
+
+// one analysis
+struct Frame
+{
+    float refl[LPC_MAX_ORDER];
+    float power;
+    float pitch;
+};
+
+// one analysis thread (for the whole render): its frames of the batch
+struct Worker
+{
+    pthread_t thread;
+    lpc_data lpc;
+    yin_data yin;
+    SAMPLE * buffer;
+    float coefs[LPC_MAX_ORDER];
+    int first;
+    int last;
+};
+
+// settings (as rt_lpc's)
+int g_order = 30;
+int g_win_size = 2048;
+int g_hop_size = 0;
+float g_speed = 1.0f;
+bool g_train = false;
+bool g_balance = false;
+bool g_yin = true;
+int g_threads = 0;
+
+// the pool: workers wait on g_work for the next batch (g_batch moves
+// on), the main thread on g_idle for the last of them to finish it
+pthread_mutex_t g_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t g_work = PTHREAD_COND_INITIALIZER;
+pthread_cond_t g_idle = PTHREAD_COND_INITIALIZER;
+// (guarded by g_mutex) batches handed out, workers still on this one
+long g_batch = 0;
+int g_busy = 0;
+bool g_quit = false;
+
+// the batch: modulator windows (hop apart, the history first), analyses
+SAMPLE * g_mod = NULL;
+Frame * g_frames = NULL;
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: usage()
+// desc: ...
+//-----------------------------------------------------------------------------
+void usage()
+{
+    fprintf( stderr, "usage: lpc_render --[options] modulator [carrier] output\n" );
+    fprintf( stderr, "    order: filter order, up to %d (default 30)\n", LPC_MAX_ORDER );
+    fprintf( stderr, "    win: analysis window, power of 2 up to %d (default 2048)\n",
+             RENDER_MAX_WIN );
+    fprintf( stderr, "    hop: dividing the window, at most half of it (default win/4)\n" );
+    fprintf( stderr, "    speed: pitch divided by this (default 1.0)\n" );
+    fprintf( stderr, "    train: pulse train instead of glottal pulses (default 0)\n" );
+    fprintf( stderr, "    balance: pre/deemphasis (default 0)\n" );
+    fprintf( stderr, "    yin: pitch by yin (default 1), else the autocorrelation peak\n" );
+    fprintf( stderr, "    threads: analysis threads (default: cpus)\n" );
+    fprintf( stderr, "  the carrier, if any, is the excitation (same sample rate)\n" );
+    fprintf( stderr, "\n" );
+    fprintf( stderr, "example:\n" );
+    fprintf( stderr, "    lpc_render --order40 --speed1.5 voice.wav strings.wav out.wav\n" );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: cpus()
+// desc: processors online
+//-----------------------------------------------------------------------------
+int cpus()
+{
+#if defined(__OS_WINDOWS__)
+    SYSTEM_INFO info;
+    GetSystemInfo( &info );
+    return (int)info.dwNumberOfProcessors;
+#else
+    return (int)sysconf( _SC_NPROCESSORS_ONLN );
+#endif
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: now_usec()
+// desc: wall clock (usec, from whenever)
+//-----------------------------------------------------------------------------
+double now_usec()
+{
+#if !defined(__OS_WINDOWS__)
+    struct timeval tv;
+    gettimeofday( &tv, NULL );
+    return tv.tv_sec * 1000000.0 + tv.tv_usec;
+#else
+    LARGE_INTEGER freq, count;
+    QueryPerformanceFrequency( &freq );
+    QueryPerformanceCounter( &count );
+    return count.QuadPart * 1000000.0 / freq.QuadPart;
+#endif
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: read_mono()
+// desc: up to n frames, mixed to mono; zeros past the end
+//-----------------------------------------------------------------------------
+void read_mono( SNDFILE * sf, int channels, float * scratch, SAMPLE * out, long n )
+{
+    long got = 0, count, i;
+    int c;
+
+    while( sf && got < n )
+    {
+        count = (long)sf_readf_float( sf, scratch, n - got < RENDER_BATCH ? n - got : RENDER_BATCH );
+        if( count <= 0 ) break;
+        for( i = 0; i < count; i++ )
+        {
+            float sum = 0.0f;
+            for( c = 0; c < channels; c++ )
+                sum += scratch[i*channels+c];
+            out[got+i] = sum / channels;
+        }
+        got += count;
+    }
+
+    memset( out + got, 0, ( n - got ) * sizeof(SAMPLE) );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: analyze_frames()
+// desc: a worker's frames of the batch
+//-----------------------------------------------------------------------------
+void analyze_frames( Worker * w, int first, int last )
+{
+    for( int j = first; j < last; j++ )
+    {
+        Frame * f = g_frames + j;
+        const SAMPLE * window = g_mod + j * g_hop_size;
+        memcpy( w->buffer, window, g_win_size * sizeof(SAMPLE) );
+        if( g_balance )
+            lpc_preemphasis( w->buffer, g_win_size, .5 );
+        lpc_analyze( w->lpc, w->buffer, g_win_size, w->coefs, g_order,
+                     &f->power, w->yin ? NULL : &f->pitch, NULL, f->refl );
+        // --yin: the pitch from the window as it came in
+        if( w->yin )
+            f->pitch = yin_pitch( w->yin, window );
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: analyze_thread()
+// desc: its share of every batch, until told to quit
+//-----------------------------------------------------------------------------
+void * analyze_thread( void * data )
+{
+    Worker * w = (Worker *)data;
+    long seen = 0;
+
+    pthread_mutex_lock( &g_mutex );
+    while( true )
+    {
+        while( !g_quit && g_batch == seen )
+            pthread_cond_wait( &g_work, &g_mutex );
+        if( g_quit )
+            break;
+        seen = g_batch;
+        int first = w->first, last = w->last;
+        pthread_mutex_unlock( &g_mutex );
+
+        analyze_frames( w, first, last );
+
+        // (the lock orders the frames before the main thread reads them)
+        pthread_mutex_lock( &g_mutex );
+        if( --g_busy == 0 )
+            pthread_cond_signal( &g_idle );
+    }
+    pthread_mutex_unlock( &g_mutex );
+
+    return NULL;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: open_in()
+// desc: ...
+//-----------------------------------------------------------------------------
+SNDFILE * open_in( const char * path, SF_INFO * info )
+{
+    memset( info, 0, sizeof(SF_INFO) );
+    SNDFILE * sf = sf_open( path, SFM_READ, info );
+    if( !sf )
+        fprintf( stderr, "lpc_render: cannot open '%s' (%s)...\n", path, sf_strerror( NULL ) );
+    else if( info->channels <= 0 || info->samplerate <= 0 )
+    {
+        fprintf( stderr, "lpc_render: cannot read '%s'...\n", path );
+        sf_close( sf );
+        sf = NULL;
+    }
+
+    return sf;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: main()
+// desc: entry point
+//-----------------------------------------------------------------------------
+int main( int argc, char ** argv )
+{
+    const char * paths[3];
+    int num_paths = 0, n, i, j;
+
+    // parse command line arguments
+    for( n = 1; n < argc; n++ )
+    {
+        if( strncmp( argv[n], "--order", 7 ) == 0 )
+            g_order = atoi( argv[n]+7 );
+        else if( strncmp( argv[n], "--win", 5 ) == 0 )
+            g_win_size = atoi( argv[n]+5 );
+        else if( strncmp( argv[n], "--hop", 5 ) == 0 )
+            g_hop_size = atoi( argv[n]+5 );
+        else if( strncmp( argv[n], "--speed", 7 ) == 0 )
+            g_speed = (float)atof( argv[n]+7 );
+        else if( strncmp( argv[n], "--train", 7 ) == 0 )
+            g_train = !!atoi( argv[n]+7 );
+        else if( strncmp( argv[n], "--balance", 9 ) == 0 )
+            g_balance = !!atoi( argv[n]+9 );
+        else if( strncmp( argv[n], "--yin", 5 ) == 0 )
+            g_yin = !!atoi( argv[n]+5 );
+        else if( strncmp( argv[n], "--threads", 9 ) == 0 )
+            g_threads = atoi( argv[n]+9 );
+        else if( strncmp( argv[n], "--", 2 ) == 0 || num_paths == 3 )
+        {
+            fprintf( stderr, "lpc_render: unrecognized argument '%s'...\n", argv[n] );
+            usage();
+            exit( 1 );
+        }
+        else
+            paths[num_paths++] = argv[n];
+    }
+
+    // check
+    if( !g_hop_size ) g_hop_size = g_win_size / 4;
+    if( g_threads <= 0 ) g_threads = cpus();
+    if( g_threads <= 0 ) g_threads = 1;
+    if( g_threads > RENDER_MAX_THREADS ) g_threads = RENDER_MAX_THREADS;
+    if( num_paths < 2 || g_order <= 0 || g_order > LPC_MAX_ORDER ||
+        g_win_size < 4 || g_win_size > RENDER_MAX_WIN || ( g_win_size & ( g_win_size - 1 ) ) ||
+        g_hop_size <= 0 || g_hop_size > g_win_size / 2 || g_win_size % g_hop_size ||
+        g_order >= g_win_size || g_speed <= 0 )
+    {
+        usage();
+        exit( 1 );
+    }
+
+    // files
+    SF_INFO mod_info, car_info, out_info;
+    SNDFILE * mod = open_in( paths[0], &mod_info );
+    SNDFILE * car = NULL;
+    if( !mod ) exit( 1 );
+    if( num_paths == 3 )
+    {
+        if( !( car = open_in( paths[1], &car_info ) ) ) exit( 1 );
+        if( car_info.samplerate != mod_info.samplerate )
+        {
+            fprintf( stderr, "lpc_render: '%s' is at %d Hz, '%s' at %d...\n", paths[1],
+                     car_info.samplerate, paths[0], mod_info.samplerate );
+            exit( 1 );
+        }
+    }
+    memset( &out_info, 0, sizeof(SF_INFO) );
+    out_info.samplerate = mod_info.samplerate;
+    out_info.channels = 1;
+    out_info.format = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+    SNDFILE * out = sf_open( paths[num_paths-1], SFM_WRITE, &out_info );
+    if( !out )
+    {
+        fprintf( stderr, "lpc_render: cannot write '%s' (%s)...\n", paths[num_paths-1],
+                 sf_strerror( NULL ) );
+        exit( 1 );
+    }
+
+    // the batch's windows share all but a hop with the next: the history
+    // (win - hop) and the batch's new input, for modulator and carrier
+    int history = g_win_size - g_hop_size;
+    long span = history + (long)RENDER_BATCH * g_hop_size;
+    int channels = mod_info.channels > ( car ? car_info.channels : 1 ) ?
+                   mod_info.channels : ( car ? car_info.channels : 1 );
+    float * scratch = new float[RENDER_BATCH * channels];
+    g_mod = new SAMPLE[span];
+    SAMPLE * carrier = car ? new SAMPLE[span] : NULL;
+    g_frames = new Frame[RENDER_BATCH];
+    memset( g_mod, 0, span * sizeof(SAMPLE) );
+    if( carrier ) memset( carrier, 0, span * sizeof(SAMPLE) );
+
+    // synthesis: overlap-add; a frame's output lags its window by
+    // win - hop, which is dropped from the front.  (its lpc instance
+    // first: its noise is the same however many workers there are)
+    lpc_data synth_lpc = lpc_create();
+    ola_data ola = ola_create( g_win_size, g_hop_size );
+
+    // workers (lpc_create() isn't for more than one thread at once), all
+    // made before any starts; those that won't start, the main thread
+    // stands in for
+    Worker workers[RENDER_MAX_THREADS];
+    int running = 0;
+    for( i = 0; i < g_threads; i++ )
+    {
+        workers[i].lpc = lpc_create();
+        workers[i].yin = g_yin ? yin_create( g_win_size ) : NULL;
+        workers[i].buffer = new SAMPLE[g_win_size];
+        workers[i].first = workers[i].last = 0;
+    }
+    for( i = 0; i < g_threads; i++ )
+    {
+        if( pthread_create( &workers[i].thread, NULL, analyze_thread, workers + i ) )
+            break;
+        running++;
+    }
+
+    SAMPLE * frame = new SAMPLE[g_win_size];
+    SAMPLE * hop = new SAMPLE[g_hop_size];
+    long length = (long)mod_info.frames;
+    long total = ( length + history + g_hop_size - 1 ) / g_hop_size;
+    long skip = history, written = 0, done = 0;
+    double begin = now_usec();
+
+    while( done < total )
+    {
+        int count = total - done < RENDER_BATCH ? (int)( total - done ) : RENDER_BATCH;
+
+        // the batch's input
+        read_mono( mod, mod_info.channels, scratch, g_mod + history, (long)count * g_hop_size );
+        if( carrier )
+            read_mono( car, car_info.channels, scratch, carrier + history,
+                       (long)count * g_hop_size );
+
+        // analysis, in parallel: a share for each worker, then wait
+        if( running )
+        {
+            int per = ( count + running - 1 ) / running;
+            pthread_mutex_lock( &g_mutex );
+            for( i = 0; i < running; i++ )
+            {
+                int first = i * per < count ? i * per : count;
+                workers[i].first = first;
+                workers[i].last = first + per < count ? first + per : count;
+            }
+            g_busy = running;
+            g_batch++;
+            pthread_cond_broadcast( &g_work );
+            while( g_busy )
+                pthread_cond_wait( &g_idle, &g_mutex );
+            pthread_mutex_unlock( &g_mutex );
+        }
+        else
+            analyze_frames( workers, 0, count );
+
+        // synthesis, in order
+        for( j = 0; j < count; j++ )
+        {
+            Frame * f = g_frames + j;
+            if( carrier )
+            {
+                // the carrier's frame, at the level of the residue
+                float sum = 0.0f, gain;
+                memcpy( frame, carrier + j * g_hop_size, g_win_size * sizeof(SAMPLE) );
+                if( g_balance )
+                    lpc_preemphasis( frame, g_win_size, .5 );
+                for( i = 0; i < g_win_size; i++ )
+                    sum += frame[i] * frame[i];
+                gain = sum > 1e-12f ? f->power * sqrtf( (float)( g_win_size - g_order ) /
+                                                      ( sum / g_win_size ) ) : 0.0f;
+                for( i = 0; i < g_win_size; i++ )
+                    frame[i] *= gain;
+                lpc_filter_frame( synth_lpc, frame, g_win_size, g_hop_size, f->refl, g_order );
+            }
+            else
+                lpc_synthesize_frame( synth_lpc, frame, g_win_size, g_hop_size, f->refl,
+                                      g_order, f->power, f->pitch / g_speed, !g_train );
+            if( g_balance )
+                lpc_deemphasis( frame, g_win_size, .5 );
+            ola_output( ola, frame, hop );
+
+            // out, past the lag, up to the modulator's length
+            long from = skip < g_hop_size ? skip : g_hop_size;
+            long n_out = g_hop_size - from;
+            skip -= from;
+            if( n_out > length - written ) n_out = length - written;
+            if( n_out > 0 && sf_writef_float( out, hop + from, n_out ) != n_out )
+            {
+                fprintf( stderr, "lpc_render: cannot write '%s'...\n", paths[num_paths-1] );
+                exit( 1 );
+            }
+            if( n_out > 0 ) written += n_out;
+        }
+
+        // the next batch's history
+        memmove( g_mod, g_mod + (long)count * g_hop_size, history * sizeof(SAMPLE) );
+        if( carrier )
+            memmove( carrier, carrier + (long)count * g_hop_size, history * sizeof(SAMPLE) );
+        done += count;
+    }
+
+    double seconds = ( now_usec() - begin ) / 1000000.0;
+    fprintf( stderr, "lpc_render: %.1f sec of audio in %.1f sec (%.1fx real time, %d threads)\n",
+             length / (double)mod_info.samplerate, seconds,
+             seconds > 0 ? length / (double)mod_info.samplerate / seconds : 0.0, g_threads );
+
+    // done
+    sf_close( out );
+    sf_close( mod );
+    if( car ) sf_close( car );
+    pthread_mutex_lock( &g_mutex );
+    g_quit = true;
+    pthread_cond_broadcast( &g_work );
+    pthread_mutex_unlock( &g_mutex );
+    for( i = 0; i < running; i++ )
+        pthread_join( workers[i].thread, NULL );
+    for( i = 0; i < g_threads; i++ )
+    {
+        lpc_destroy( workers[i].lpc );
+        yin_destroy( workers[i].yin );
+        delete [] workers[i].buffer;
+    }
+    lpc_destroy( synth_lpc );
+    ola_destroy( ola );
+    delete [] frame;
+    delete [] hop;
+    delete [] g_frames;
+    delete [] g_mod;
+    delete [] carrier;
+    delete [] scratch;
+
+    return 0;
+}
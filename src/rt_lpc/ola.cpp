@@ -0,0 +1,157 @@
+//-----------------------------------------------------------------------------
+// name: ola.cpp
+// desc: overlap-add framing, for analysis/resynthesis a hop at a time
+//-----------------------------------------------------------------------------
+#include "ola.h"
+#include "chuck_fft.h"
+#include <stdlib.h>
+#include <memory.h>
+
+
+
+
+// internal data structure
+struct ola_data_
+{
+    int win_size;
+    int hop_size;
+    // analysis window (input history)
+    SAMPLE * in;
+    // synthesis window, overlap-add sum, 1 / window overlap (per hop sample)
+    SAMPLE * window;
+    SAMPLE * sum;
+    SAMPLE * norm;
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ola_create()
+// desc: ...
+//-----------------------------------------------------------------------------
+ola_data ola_create( int win_size, int hop_size )
+{
+    int i, k;
+
+    if( win_size <= 0 || hop_size <= 0 || hop_size > win_size / 2 ||
+        win_size % hop_size )
+        return NULL;
+
+    ola_data instance = new ola_data_;
+    instance->win_size = win_size;
+    instance->hop_size = hop_size;
+    instance->in = new SAMPLE[win_size];
+    instance->window = new SAMPLE[win_size];
+    instance->sum = new SAMPLE[win_size];
+    instance->norm = new SAMPLE[hop_size];
+
+    // periodic hann
+    make_window( instance->window, win_size );
+    // every output sample is the sum of win_size / hop_size frames
+    for( i = 0; i < hop_size; i++ )
+    {
+        SAMPLE overlap = 0.0f;
+        for( k = i; k < win_size; k += hop_size )
+            overlap += instance->window[k];
+        instance->norm[i] = overlap > 0.0f ? 1.0f / overlap : 0.0f;
+    }
+
+    ola_reset( instance );
+
+    return instance;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ola_destroy()
+// desc: ...
+//-----------------------------------------------------------------------------
+void ola_destroy( ola_data & instance )
+{
+    if( instance )
+    {
+        delete [] instance->in;
+        delete [] instance->window;
+        delete [] instance->sum;
+        delete [] instance->norm;
+
+        delete instance;
+        instance = NULL;
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ola_reset()
+// desc: ...
+//-----------------------------------------------------------------------------
+void ola_reset( ola_data instance )
+{
+    memset( instance->in, 0, instance->win_size * sizeof(SAMPLE) );
+    memset( instance->sum, 0, instance->win_size * sizeof(SAMPLE) );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ola_input()
+// desc: ...
+//-----------------------------------------------------------------------------
+const SAMPLE * ola_input( ola_data instance, const SAMPLE * hop )
+{
+    int keep = instance->win_size - instance->hop_size;
+
+    // slide the window along by a hop
+    memmove( instance->in, instance->in + instance->hop_size, keep * sizeof(SAMPLE) );
+    memcpy( instance->in + keep, hop, instance->hop_size * sizeof(SAMPLE) );
+
+    return instance->in;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ola_output()
+// desc: ...
+//-----------------------------------------------------------------------------
+void ola_output( ola_data instance, const SAMPLE * frame, SAMPLE * hop )
+{
+    int i, win = instance->win_size, n = instance->hop_size;
+    SAMPLE * sum = instance->sum;
+
+    // add the frame in
+    for( i = 0; i < win; i++ )
+        sum[i] += frame[i] * instance->window[i];
+
+    // no frame to come overlaps the first hop any more
+    for( i = 0; i < n; i++ )
+        hop[i] = sum[i] * instance->norm[i];
+
+    // the rest moves up
+    memmove( sum, sum + n, ( win - n ) * sizeof(SAMPLE) );
+    memset( sum + win - n, 0, n * sizeof(SAMPLE) );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ola_win_size() / ola_hop_size()
+// desc: ...
+//-----------------------------------------------------------------------------
+int ola_win_size( ola_data instance )
+{
+    return instance->win_size;
+}
+
+int ola_hop_size( ola_data instance )
+{
+    return instance->hop_size;
+}
@@ -0,0 +1,44 @@
+//-----------------------------------------------------------------------------
+// name: ola.h
+// desc: overlap-add framing, for analysis/resynthesis a hop at a time
+//
+//       input arrives one hop at a time, and each hop completes the next
+//       analysis window (the last win_size samples).  each resynthesized
+//       frame (win_size samples) is hann windowed and added into the
+//       output; once it is in, the oldest hop of the sum is finished.
+//       the window overlap is normalized out, so any hop that divides
+//       the window (up to half of it) comes out at unity gain.
+//
+//       from a window's newest input sample to the first output sample
+//       of its frame is win_size samples.
+//-----------------------------------------------------------------------------
+#ifndef __OLA_H__
+#define __OLA_H__
+
+#ifndef SAMPLE
+#define SAMPLE float
+#endif
+
+
+// forward reference
+typedef struct ola_data_ * ola_data;
+
+
+// init: hop_size must divide win_size, and be at most win_size / 2
+ola_data ola_create( int win_size, int hop_size );
+// one hop of input in; the analysis window out (win_size, oldest first)
+const SAMPLE * ola_input( ola_data instance, const SAMPLE * hop );
+// one resynthesized frame (win_size) in; the next finished hop out
+void ola_output( ola_data instance, const SAMPLE * frame, SAMPLE * hop );
+// forget all input and output so far
+void ola_reset( ola_data instance );
+// sizes
+int ola_win_size( ola_data instance );
+int ola_hop_size( ola_data instance );
+// done
+void ola_destroy( ola_data & instance );
+
+
+
+
+#endif
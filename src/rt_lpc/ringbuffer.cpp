@@ -0,0 +1,232 @@
+//-----------------------------------------------------------------------------
+// name: ringbuffer.cpp
+// desc: lock-free single-producer / single-consumer ring buffer
+//-----------------------------------------------------------------------------
+#include "ringbuffer.h"
+#include <stdlib.h>
+#include <memory.h>
+
+#if defined(_MSC_VER)
+  #include <windows.h>
+#endif
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: fence()
+// desc: full memory barrier
+//-----------------------------------------------------------------------------
+void RingBuffer::fence()
+{
+#if defined(_MSC_VER)
+    MemoryBarrier();
+#else
+    __sync_synchronize();
+#endif
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: RingBuffer()
+// desc: ...
+//-----------------------------------------------------------------------------
+RingBuffer::RingBuffer()
+{
+    m_data = NULL;
+    m_width = 0;
+    m_max_elem = 0;
+    m_mask = 0;
+    m_write = 0;
+    m_read = 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ~RingBuffer()
+// desc: ...
+//-----------------------------------------------------------------------------
+RingBuffer::~RingBuffer()
+{
+    this->cleanup();
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: initialize()
+// desc: ...
+//-----------------------------------------------------------------------------
+bool RingBuffer::initialize( unsigned long num_elem, unsigned long width )
+{
+    // clean up
+    this->cleanup();
+
+    if( !num_elem || !width )
+        return false;
+
+    // round up to power of two
+    unsigned long size = 1;
+    while( size < num_elem ) size <<= 1;
+
+    // allocate
+    m_data = (unsigned char *)malloc( size * width );
+    if( !m_data )
+        return false;
+    memset( m_data, 0, size * width );
+
+    m_width = width;
+    m_max_elem = size;
+    m_mask = size - 1;
+    m_write = 0;
+    m_read = 0;
+
+    return true;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: cleanup()
+// desc: ...
+//-----------------------------------------------------------------------------
+void RingBuffer::cleanup()
+{
+    if( m_data )
+    {
+        free( m_data );
+        m_data = NULL;
+    }
+
+    m_width = 0;
+    m_max_elem = 0;
+    m_mask = 0;
+    m_write = 0;
+    m_read = 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: readable()
+// desc: ...
+//-----------------------------------------------------------------------------
+unsigned long RingBuffer::readable() const
+{
+    return m_write - m_read;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: writable()
+// desc: ...
+//-----------------------------------------------------------------------------
+unsigned long RingBuffer::writable() const
+{
+    return m_max_elem - ( m_write - m_read );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: put()
+// desc: producer only
+//-----------------------------------------------------------------------------
+unsigned long RingBuffer::put( const void * data, unsigned long num_elem )
+{
+    unsigned long w = m_write;
+    unsigned long room = m_max_elem - ( w - m_read );
+    if( num_elem > room ) num_elem = room;
+    if( !num_elem ) return 0;
+
+    // copy, in up to two pieces
+    unsigned long start = w & m_mask;
+    unsigned long first = m_max_elem - start;
+    if( first > num_elem ) first = num_elem;
+    memcpy( m_data + start * m_width, data, first * m_width );
+    if( num_elem > first )
+        memcpy( m_data, (const unsigned char *)data + first * m_width,
+                ( num_elem - first ) * m_width );
+
+    // data must land before the consumer can see the new position
+    fence();
+    m_write = w + num_elem;
+
+    return num_elem;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: get()
+// desc: consumer only
+//-----------------------------------------------------------------------------
+unsigned long RingBuffer::get( void * data, unsigned long num_elem )
+{
+    unsigned long r = m_read;
+    unsigned long avail = m_write - r;
+    if( num_elem > avail ) num_elem = avail;
+    if( !num_elem ) return 0;
+
+    // don't read the data before the position that published it
+    fence();
+
+    // copy, in up to two pieces
+    unsigned long start = r & m_mask;
+    unsigned long first = m_max_elem - start;
+    if( first > num_elem ) first = num_elem;
+    memcpy( data, m_data + start * m_width, first * m_width );
+    if( num_elem > first )
+        memcpy( (unsigned char *)data + first * m_width, m_data,
+                ( num_elem - first ) * m_width );
+
+    // done with the space before handing it back to the producer
+    fence();
+    m_read = r + num_elem;
+
+    return num_elem;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: discard()
+// desc: consumer only
+//-----------------------------------------------------------------------------
+unsigned long RingBuffer::discard( unsigned long num_elem )
+{
+    unsigned long r = m_read;
+    unsigned long avail = m_write - r;
+    if( num_elem > avail ) num_elem = avail;
+
+    fence();
+    m_read = r + num_elem;
+
+    return num_elem;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: skip_to()
+// desc: consumer only
+//-----------------------------------------------------------------------------
+void RingBuffer::skip_to( unsigned long pos )
+{
+    // signed distance, so wrap-around of the counters is harmless
+    long ahead = (long)( pos - m_read );
+    if( ahead > 0 ) discard( (unsigned long)ahead );
+}
@@ -37,8 +37,13 @@
 #include <memory.h>
 #include <string.h>
 #include <assert.h>
-#include <queue>
-using namespace std;
+
+// libsndfile
+#if defined(__USE_SNDFILE_NATIVE__)
+#include <sndfile.h>
+#else
+#include "util_sndfile.h"
+#endif
 
 // STK
 #include "RtAudio.h"
@@ -59,6 +64,7 @@ using namespace std;
   #include <process.h>
 #else
   #include <unistd.h>
+  #include <sys/time.h>
 #endif
 
 #if defined(__MACOSX_CORE__)
@@ -74,6 +80,10 @@ using namespace std;
 #endif
 
 #include "lpc.h"
+#include "ola.h"
+#include "ringbuffer.h"
+#include "voices.h"
+#include "yin.h"
 #include "chuck_fft.h"
 
 
@@ -95,6 +105,13 @@ void real_peel( float * coef, int order, float * radii );
 void lintube( float * radii, int order );
 void sectube( float * radii, int order );
 void moretube( float * radii, int order );
+bool start_dsp( );
+void read_carrier( SAMPLE * y, int len );
+void dsp_process( const SAMPLE * in, const SAMPLE * car, SAMPLE * out );
+double now_usec( );
+bool start_midi( );
+void excite_voices( SAMPLE * y, int len, int hop, long start, float power,
+                    const SAMPLE * glot, int glot_len );
 
 
 
@@ -132,25 +149,99 @@ GLUquadricObj * g_quad = NULL;
 
 // global audio buffer
 SAMPLE g_audio_buffer[LPC_BUFFER_SIZE];
-SAMPLE g_another_buffer[LPC_BUFFER_SIZE];
-SAMPLE g_buffest[LPC_BUFFER_SIZE];
 SAMPLE g_impulse_response[LPC_BUFFER_SIZE];
-GLboolean g_ready = FALSE;
 GLfloat g_window[LPC_BUFFER_SIZE];
 int g_buffer_size = LPC_BUFFER_SIZE;
 RtAudio * g_audio = NULL;
 Mutex g_mutex;
 #if defined(__LINUX_ALSA__) || defined(__LINUX_OSS__) || defined(__LINUX_JACK__)
 unsigned int g_srate = 48000;
-GLboolean do_ola = FALSE;
 #elif defined(__MACOSX_CORE__)
 unsigned int g_srate = 44100;
-GLboolean do_ola = FALSE;
 #else
 unsigned int g_srate = 22050;
-GLboolean do_ola = FALSE;
 #endif
 
+// the dsp engine: the callback puts its mono input into g_in_ring; the
+// dsp thread analyzes and resynthesizes it a hop at a time, into
+// g_out_ring, for the callback to play.  overlap-add (--ola1, the
+// default) or, with --ola0, back to back windows (hop = window)
+GLboolean do_ola = TRUE;
+int g_win_size = LPC_BUFFER_SIZE;
+int g_hop_size = LPC_BUFFER_SIZE / 4;
+// --lsf<N>: analyze only every N hops, and synthesize continuously in
+// between, interpolating (line spectral frequencies, power, pitch) from
+// the last analysis to the newest; no overlap-add on the output
+int g_lsf_hops = 0;
+// --track<N>: the autocorrelation lags follow the input a hop at a time,
+// over the window (1, the default) or exponentially windowed (2),
+// instead of being summed from scratch for every analysis (0)
+int g_track = 1;
+lpc_corr g_corr = NULL;
+// --yin<0|1>: the pitch from yin (1, the default: to a fraction of a
+// sample, with a voicing confidence) or the autocorrelation's peak (0)
+GLboolean g_yin = TRUE;
+yin_data g_pitch = NULL;
+// --cross: the excitation is a second input, put through the first's
+// filter (interpolated across each hop, as --lsf, analyzing every hop
+// unless told otherwise): the right input channel (the voice on the
+// left), or with --cross:<file>, a sound file, looped
+GLboolean g_cross = FALSE;
+const char * g_carrier_path = NULL;
+SNDFILE * g_carrier = NULL;
+SF_INFO g_carrier_info;
+float * g_carrier_scratch = NULL;
+RingBuffer g_car_ring;
+// midi: a voice per note (--voices<N> at once), all through the one filter
+int g_max_voices = 16;
+voice_pool g_voices = NULL;
+ola_data g_ola = NULL;
+RingBuffer g_in_ring;
+RingBuffer g_out_ring;
+Thread g_dsp_thread;
+SAMPLE g_out_buffer[LPC_BUFFER_SIZE];
+// 'k': the callback drops what's queued for output
+volatile GLboolean g_flush = FALSE;
+// input frames queued minus output frames played (set by the callback)
+volatile long g_io_offset = 0;
+// input lost to a full ring, output the ring could not supply
+volatile unsigned long g_overruns = 0;
+volatile unsigned long g_underruns = 0;
+// input-to-output latency (samples): last hop, worst since 'l'; and
+// what the device adds
+volatile float g_latency = 0;
+volatile float g_latency_max = 0;
+long g_device_latency = 0;
+// frames per callback, as the device took them
+long g_device_buffer = 0;
+// the stream clock: frames the callback has played, and when (usec);
+// g_clock_seq is odd while the callback is changing them
+volatile unsigned long g_clock_seq = 0;
+volatile long g_clock_frames = 0;
+volatile double g_clock_usec = 0;
+// frames played that were not from g_out_ring (silence), less ring
+// frames never played ('k'): a ring position plus this is a stream frame
+volatile long g_out_skew = 0;
+
+// what the dsp thread hands the display: whole frames, through a ring
+// of two (when the display hasn't taken the last one yet, the dsp
+// thread skips handing over the next)
+struct DspFrame
+{
+    SAMPLE buffer[LPC_BUFFER_SIZE];
+    SAMPLE synth[LPC_BUFFER_SIZE];
+    SAMPLE residue[LPC_BUFFER_SIZE];
+    float coefs[LPC_MAX_ORDER];
+    float refl[LPC_MAX_ORDER];
+    // the order coefs were analyzed at (g_order may have moved since)
+    int order;
+    float power;
+    float pitch;
+    float voicing;
+    int voices;
+};
+RingBuffer g_frames;
+
 // gain
 GLfloat g_gain = 1.0f;
 GLfloat g_time_scale = 1.0f;
@@ -158,6 +249,22 @@ GLfloat g_freq_scale = 1.5f;
 GLint g_time_view = 1;
 GLint g_freq_view = 2;
 MidiIn * g_min = NULL;
+// midi events, stamped with the stream frame they came in at by the midi
+// thread; the dsp thread plays each g_midi_delay later, at its own sample
+struct MidiEvent
+{
+    MidiMsg msg;
+    long frame;
+};
+RingBuffer g_midi_ring;
+Thread g_midi_thread;
+long g_midi_delay = 0;
+// (dsp thread) the next event, when it's for a later hop
+MidiEvent g_midi_next;
+GLboolean g_midi_pending = FALSE;
+// events the dsp thread got too late to play on time, or had no room for
+volatile unsigned long g_midi_late = 0;
+volatile unsigned long g_midi_dropped = 0;
 
 lpc_data g_lpc = NULL;
 float g_speed = 1.0f;
@@ -192,95 +299,6 @@ int g_which = 0;
 GLboolean g_train = FALSE;
 GLboolean g_balance = FALSE;
 
-static const float midi2pitch[129] = {
-8.18,8.66,9.18,9.72,10.30,10.91,11.56,12.25,
-12.98,13.75,14.57,15.43,16.35,17.32,18.35,19.45,
-20.60,21.83,23.12,24.50,25.96,27.50,29.14,30.87,
-32.70,34.65,36.71,38.89,41.20,43.65,46.25,49.00,
-51.91,55.00,58.27,61.74,65.41,69.30,73.42,77.78,
-82.41,87.31,92.50,98.00,103.83,110.00,116.54,123.47,
-130.81,138.59,146.83,155.56,164.81,174.61,185.00,196.00,
-207.65,220.00,233.08,246.94,261.63,277.18,293.66,311.13,
-329.63,349.23,369.99,392.00,415.30,440.00,466.16,493.88,
-523.25,554.37,587.33,622.25,659.26,698.46,739.99,783.99,
-830.61,880.00,932.33,987.77,1046.50,1108.73,1174.66,1244.51,
-1318.51,1396.91,1479.98,1567.98,1661.22,1760.00,1864.66,1975.53,
-2093.00,2217.46,2349.32,2489.02,2637.02,2793.83,2959.96,3135.96,
-3322.44,3520.00,3729.31,3951.07,4186.01,4434.92,4698.64,4978.03,
-5274.04,5587.65,5919.91,6271.93,6644.88,7040.00,7458.62,7902.13,
-8372.02,8869.84,9397.27,9956.06,10548.08,11175.30,11839.82,12543.85,
-13289.75
-};
-
-typedef unsigned long uint__;
-
-struct the_queue
-{
-    queue<SAMPLE *> q;
-    CBuffer p;
-    uint__ bs;
-    
-    the_queue() { bs = 0; }
-    
-    void be( uint__ pool_size, uint__ buffer_size )
-    {
-         p.initialize( pool_size, sizeof(SAMPLE *) );
-         uint__ i;
-         SAMPLE * w;
-         for( i = 1; i < pool_size * 3 / 4; i++ )
-         {
-             w = new SAMPLE[buffer_size];
-             p.put( &w, 1 );
-         }
-         bs = buffer_size;
-    }
-    
-    uint__ size() { return q.size(); }
-    
-    void enqueue( SAMPLE * buffer )
-    {
-        SAMPLE * w;
-        
-        // get from pool
-        if( !p.get( &w, 1 ) )
-        {
-            fprintf( stderr, "[rt_lpc]: pool exhausted!\n" );
-            assert( FALSE );
-        }
-        
-        // copy
-        memcpy( w, buffer, bs * sizeof(SAMPLE) );
-        
-        q.push( w );
-    }
-    
-    void dequeue( SAMPLE * buffer )
-    {
-        if( q.size() == 0 )
-        {
-            fprintf( stderr, "[rt_lpc]: nothing to dequeue! now look what you have done...\n" );
-            assert( FALSE );
-        }
-        SAMPLE * w = q.front();
-        q.pop();
-
-        if( buffer != NULL )
-            // copy
-            memcpy( buffer, w, bs * sizeof(SAMPLE) );
-        memset( w, 0, bs * sizeof(SAMPLE) );
-        
-        // throw back in to pool
-        p.put( &w, 1 );
-    }
-
-    void clear()
-    {
-        while( size() ) dequeue( NULL );
-    }
-};
-
-the_queue g_q;
-
 
 
 
@@ -304,7 +322,8 @@ void help()
     fprintf( stderr, "'v' - select vocal tract rendering mode\n" );
     fprintf( stderr, "'g' - toggle using impulse train / glottal pulse\n" );
     fprintf( stderr, "'b' - toggle preemphasis and deemphasis filter\n" );
-    fprintf( stderr, "'k' - (OLA only) clear buffer queue (0 delay)\n" );
+    fprintf( stderr, "'k' - clear buffer queue (0 delay)\n" );
+    fprintf( stderr, "'l' - print latency, reset the worst\n" );
     fprintf( stderr, "'m' - use MIDI input as pitch\n" );
     fprintf( stderr, "'w' - toggle wutrfall plot\n" );
     fprintf( stderr, "'d' - toggle dB plot for spectrum\n" );
@@ -328,7 +347,18 @@ void help()
 //-----------------------------------------------------------------------------
 void usage()
 {
-    fprintf( stderr, "usage: rt_lpc --srate<N>\n" );
+    fprintf( stderr, "usage: rt_lpc --srate<N> --ola<0|1> --win<N> --hop<N> --lsf<N> --track<0|1|2>\n" );
+    fprintf( stderr, "              --yin<0|1> --voices<N> --cross[:<file>]\n" );
+    fprintf( stderr, "    ola: overlap-add resynthesis (default 1), else whole windows\n" );
+    fprintf( stderr, "    win: analysis window, power of 2 up to %d (default %d)\n",
+             LPC_BUFFER_SIZE, LPC_BUFFER_SIZE );
+    fprintf( stderr, "    hop: (ola) dividing the window, at most half of it (default win/4)\n" );
+    fprintf( stderr, "    lsf: analyze every N hops, interpolate in between (default off)\n" );
+    fprintf( stderr, "    track: autocorrelation kept up to date: 1 sliding (default),\n" );
+    fprintf( stderr, "           2 recursive, 0 per analysis (--yin0's pitch is still per analysis)\n" );
+    fprintf( stderr, "    yin: pitch by yin (default 1), else the autocorrelation peak\n" );
+    fprintf( stderr, "    voices: midi notes at once (default 16)\n" );
+    fprintf( stderr, "    cross: the right input (or the file, looped) through the left's filter\n" );
 }
 
 
@@ -363,6 +393,7 @@ int main( int argc, char ** argv )
     
     // parse command line arguments
     int n = 1;
+    GLboolean hop_set = FALSE;
     while( n < argc )
     {
         if( strncmp( argv[n], "--srate", 7 ) == 0 )
@@ -380,9 +411,72 @@ int main( int argc, char ** argv )
             do_ola = !!atoi( argv[n]+5 );
             fprintf( stderr, "rt_lpc: %sperforming ola...\n", do_ola ? "" : "NOT " );
         }
+        else if( strncmp( argv[n], "--win", 5 ) == 0 )
+        {
+            g_win_size = atoi( argv[n]+5 );
+            if( !hop_set ) g_hop_size = g_win_size / 4;
+        }
+        else if( strncmp( argv[n], "--hop", 5 ) == 0 )
+        {
+            g_hop_size = atoi( argv[n]+5 );
+            hop_set = TRUE;
+        }
+        else if( strncmp( argv[n], "--voices", 8 ) == 0 )
+        {
+            g_max_voices = atoi( argv[n]+8 );
+            if( g_max_voices <= 0 )
+            {
+                fprintf( stderr, "rt_lpc: invalid voices '%i'...\n", g_max_voices );
+                usage();
+                exit( 1 );
+            }
+        }
+        else if( strncmp( argv[n], "--track", 7 ) == 0 )
+        {
+            g_track = atoi( argv[n]+7 );
+            if( g_track < 0 || g_track > 2 )
+            {
+                fprintf( stderr, "rt_lpc: invalid tracking '%i'...\n", g_track );
+                usage();
+                exit( 1 );
+            }
+        }
+        else if( strncmp( argv[n], "--yin", 5 ) == 0 )
+            g_yin = !!atoi( argv[n]+5 );
+        else if( strncmp( argv[n], "--cross", 7 ) == 0 )
+        {
+            g_cross = TRUE;
+            if( argv[n][7] == ':' && argv[n][8] )
+                g_carrier_path = argv[n]+8;
+        }
+        else if( strncmp( argv[n], "--lsf", 5 ) == 0 )
+        {
+            g_lsf_hops = atoi( argv[n]+5 );
+            if( g_lsf_hops < 0 )
+            {
+                fprintf( stderr, "rt_lpc: invalid lsf rate '%i'...\n", g_lsf_hops );
+                usage();
+                exit( 1 );
+            }
+        }
 
         n++;
     }
+
+    // without overlap, a window at a time
+    if( !do_ola )
+        g_hop_size = g_win_size;
+    // the display's fft wants a power of 2; the overlap-add, whole hops
+    if( g_win_size < 64 || g_win_size > LPC_BUFFER_SIZE || ( g_win_size & (g_win_size-1) ) ||
+        g_hop_size <= 0 || g_win_size % g_hop_size || ( do_ola && g_hop_size > g_win_size / 2 ) )
+    {
+        fprintf( stderr, "rt_lpc: invalid window/hop '%i/%i'...\n", g_win_size, g_hop_size );
+        usage();
+        exit( 1 );
+    }
+    // cross-synthesis: a filter for every hop of the carrier
+    if( g_cross && !g_lsf_hops )
+        g_lsf_hops = 1;
     
     // do our own initialization
     initialize_graphics( );
@@ -413,30 +507,56 @@ int cb( void * outputBuffer, void * inputBuffer, unsigned int numFrames,
     int i;
     SAMPLE * inBuffy = (SAMPLE *)inputBuffer;
     SAMPLE * outBuffy = (SAMPLE *)outputBuffer;
-    // g_mutex.lock();
-    
-    // copy in and out
-    // memcpy( g_audio_buffer, buffer, buffer_size * sizeof(SAMPLE) );
-    // mix to mono
-    for( i = 0; i < numFrames; i++ )
-        g_audio_buffer[i] = ( inBuffy[i*2] + inBuffy[i*2+1] ) / 2;
 
-    // is this really bad? (yes)
-    if( do_ola )
+    // mix to mono (--cross, live: the voice is the left channel)
+    if( g_cross && !g_carrier )
+        for( i = 0; i < numFrames; i++ )
+            g_audio_buffer[i] = inBuffy[i*2];
+    else
+        for( i = 0; i < numFrames; i++ )
+            g_audio_buffer[i] = ( inBuffy[i*2] + inBuffy[i*2+1] ) / 2;
+
+    // in to the dsp thread; it keeps up, or this input is lost
+    unsigned long put = g_in_ring.put( g_audio_buffer, numFrames );
+    if( put < numFrames ) g_overruns++;
+
+    // the carrier, the right channel: as much of it (the rings in step)
+    if( g_cross && !g_carrier )
     {
-        assert( false );
-        if( g_q.size() > 16 ) { g_q.clear(); }
-        g_q.enqueue( (SAMPLE *)inBuffy );
+        for( i = 0; i < put; i++ )
+            g_audio_buffer[i] = inBuffy[i*2+1];
+        g_car_ring.put( g_audio_buffer, put );
     }
-    
-    // output
-    if( !g_ready ) // memcpy( buffer, g_another_buffer, buffer_size * sizeof(SAMPLE) );
-        for( i = 0; i < numFrames; i++ )
-            outBuffy[i*2] = outBuffy[i*2+1] = g_another_buffer[i];
-    else memset( outBuffy, 0, numFrames * 2 * sizeof(SAMPLE) );
 
-    g_ready = TRUE;
-    // g_mutex.unlock();
+    // 'k': play from the newest
+    if( g_flush )
+    {
+        long discarded = (long)g_out_ring.discard( g_out_ring.readable() );
+        g_io_offset -= discarded;
+        g_out_skew -= discarded;
+        g_flush = FALSE;
+    }
+
+    // out from it (silence, if it's late)
+    unsigned long got = g_out_ring.get( g_out_buffer, numFrames );
+    if( got < numFrames )
+    {
+        memset( g_out_buffer + got, 0, (numFrames - got) * sizeof(SAMPLE) );
+        g_underruns++;
+    }
+    g_io_offset += (long)put - (long)got;
+    g_out_skew += (long)numFrames - (long)got;
+
+    for( i = 0; i < numFrames; i++ )
+        outBuffy[i*2] = outBuffy[i*2+1] = g_out_buffer[i];
+
+    // the clock: this buffer starts playing about now
+    g_clock_seq++;
+    RingBuffer::fence();
+    g_clock_frames += numFrames;
+    g_clock_usec = now_usec();
+    RingBuffer::fence();
+    g_clock_seq++;
 
     return 0;
 }
@@ -450,10 +570,47 @@ int cb( void * outputBuffer, void * inputBuffer, unsigned int numFrames,
 //-----------------------------------------------------------------------------
 bool initialize_audio( )
 {
+    // --cross:<file>: the carrier (the dsp thread reads it), checked
+    // before anything is allocated (it isn't resampled: the stream's rate)
+    if( g_carrier_path )
+    {
+        memset( &g_carrier_info, 0, sizeof(SF_INFO) );
+        if( !( g_carrier = sf_open( g_carrier_path, SFM_READ, &g_carrier_info ) ) ||
+            g_carrier_info.channels <= 0 || g_carrier_info.frames <= 0 )
+        {
+            fprintf( stderr, "rt_lpc: cannot open carrier '%s'...\n", g_carrier_path );
+            if( g_carrier ) sf_close( g_carrier );
+            g_carrier = NULL;
+            return false;
+        }
+        if( g_carrier_info.samplerate != (int)g_srate )
+        {
+            fprintf( stderr, "rt_lpc: carrier '%s' is at %d Hz, not %d (try --srate%d)...\n",
+                     g_carrier_path, g_carrier_info.samplerate, g_srate,
+                     g_carrier_info.samplerate );
+            sf_close( g_carrier );
+            g_carrier = NULL;
+            return false;
+        }
+        g_carrier_scratch = new float[LPC_BUFFER_SIZE * g_carrier_info.channels];
+    }
+
     // set sample rate
     Stk::setSampleRate( g_srate );
-    // is this really bad? (yes)
-    if( do_ola ) g_buffer_size /= 2;
+    // the callback moves a hop at a time, the window is the analysis
+    // (and display) size
+    if( ( do_ola && !( g_ola = ola_create( g_win_size, g_hop_size ) ) ) ||
+        !g_in_ring.initialize( LPC_BUFFER_SIZE * 8, sizeof(SAMPLE) ) ||
+        !g_out_ring.initialize( LPC_BUFFER_SIZE * 8, sizeof(SAMPLE) ) ||
+        !g_frames.initialize( 2, sizeof(DspFrame) ) ||
+        !g_midi_ring.initialize( 1024, sizeof(MidiEvent) ) ||
+        ( g_cross && !g_car_ring.initialize( LPC_BUFFER_SIZE * 8, sizeof(SAMPLE) ) ) )
+    {
+        fprintf( stderr, "rt_lpc: cannot allocate the dsp engine...\n" );
+        return false;
+    }
+
+    g_buffer_size = g_hop_size;
 
     try
     {
@@ -492,7 +649,14 @@ bool initialize_audio( )
         
         // open a stream
         g_audio->openStream( &oParams, &iParams, RTAUDIO_FLOAT32, g_srate, &bufsize, &cb, (void *)&bufferBytes, &options );            
+        // (g_buffer_size is the window's once we're open)
+        g_device_buffer = bufsize;
         // test
+        if( bufsize > LPC_BUFFER_SIZE )
+        {
+            fprintf( stderr, "rt_lpc: audio buffer too large: %i\n", bufsize );
+            return false;
+        }
         if( bufsize != g_buffer_size )
         {
             // potential problem
@@ -507,6 +671,8 @@ bool initialize_audio( )
         
         // start the audio
         g_audio->startStream( );
+        // what the device adds to ours
+        g_device_latency = g_audio->getStreamLatency( );
     }
     catch( StkError & e )
     {
@@ -516,12 +682,8 @@ bool initialize_audio( )
         return false;
     }
 
-    // this is very bad
-    if( do_ola )
-    {
-        g_q.be( 32, g_buffer_size );
-        g_buffer_size *= 2;
-    }
+    // the rest of us see whole windows
+    g_buffer_size = g_win_size;
 
     // make the window
     make_window( g_window, g_buffer_size );
@@ -548,6 +710,435 @@ bool initialize_audio( )
 void initialize_analysis( )
 {
     g_lpc = lpc_create( );
+    if( g_yin )
+        g_pitch = yin_create( g_win_size );
+    g_voices = voices_create( g_max_voices, g_srate );
+
+    // the dsp engine runs from here, midi in on its own
+    if( !start_dsp( ) || !start_midi( ) )
+    {
+        fprintf( stderr, "rt_lpc: cannot start the dsp thread, exiting...\n" );
+        exit( 1 );
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// Name: now_usec( )
+// Desc: a clock for the stream clock (usec, from whenever)
+//-----------------------------------------------------------------------------
+double now_usec( )
+{
+#if !defined(__OS_WINDOWS__)
+    struct timeval tv;
+    gettimeofday( &tv, NULL );
+    return tv.tv_sec * 1000000.0 + tv.tv_usec;
+#else
+    LARGE_INTEGER freq, count;
+    QueryPerformanceFrequency( &freq );
+    QueryPerformanceCounter( &count );
+    return count.QuadPart * 1000000.0 / freq.QuadPart;
+#endif
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// Name: midi_thread( )
+// Desc: stamps each midi event with the stream frame it came in at
+//-----------------------------------------------------------------------------
+THREAD_RETURN THREAD_TYPE midi_thread( void * data )
+{
+    MidiEvent e;
+    unsigned long seq;
+    long frames;
+    double usec;
+
+    while( true )
+    {
+        // (MidiIn reads the device on its own thread, and only buffers)
+        if( !g_min || !g_min->recv( &e.msg ) )
+        {
+#if !defined(__OS_WINDOWS__)
+            usleep( 1000 );
+#else
+            Sleep( 1 );
+#endif
+            continue;
+        }
+
+        // the callback's last stamp (whole), and the time since
+        do {
+            seq = g_clock_seq;
+            RingBuffer::fence();
+            frames = g_clock_frames;
+            usec = g_clock_usec;
+            RingBuffer::fence();
+        } while( ( seq & 1 ) || seq != g_clock_seq );
+        e.frame = frames + (long)( ( now_usec() - usec ) * g_srate / 1000000.0 );
+
+        // ('m' off: nobody to play it)
+        if( g_midi && !g_midi_ring.put( &e, 1 ) )
+            g_midi_dropped++;
+    }
+
+    return 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// Name: start_midi( )
+// Desc: starts the midi thread (it waits for g_min)
+//-----------------------------------------------------------------------------
+bool start_midi( )
+{
+    // events come in during one callback (the device's buffer) and are
+    // played from the first hop after the next, all the same delay later
+    g_midi_delay = g_device_buffer + g_hop_size;
+    return g_midi_thread.start( (THREAD_FUNCTION)midi_thread, NULL );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// Name: midi_apply( )
+// Desc: (dsp thread) one event to the voices
+//-----------------------------------------------------------------------------
+void midi_apply( const MidiMsg & m )
+{
+    // note on (velocity 0: off), note off
+    if( (m.data[0] & 0xf0) == 0x90 )
+        voices_note_on( g_voices, m.data[1], m.data[2] );
+    else if( (m.data[0] & 0xf0) == 0x80 )
+        voices_note_off( g_voices, m.data[1] );
+    // pitch bend (an octave either way)
+    else if( (m.data[0] & 0xf0) == 0xe0 )
+        voices_bend( g_voices, pow( 1.0653f, ( m.data[1] / 128.0f + m.data[2] - 64 )
+                                             / 64.0f * 11.0f ) );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// Name: excite_voices( )
+// Desc: (dsp thread) the voices' excitation for a hop starting at stream
+//       frame 'start', each event due in it applied at its own sample
+//-----------------------------------------------------------------------------
+void excite_voices( SAMPLE * y, int len, int hop, long start, float power,
+                    const SAMPLE * glot, int glot_len )
+{
+    int at = 0;
+
+    while( g_midi_pending || ( g_midi_pending = g_midi_ring.get( &g_midi_next, 1 ) > 0 ) )
+    {
+        long offset = g_midi_next.frame + g_midi_delay - start;
+        // a later hop's
+        if( offset >= hop )
+            break;
+        // late: as soon as can be
+        if( offset < at )
+        {
+            if( offset < 0 ) g_midi_late++;
+            offset = at;
+        }
+        // up to it, then it
+        if( offset > at )
+        {
+            voices_excite( g_voices, y + at, offset - at, offset - at, power,
+                           1.0f / g_speed, glot, glot_len );
+            at = offset;
+        }
+        midi_apply( g_midi_next.msg );
+        g_midi_pending = FALSE;
+    }
+
+    // the rest of the hop, and (the voices not moving on) the frame
+    voices_excite( g_voices, y + at, len - at, hop - at, power,
+                   1.0f / g_speed, glot, glot_len );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// Name: dsp_process( )
+// Desc: (dsp thread) one hop in (and, --cross, one of carrier), one hop out
+//-----------------------------------------------------------------------------
+void dsp_process( const SAMPLE * in, const SAMPLE * car, SAMPLE * out )
+{
+    static DspFrame f;
+    // --lsf: the last two analyses, hops so far
+    static float lsf0[LPC_MAX_ORDER], lsf1[LPC_MAX_ORDER], power0 = 0, pitch0 = 0;
+    static int lsf_order = 0;
+    static unsigned long hops = 0;
+    // --cross: the carrier's gain at the end of the last hop
+    static float cross_gain = 0;
+    float from[LPC_MAX_ORDER], to[LPC_MAX_ORDER];
+    int order = g_order, i;
+
+    // the stream frame this hop starts playing at
+    long start = (long)g_out_ring.write_pos() + g_out_skew;
+
+    // ('m' off: they ring out, and what's queued is dropped)
+    if( !g_midi )
+    {
+        voices_all_off( g_voices );
+        g_midi_ring.discard( g_midi_ring.readable() );
+        g_midi_pending = FALSE;
+    }
+    // the glottal pulse, for the voices
+    int glot_len = 0;
+    const SAMPLE * glot = g_train ? NULL : lpc_glottal( g_lpc, &glot_len );
+
+    // the window this hop completes (without overlap, the hop is one)
+    const SAMPLE * window = do_ola ? ola_input( g_ola, in ) : in;
+    // --lsf: analysis only every so often
+    GLboolean analyze = !g_lsf_hops || hops % g_lsf_hops == 0;
+
+    // --track: the lags follow every hop, analyzed or not (one more than
+    // the analysis needs, for the pre-emphasis)
+    if( g_track )
+    {
+        if( !g_corr || lpc_corr_lags( g_corr ) != order + 2 )
+        {
+            // (a new order: the whole window again)
+            lpc_corr_destroy( g_corr );
+            g_corr = lpc_corr_create( g_win_size, order + 2,
+                                      g_track == 2 ? 1.0f - 2.0f / g_win_size : 0.0f );
+            // (NULL, for more lags than the window: per analysis, then)
+            if( g_corr ) lpc_corr_push( g_corr, window, g_win_size );
+        }
+        else
+            lpc_corr_push( g_corr, in, g_hop_size );
+    }
+
+    if( analyze )
+    {
+        // (the previous analysis is where the interpolation starts)
+        power0 = f.power;
+        pitch0 = f.pitch / g_speed;
+
+        memcpy( f.buffer, window, g_win_size * sizeof(SAMPLE) );
+        if( g_balance )
+            lpc_preemphasis( f.buffer, g_win_size, .5 );
+        if( g_corr )
+        {
+            float corr[LPC_MAX_ORDER+2], r[LPC_MAX_ORDER+2];
+            lpc_corr_get( g_corr, r, order + 2 );
+            // pre-emphasis (x[n] - .5 x[n-1]), in terms of the lags
+            for( int k = 0; k <= order; k++ )
+                corr[k] = g_balance ? 1.25f * r[k] - .5f * ( r[k ? k-1 : 1] + r[k+1] ) : r[k];
+            lpc_analyze_corr( g_lpc, f.buffer, g_win_size, corr, f.coefs, order,
+                              &f.power, g_pitch ? NULL : &f.pitch, f.residue, f.refl );
+        }
+        else
+            lpc_analyze( g_lpc, f.buffer, g_win_size, f.coefs, order, &f.power,
+                         g_pitch ? NULL : &f.pitch, f.residue, f.refl );
+        f.order = order;
+        // --yin: the pitch from the window as it came in
+        f.voicing = 0;
+        if( g_pitch )
+            f.pitch = yin_pitch( g_pitch, window, &f.voicing );
+    }
+
+    if( !g_lsf_hops )
+    {
+        // a frame the length of the window, continuous with the last hop
+        if( g_midi )
+        {
+            excite_voices( f.synth, g_win_size, g_hop_size, start, f.power,
+                           glot, glot_len );
+            lpc_filter_frame( g_lpc, f.synth, g_win_size, g_hop_size, f.refl, order );
+        }
+        else
+            lpc_synthesize_frame( g_lpc, f.synth, g_win_size, g_hop_size, f.refl, order,
+                                  f.power, f.pitch / g_speed, !g_train );
+        if( g_balance )
+            lpc_deemphasis( f.synth, g_win_size, .5 );
+
+        if( do_ola )
+            ola_output( g_ola, f.synth, out );
+        else
+            memcpy( out, f.synth, g_win_size * sizeof(SAMPLE) );
+    }
+    else
+    {
+        if( analyze )
+        {
+            // on to the next; where no lsfs are found, the filter holds
+            memcpy( lsf0, lsf1, order * sizeof(float) );
+            if( !lpc_to_lsf( f.coefs, order, lsf1 ) && lsf_order != order )
+                memset( lsf1, 0, order * sizeof(float) );
+            // (a new order starts from here)
+            if( lsf_order != order )
+            {
+                memcpy( lsf0, lsf1, order * sizeof(float) );
+                lsf_order = order;
+            }
+        }
+        // (between analyses, the order they were made at: a new one
+        // waits for the next)
+        order = lsf_order;
+
+        // this hop's stretch of the way; pitch glides between voiced
+        // frames, otherwise switches half way
+        float t0 = ( hops % g_lsf_hops ) / (float)g_lsf_hops;
+        float t1 = t0 + 1.0f / g_lsf_hops, pitch1 = f.pitch / g_speed, p0, p1;
+        if( pitch0 > 0 && pitch1 > 0 )
+        {
+            p0 = pitch0 + t0 * ( pitch1 - pitch0 );
+            p1 = pitch0 + t1 * ( pitch1 - pitch0 );
+        }
+        else
+            p0 = p1 = t0 + t1 < 1.0f ? pitch0 : pitch1;
+        lsf_interpolate( lsf0, lsf1, order, t0, from );
+        lsf_interpolate( lsf0, lsf1, order, t1, to );
+        if( car )
+        {
+            // the carrier, at the residue's level (the gain gliding there
+            // across the hop), through the filter
+            float sum = 0.0f, gain;
+            memcpy( out, car, g_hop_size * sizeof(SAMPLE) );
+            if( g_balance )
+                lpc_preemphasis( out, g_hop_size, .5 );
+            for( i = 0; i < g_hop_size; i++ )
+                sum += out[i] * out[i];
+            gain = sum > 1e-12f ? ( power0 + t1 * ( f.power - power0 ) ) *
+                   sqrtf( ( g_win_size - order ) / ( sum / g_hop_size ) ) : 0.0f;
+            for( i = 0; i < g_hop_size; i++ )
+                out[i] *= cross_gain + ( gain - cross_gain ) * ( i + 1 ) / g_hop_size;
+            cross_gain = gain;
+            lpc_filter_interp( g_lpc, out, g_hop_size, from, to, order );
+        }
+        else if( g_midi )
+        {
+            excite_voices( out, g_hop_size, g_hop_size, start,
+                           power0 + .5f * ( t0 + t1 ) * ( f.power - power0 ),
+                           glot, glot_len );
+            lpc_filter_interp( g_lpc, out, g_hop_size, from, to, order );
+        }
+        else
+            lpc_synthesize_interp( g_lpc, out, g_hop_size, from, to, order,
+                                   power0 + t0 * ( f.power - power0 ),
+                                   power0 + t1 * ( f.power - power0 ), p0, p1, !g_train );
+        if( g_balance )
+            lpc_deemphasis( out, g_hop_size, .5 );
+
+        // the display's synthesis window scrolls
+        memmove( f.synth, f.synth + g_hop_size, ( g_win_size - g_hop_size ) * sizeof(SAMPLE) );
+        memcpy( f.synth + g_win_size - g_hop_size, out, g_hop_size * sizeof(SAMPLE) );
+    }
+    hops++;
+    f.voices = voices_active( g_voices );
+
+    // for the display, unless it still has one
+    if( g_frames.writable() )
+        g_frames.put( &f, 1 );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// Name: read_carrier( )
+// Desc: (dsp thread) the next len samples of the carrier file, mono, looped
+//-----------------------------------------------------------------------------
+void read_carrier( SAMPLE * y, int len )
+{
+    int channels = g_carrier_info.channels, got = 0, i, c;
+    sf_count_t count;
+    GLboolean rewound = FALSE;
+
+    while( got < len )
+    {
+        count = sf_readf_float( g_carrier, g_carrier_scratch, len - got );
+        if( count <= 0 )
+        {
+            // (twice in a row: nothing to read)
+            if( rewound || sf_seek( g_carrier, 0, SEEK_SET ) < 0 ) break;
+            rewound = TRUE;
+            continue;
+        }
+        rewound = FALSE;
+
+        for( i = 0; i < count; i++, got++ )
+        {
+            y[got] = 0.0f;
+            for( c = 0; c < channels; c++ )
+                y[got] += g_carrier_scratch[i*channels+c];
+            y[got] /= channels;
+        }
+    }
+
+    if( got < len )
+        memset( y + got, 0, ( len - got ) * sizeof(SAMPLE) );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// Name: dsp_thread( )
+// Desc: analysis/resynthesis, whenever there's a hop in and room for one out
+//-----------------------------------------------------------------------------
+THREAD_RETURN THREAD_TYPE dsp_thread( void * data )
+{
+    SAMPLE in[LPC_BUFFER_SIZE], car[LPC_BUFFER_SIZE], out[LPC_BUFFER_SIZE];
+    // a quarter hop, in usec
+    long nap = (long)( g_hop_size * 250000.0 / g_srate );
+
+    while( true )
+    {
+        if( g_in_ring.readable() < g_hop_size || g_out_ring.writable() < g_hop_size ||
+            ( g_cross && !g_carrier && g_car_ring.readable() < g_hop_size ) )
+        {
+#if !defined(__OS_WINDOWS__)
+            usleep( nap > 0 ? nap : 1 );
+#else
+            Sleep( nap / 1000 > 0 ? nap / 1000 : 1 );
+#endif
+            continue;
+        }
+
+        g_in_ring.get( in, g_hop_size );
+        if( g_carrier )
+            read_carrier( car, g_hop_size );
+        else if( g_cross )
+            g_car_ring.get( car, g_hop_size );
+        dsp_process( in, g_cross ? car : NULL, out );
+
+        // input-to-output latency: the window's oldest hop is what this
+        // output hop finishes (--lsf: its newest); when it plays, against
+        // when that input came in (the callback's in/out offset relates
+        // the two)
+        float latency = (float)( (long)g_out_ring.write_pos() + g_io_offset -
+                                 (long)g_in_ring.read_pos() +
+                                 ( g_lsf_hops ? g_hop_size : g_win_size ) );
+        g_out_ring.put( out, g_hop_size );
+        g_latency = latency;
+        if( latency > g_latency_max ) g_latency_max = latency;
+    }
+
+    return 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// Name: start_dsp( )
+// Desc: starts the overlap-add engine
+//-----------------------------------------------------------------------------
+bool start_dsp( )
+{
+    return g_dsp_thread.start( (THREAD_FUNCTION)dsp_thread, NULL );
 }
 
 
@@ -681,8 +1272,8 @@ void keyboardFunc( unsigned char key, int x, int y )
         break;
     case 'p':
         g_order++;
-        if( g_order > 100 )
-            g_order = 100;
+        if( g_order > LPC_MAX_ORDER )
+            g_order = LPC_MAX_ORDER;
         //fprintf( stderr, "order: %i\n", g_order );
         break;
     case 'f':
@@ -726,14 +1317,16 @@ void keyboardFunc( unsigned char key, int x, int y )
         g_midi = !g_midi;
         if( !g_min )
         {
-            g_min = new MidiIn;
-            if( !g_min->open( 0 ) )
+            // the midi thread reads it: only once it's open
+            MidiIn * min = new MidiIn;
+            if( !min->open( 0 ) )
             {
                 fprintf( stderr, "cannot open MIDI input 0 (default)\n" );
-                delete g_min;
-                g_min = NULL;
+                delete min;
                 g_midi = FALSE;
             }
+            else
+                g_min = min;
         }
         fprintf( stderr, "%susing MIDI input as pitch\n", g_midi ? "" : "not " );
     break;
@@ -754,9 +1347,19 @@ void keyboardFunc( unsigned char key, int x, int y )
         fprintf( stderr, "%susing preemphasis/deemphasis filter\n", g_balance ? "" : "NOT " );
     break;
     case 'k':
-        g_q.clear();
+        g_flush = TRUE;
         fprintf( stderr, "rt_lpc: kaboom!\n" );
     break;
+    case 'l':
+        fprintf( stderr, "rt_lpc: latency %.1f ms (worst %.1f ms) + device %.1f ms; "
+                 "underruns %lu, overruns %lu\n", g_latency * 1000.0f / g_srate,
+                 g_latency_max * 1000.0f / g_srate, g_device_latency * 1000.0f / g_srate,
+                 g_underruns, g_overruns );
+        if( g_midi )
+            fprintf( stderr, "rt_lpc: midi %.1f ms behind; %lu events late, %lu dropped\n",
+                     g_midi_delay * 1000.0f / g_srate, g_midi_late, g_midi_dropped );
+        g_latency_max = 0;
+    break;
     }
 
     // do a reshape since g_eye_y might have changed
@@ -802,6 +1405,13 @@ void mouseFunc( int button, int state, int x, int y )
 //-----------------------------------------------------------------------------
 void idleFunc( )
 {
+    // draw each frame the dsp thread finishes
+    if( !g_frames.readable() )
+    {
+        usleep( 1000 );
+        return;
+    }
+
     // render the scene
     glutPostRedisplay( );
 }
@@ -840,13 +1450,11 @@ void displayFunc( )
     static long int count = 0;
     static char str[1024];
     static unsigned int wf = 0;
-    static SAMPLE buffer[LPC_BUFFER_SIZE], residue[LPC_BUFFER_SIZE],
-           coefs[1024], radii[1024];
-    static MidiMsg ananya, ge;
-    static int keys = 0;
-    static float bend = 0;
+    static SAMPLE buffer[LPC_BUFFER_SIZE], synth[LPC_BUFFER_SIZE],
+           residue[LPC_BUFFER_SIZE], coefs[LPC_MAX_ORDER], radii[LPC_MAX_ORDER];
+    static DspFrame f;
 
-    int i;
+    int i, order;
     float pitch, power, fval;
 
     // clear the color and depth buffers
@@ -860,96 +1468,20 @@ void displayFunc( )
         // color waveform
         glColor3f( 0.4f, 0.4f, 1.0f );
 
-        // wait for data
-        while( !g_ready )
-#if !defined(__OS_WINDOWS__)
-            usleep( 0 );
-#else
-            Sleep( 0 );
-#endif
-
-        // midi
-        while( g_midi && g_min && g_min->recv( &ge ) )
-        {
-            // note on
-            if( (ge.data[0] & 0xf0) == 0x90 )
-            {
-                if( ge.data[2] )
-                {
-                    keys++;
-                    memcpy( &ananya, &ge, sizeof(MidiMsg) );
-                }
-                else
-                {
-                    keys--;
-                    if( keys <= 0 ) memcpy( &ananya, &ge, sizeof(MidiMsg) );
-                }
-            }
-            // pitch bend
-            else if( (ge.data[0] & 0xf0) == 0xe0 )
-                bend = ge.data[1] / 128.0f + ge.data[2] - 64;
-        }
-        
-        // this is egregious
-        if( do_ola )
-        {
-        while( 0 == g_q.size() )
-#ifndef __OS_WINDOWS__
-            usleep( 50 );
-#else
-            Sleep( 0 );
-#endif
-
-            // get the window
-            memcpy( buffer, g_buffest+g_buffer_size/2, g_buffer_size/2*sizeof(SAMPLE) );
-            g_q.dequeue( buffer+g_buffer_size/2 );
-            memcpy( g_buffest+g_buffer_size/2, buffer+g_buffer_size/2, g_buffer_size/2*sizeof(SAMPLE) );
-            memset( g_another_buffer, 0, g_buffer_size * sizeof(SAMPLE) );
-
-            if( g_balance )
-                lpc_preemphasis(buffer, g_buffer_size, 0.5); // No
-            lpc_analyze( g_lpc, buffer, g_buffer_size, coefs, g_order, &power, &pitch, residue );
-            if( g_midi ) {
-                pitch = (int)( Stk::sampleRate() / midi2pitch[ananya.data[1]] ) /
-                        pow( 1.0653f, bend/64.0f*11.0f );
-                power *= ananya.data[2] / 64.0f;
-            }
-            lpc_synthesize( g_lpc, g_another_buffer, g_buffer_size, coefs, g_order, power, pitch / g_speed, !g_train );
-            if( g_balance )
-			    lpc_deemphasis(g_another_buffer, g_buffer_size, 0.5); // Go away
-
-            // ugly code
-            for( i = 0; i < g_buffer_size/2; i++ )
-            {
-                 g_another_buffer[i] = g_another_buffer[i] * g_window[i] + g_buffest[i] * (g_window[i + g_buffer_size/2]);
-                 g_buffest[i] = g_another_buffer[i+g_buffer_size/2];
-            }
-        }
-        else
+        // the dsp thread's newest frame (or the last one again); the
+        // drawing below works on copies
+        if( g_frames.readable() )
         {
-            // g_mutex.lock();
-            // get the window
-            memcpy( buffer, g_audio_buffer, g_buffer_size * sizeof(SAMPLE) );
-            memset( g_another_buffer, 0, g_buffer_size * sizeof(SAMPLE) );
-            // g_mutex.unlock();
-
-            if( g_balance )
-                lpc_preemphasis( buffer, g_buffer_size, .5 );
-            lpc_analyze( g_lpc, buffer, g_buffer_size, coefs, g_order, &power, &pitch, residue );
-            //for( i = 0; i < g_order; i++ )
-            //    fprintf( stderr, "%f ", coefs[i] );
-            //fprintf( stderr, "\n" );
-            if( g_midi ) {
-                pitch = (int)( Stk::sampleRate() / midi2pitch[ananya.data[1]] ) /
-                        pow( 1.0653f, bend/64.0f*11.0f );
-                power *= ananya.data[2] / 64.0f;
-            }
-            lpc_synthesize( g_lpc, g_another_buffer, g_buffer_size, coefs, g_order, power, pitch / g_speed, !g_train );
-            //for( i = 0; i < g_buffer_size; i++ )
-            //    g_another_buffer[i] = buffer[i] - residue[i];
-            if( g_balance )
-                lpc_deemphasis( g_another_buffer, g_buffer_size, .5 );
+            g_frames.discard( g_frames.readable() - 1 );
+            g_frames.get( &f, 1 );
         }
+        memcpy( buffer, f.buffer, g_buffer_size * sizeof(SAMPLE) );
+        memcpy( synth, f.synth, g_buffer_size * sizeof(SAMPLE) );
+        memcpy( residue, f.residue, g_buffer_size * sizeof(SAMPLE) );
+        memcpy( coefs, f.coefs, sizeof(coefs) );
+        order = f.order;
+        power = f.power;
+        pitch = f.pitch;
 
         /*
         // set the impulse
@@ -996,22 +1528,23 @@ void displayFunc( )
         
         if( g_usedb ) glLineWidth( 1 );
 
-        if( g_draw_vocal )
+        // (nothing analyzed yet: no tract)
+        if( g_draw_vocal && order > 0 )
         {
-            // vocal tract model
-            real_peel( coefs, g_order, radii );
+            // vocal tract model, at the frame's own order
+            real_peel( coefs, order, radii );
             // draw it
             glColor3f( 1.0f, 0.4f, 0.4f );
             if( g_which == 0 )
-                lintube( radii, g_order );
+                lintube( radii, order );
             else if( g_which == 1 )
-                sectube( radii, g_order );
+                sectube( radii, order );
             else if( g_which == 2 )
             {
                 // lighting
                 glEnable( GL_LIGHTING );
                 gluQuadricDrawStyle( g_quad, GLU_FILL );
-                moretube( radii, g_order );
+                moretube( radii, order );
                 // lighting
                 glDisable( GL_LIGHTING );
             }
@@ -1020,13 +1553,12 @@ void displayFunc( )
                 // lighting
                 // glEnable( GL_LIGHTING );
                 gluQuadricDrawStyle( g_quad, GLU_SILHOUETTE );
-                moretube( radii, g_order );
+                moretube( radii, order );
                 // lighting
                 // glDisable( GL_LIGHTING );
             }
             glColor3f( 0.4f, 0.4f, 1.0f );
         }
-        g_ready = FALSE;
 
         // apply the window
         x = -1.8f, inc = 3.6f / g_buffer_size, y = 1.0f;
@@ -1051,7 +1583,7 @@ void displayFunc( )
         glBegin( GL_LINE_STRIP );
         for( i = ii; i < ii + g_buffer_size / g_time_view; i++ )
         {
-            glVertex3f( x, g_gain * g_time_scale * 1.5f * (g_another_buffer[i]) + y, 0.0f );
+            glVertex3f( x, g_gain * g_time_scale * 1.5f * (synth[i]) + y, 0.0f );
             x += inc * g_time_view;
         }
         glEnd();
@@ -1135,6 +1667,14 @@ void displayFunc( )
         draw_string( 1.2f, -.25f, 0.0f, str, .35f );
         sprintf( str, "LPC order: %i", g_order );
         draw_string( 1.2f, -.35f, 0.0f, str, .35f );
+        sprintf( str, "latency: %.1f ms (+%.1f)", g_latency * 1000.0f / g_srate,
+                 g_device_latency * 1000.0f / g_srate );
+        draw_string( 1.2f, -.15f, 0.0f, str, .35f );
+        if( g_midi )
+        {
+            sprintf( str, "voices: %i/%i", f.voices, g_max_voices );
+            draw_string( 1.2f, -.05f, 0.0f, str, .35f );
+        }
 
 
         SAMPLE sum = 0.0f;
@@ -1160,11 +1700,14 @@ void displayFunc( )
     glDisable( GL_LIGHTING );
 
         draw_string( 1.2f, -.55f, 0.0f, "non-pitch | pitched", .35f );
+        if( g_pitch )
+        {
+            sprintf( str, "voicing: %.2f", f.voicing );
+            draw_string( 1.2f, -.65f, 0.0f, str, .35f );
+        }
         
     glPopMatrix( );
 
-    g_ready = FALSE;
-
     // swap the buffers
     glFlush( );
     glutSwapBuffers( );
@@ -1200,7 +1743,7 @@ void down_sample_4( float * data, int size )
             k++;
         }
         g_filt_coef[FILT_CENTER] = 1.0;
-        g_ready = TRUE;
+        g_filt_ready = TRUE;
     }
 
     for( i = 0; i < size; i++ )
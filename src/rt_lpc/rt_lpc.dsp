@@ -113,6 +113,26 @@ SOURCE=.\Stk.cpp
 
 SOURCE=.\Thread.cpp
 # End Source File
+# Begin Source File
+
+SOURCE=.\ola.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\ringbuffer.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\voices.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\util_sndfile.c
+# End Source File
+# Begin Source File
+
+SOURCE=.\yin.cpp
+# End Source File
 # End Group
 # Begin Group "Header Files"
 
@@ -141,6 +161,26 @@ SOURCE=.\Stk.h
 
 SOURCE=.\Thread.h
 # End Source File
+# Begin Source File
+
+SOURCE=.\ola.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\ringbuffer.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\voices.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\util_sndfile.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\yin.h
+# End Source File
 # End Group
 # Begin Group "Resource Files"
 
@@ -0,0 +1,276 @@
+//-----------------------------------------------------------------------------
+// name: voices.cpp
+// desc: polyphonic excitation for lpc resynthesis
+//-----------------------------------------------------------------------------
+#include "voices.h"
+#include <stdlib.h>
+#include <memory.h>
+#include <math.h>
+#include <limits.h>
+
+
+// attack and release, seconds
+#define VOICE_RAMP      .005f
+
+
+// internal data structure: one array per field, one entry per voice
+struct voice_pool_
+{
+    int max_voices;
+    float srate;
+    float ramp;
+    float bend;
+    unsigned long clock;
+    // the note, its period (samples) and velocity gain
+    int * note;
+    float * period;
+    float * gain;
+    // samples to the next pulse, samples since the last
+    float * count;
+    int * since;
+    // envelope, and where it's going (1: held, 0: released)
+    float * env;
+    float * target;
+    // when last started or released (for stealing)
+    unsigned long * stamp;
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: voices_create()
+// desc: ...
+//-----------------------------------------------------------------------------
+voice_pool voices_create( int max_voices, float srate )
+{
+    if( max_voices <= 0 || srate <= 0 )
+        return NULL;
+
+    voice_pool pool = new voice_pool_;
+    int n = max_voices;
+    pool->max_voices = n;
+    pool->srate = srate;
+    pool->ramp = 1.0f / ( VOICE_RAMP * srate );
+    pool->bend = 1.0f;
+    pool->clock = 0;
+    pool->note = new int[n];
+    pool->period = new float[n];
+    pool->gain = new float[n];
+    pool->count = new float[n];
+    pool->since = new int[n];
+    pool->env = new float[n];
+    pool->target = new float[n];
+    pool->stamp = new unsigned long[n];
+
+    memset( pool->note, 0, n * sizeof(int) );
+    memset( pool->period, 0, n * sizeof(float) );
+    memset( pool->gain, 0, n * sizeof(float) );
+    memset( pool->count, 0, n * sizeof(float) );
+    memset( pool->since, 0, n * sizeof(int) );
+    memset( pool->env, 0, n * sizeof(float) );
+    memset( pool->target, 0, n * sizeof(float) );
+    memset( pool->stamp, 0, n * sizeof(unsigned long) );
+
+    return pool;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: voices_destroy()
+// desc: ...
+//-----------------------------------------------------------------------------
+void voices_destroy( voice_pool & pool )
+{
+    if( pool )
+    {
+        delete [] pool->note;
+        delete [] pool->period;
+        delete [] pool->gain;
+        delete [] pool->count;
+        delete [] pool->since;
+        delete [] pool->env;
+        delete [] pool->target;
+        delete [] pool->stamp;
+        delete pool;
+        pool = NULL;
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: voices_note_on()
+// desc: a free voice, else the longest released, else the oldest held
+//-----------------------------------------------------------------------------
+void voices_note_on( voice_pool pool, int note, int velocity )
+{
+    int v, pick = -1;
+
+    if( velocity <= 0 )
+    {
+        voices_note_off( pool, note );
+        return;
+    }
+
+    // free
+    for( v = 0; v < pool->max_voices && pick < 0; v++ )
+        if( pool->env[v] == 0.0f && pool->target[v] == 0.0f )
+            pick = v;
+    // released longest ago
+    if( pick < 0 )
+        for( v = 0; v < pool->max_voices; v++ )
+            if( pool->target[v] == 0.0f && ( pick < 0 || pool->stamp[v] < pool->stamp[pick] ) )
+                pick = v;
+    // held longest
+    if( pick < 0 )
+    {
+        pick = 0;
+        for( v = 1; v < pool->max_voices; v++ )
+            if( pool->stamp[v] < pool->stamp[pick] )
+                pick = v;
+    }
+
+    pool->note[pick] = note;
+    pool->period[pick] = pool->srate / ( 440.0f * powf( 2.0f, ( note - 69 ) / 12.0f ) );
+    pool->gain[pick] = velocity / 64.0f;
+    pool->count[pick] = 0.0f;
+    pool->since[pick] = 0;
+    pool->target[pick] = 1.0f;
+    pool->stamp[pick] = ++pool->clock;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: voices_note_off()
+// desc: ...
+//-----------------------------------------------------------------------------
+void voices_note_off( voice_pool pool, int note )
+{
+    for( int v = 0; v < pool->max_voices; v++ )
+        if( pool->note[v] == note && pool->target[v] > 0.0f )
+        {
+            pool->target[v] = 0.0f;
+            pool->stamp[v] = ++pool->clock;
+        }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: voices_all_off()
+// desc: ...
+//-----------------------------------------------------------------------------
+void voices_all_off( voice_pool pool )
+{
+    for( int v = 0; v < pool->max_voices; v++ )
+        if( pool->target[v] > 0.0f )
+        {
+            pool->target[v] = 0.0f;
+            pool->stamp[v] = ++pool->clock;
+        }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: voices_bend()
+// desc: ...
+//-----------------------------------------------------------------------------
+void voices_bend( voice_pool pool, float ratio )
+{
+    if( ratio > 0.0f )
+        pool->bend = ratio;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: voices_active()
+// desc: ...
+//-----------------------------------------------------------------------------
+int voices_active( voice_pool pool )
+{
+    int n = 0;
+    for( int v = 0; v < pool->max_voices; v++ )
+        n += pool->env[v] > 0.0f || pool->target[v] > 0.0f;
+
+    return n;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: voices_excite()
+// desc: each sounding voice adds its pulses (at lpc_synthesize()'s
+//       amplitude, power * period) under its envelope
+//-----------------------------------------------------------------------------
+void voices_excite( voice_pool pool, SAMPLE * y, int len, int hop, float power,
+                    float period_scale, const SAMPLE * alt, int alt_len )
+{
+    float ramp = pool->ramp;
+    int v, i;
+
+    memset( y, 0, len * sizeof(SAMPLE) );
+
+    for( v = 0; v < pool->max_voices; v++ )
+    {
+        float target = pool->target[v], env = pool->env[v];
+        if( env == 0.0f && target == 0.0f )
+            continue;
+
+        float period = pool->period[v] * period_scale / pool->bend;
+        if( period < 1.0f ) period = 1.0f;
+        float amp = power * period * pool->gain[v];
+        float count = pool->count[v];
+        int since = pool->since[v];
+
+        for( i = 0; i < len; i++ )
+        {
+            // (where the next frame starts from)
+            if( i == hop )
+            {
+                pool->count[v] = count;
+                pool->since[v] = since;
+                pool->env[v] = env;
+            }
+
+            if( env < target ) { env += ramp; if( env > target ) env = target; }
+            else if( env > target ) { env -= ramp; if( env < target ) env = target; }
+
+            count -= 1.0f;
+            if( count <= 0.0f )
+            {
+                count += period;
+                since = 0;
+            }
+
+            // pulses, or the glottal pulse (read at a quarter rate)
+            if( alt )
+            {
+                if( since * 4 < alt_len )
+                    y[i] += env * amp * alt[since*4] / (float)SHRT_MAX;
+            }
+            else if( since == 0 )
+                y[i] += env * amp;
+
+            if( since < INT_MAX ) since++;
+        }
+
+        if( hop >= len )
+        {
+            pool->count[v] = count;
+            pool->since[v] = since;
+            pool->env[v] = env;
+        }
+    }
+}
@@ -0,0 +1,52 @@
+//-----------------------------------------------------------------------------
+// name: voices.h
+// desc: polyphonic excitation for lpc resynthesis
+//
+//       each midi note gets a voice: its own pulse train (or glottal
+//       pulses) at its own pitch, velocity and envelope.  all voices
+//       share the one analysis frame, so the filter is the same for all
+//       of them: their excitations are summed and filtered once, which
+//       (the filter being linear) is exactly what filtering each on its
+//       own and summing would give.  a chord costs its pulses, plus one
+//       filter.
+//
+//       voice state is kept as one array per field, for all voices.  with
+//       every voice busy, a new note takes the longest-released voice, or
+//       failing that the oldest one held, picking up from its envelope
+//       where it is (no click).
+//-----------------------------------------------------------------------------
+#ifndef __VOICES_H__
+#define __VOICES_H__
+
+#ifndef SAMPLE
+#define SAMPLE float
+#endif
+
+
+// forward reference
+typedef struct voice_pool_ * voice_pool;
+
+
+// init: up to max_voices at once
+voice_pool voices_create( int max_voices, float srate );
+// notes (velocity 0 is note off)
+void voices_note_on( voice_pool pool, int note, int velocity );
+void voices_note_off( voice_pool pool, int note );
+// everything into release
+void voices_all_off( voice_pool pool );
+// pitch bend, as a frequency ratio
+void voices_bend( voice_pool pool, float ratio );
+// voices sounding (held or releasing)
+int voices_active( voice_pool pool );
+// the summed excitation, len samples, the voices moving on by only hop of
+// them; power as lpc_analyze() gives it, period_scale stretches every
+// period; glottal pulses from alt (4x, see lpc_glottal()), if not NULL
+void voices_excite( voice_pool pool, SAMPLE * y, int len, int hop, float power,
+                    float period_scale, const SAMPLE * alt, int alt_len );
+// done
+void voices_destroy( voice_pool & pool );
+
+
+
+
+#endif
@@ -0,0 +1,166 @@
+//-----------------------------------------------------------------------------
+// name: yin.cpp
+// desc: yin pitch tracking
+//-----------------------------------------------------------------------------
+#include "yin.h"
+#include "chuck_fft.h"
+#include <memory.h>
+
+
+// shortest period looked at (samples)
+#define YIN_MIN_LAG     2
+
+// internal data structure
+struct yin_data_
+{
+    int len;
+    // lags (and the length of the stretch compared at each)
+    int lags;
+    float threshold;
+    // spectra: the window, its first half (zero padded)
+    float * whole;
+    float * half;
+    // running sum of squares (len + 1)
+    double * energy;
+    // normalized difference, per lag
+    float * diff;
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: yin_create()
+// desc: ...
+//-----------------------------------------------------------------------------
+yin_data yin_create( int len, float threshold )
+{
+    // (the fft wants a power of 2)
+    if( len < 4 * YIN_MIN_LAG || ( len & ( len - 1 ) ) )
+        return NULL;
+
+    yin_data yin = new yin_data_;
+    yin->len = len;
+    yin->lags = len / 2;
+    yin->threshold = threshold;
+    yin->whole = new float[len];
+    yin->half = new float[len];
+    yin->energy = new double[len+1];
+    yin->diff = new float[yin->lags];
+
+    // (the fft sets up its tables the first time: here, not mid-stream)
+    memset( yin->whole, 0, len * sizeof(float) );
+    rfft( yin->whole, len / 2, FFT_FORWARD );
+
+    return yin;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: yin_destroy()
+// desc: ...
+//-----------------------------------------------------------------------------
+void yin_destroy( yin_data & yin )
+{
+    if( yin )
+    {
+        delete [] yin->whole;
+        delete [] yin->half;
+        delete [] yin->energy;
+        delete [] yin->diff;
+        delete yin;
+        yin = NULL;
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: yin_pitch()
+// desc: ...
+//-----------------------------------------------------------------------------
+float yin_pitch( yin_data yin, const SAMPLE * x, float * confidence )
+{
+    int len = yin->len, w = yin->lags, i, t;
+    float * a = yin->half, * b = yin->whole, * d = yin->diff;
+    double * e = yin->energy;
+
+    // energies: of any stretch, from the running sum
+    e[0] = 0.0;
+    for( i = 0; i < len; i++ )
+        e[i+1] = e[i] + (double)x[i] * x[i];
+
+    // products of the first half with every stretch (no stretch reaches
+    // past len, so the circular correlation doesn't wrap)
+    memcpy( b, x, len * sizeof(float) );
+    memcpy( a, x, w * sizeof(float) );
+    memset( a + w, 0, ( len - w ) * sizeof(float) );
+    rfft( b, len / 2, FFT_FORWARD );
+    rfft( a, len / 2, FFT_FORWARD );
+    // conj(a) * b (dc and nyquist are real, packed in the first pair)
+    b[0] *= a[0];
+    b[1] *= a[1];
+    for( i = 2; i < len; i += 2 )
+    {
+        float re = a[i] * b[i] + a[i+1] * b[i+1];
+        float im = a[i] * b[i+1] - a[i+1] * b[i];
+        b[i] = re;
+        b[i+1] = im;
+    }
+    rfft( b, len / 2, FFT_INVERSE );
+
+    // difference, normalized by its mean over the lags up to here
+    double sum = 0.0;
+    d[0] = 1.0f;
+    for( t = 1; t < w; t++ )
+    {
+        // (the forward transform scales by 1/len; twice, undone once)
+        double diff = ( e[w] - e[0] ) + ( e[t+w] - e[t] ) - 2.0 * len * b[t];
+        if( diff < 0.0 ) diff = 0.0;
+        sum += diff;
+        d[t] = sum > 0.0 ? (float)( diff * t / sum ) : 1.0f;
+    }
+
+    // the first dip under the threshold, down to its bottom
+    for( t = YIN_MIN_LAG; t < w; t++ )
+        if( d[t] < yin->threshold )
+        {
+            while( t + 1 < w && d[t+1] < d[t] )
+                t++;
+            break;
+        }
+
+    // none: unvoiced (how close the best came, for the confidence)
+    if( t >= w )
+    {
+        if( confidence )
+        {
+            float least = 1.0f;
+            for( t = YIN_MIN_LAG; t < w; t++ )
+                if( d[t] < least ) least = d[t];
+            *confidence = 1.0f - least;
+        }
+        return 0.0f;
+    }
+
+    // the parabola through it and its neighbors: where it bottoms out
+    float period = (float)t, depth = d[t];
+    if( t + 1 < w )
+    {
+        float curve = d[t-1] - 2.0f * d[t] + d[t+1];
+        if( curve > 0.0f )
+        {
+            float shift = .5f * ( d[t-1] - d[t+1] ) / curve;
+            period += shift;
+            depth -= .25f * ( d[t-1] - d[t+1] ) * shift;
+        }
+    }
+
+    if( confidence )
+        *confidence = depth < 0.0f ? 1.0f : depth > 1.0f ? 0.0f : 1.0f - depth;
+
+    return period;
+}
@@ -0,0 +1,44 @@
+//-----------------------------------------------------------------------------
+// name: yin.h
+// desc: yin pitch tracking (de cheveigne and kawahara)
+//
+//       the squared difference of a window against itself, at each lag,
+//       is divided by its own running mean (so short lags aren't favored
+//       just for being short); the period is the first lag where that
+//       dips under a threshold, refined between its neighbors to a
+//       fraction of a sample.  no dip, no pitch: unvoiced.  how deep the
+//       dip goes is the confidence.
+//
+//       the difference at lag t is the energy of the first half of the
+//       window, plus that of the half starting at t, less twice their
+//       product: the energies are running sums, the products one fft
+//       correlation, all in buffers made once.  a window costs n log n,
+//       not n * n / 4.
+//-----------------------------------------------------------------------------
+#ifndef __YIN_H__
+#define __YIN_H__
+
+#include <stdlib.h>
+
+#ifndef SAMPLE
+#define SAMPLE float
+#endif
+
+
+// forward reference
+typedef struct yin_data_ * yin_data;
+
+
+// init: windows of len samples (a power of 2), periods below len/2;
+// threshold on the normalized difference (lower: stricter voicing)
+yin_data yin_create( int len, float threshold = .15f );
+// the period of the window, in samples (0: unvoiced); how sure, 0 to 1,
+// in confidence if not NULL (unvoiced: how near its best lag came)
+float yin_pitch( yin_data yin, const SAMPLE * x, float * confidence = NULL );
+// done
+void yin_destroy( yin_data & yin );
+
+
+
+
+#endif
@@ -0,0 +1,319 @@
+//-----------------------------------------------------------------------------
+// name: feature_writer.cpp
+// desc: binary, columnar feature output (--print:bin, --featfile), and
+//       reading it back (--replay)
+//-----------------------------------------------------------------------------
+#include "feature_writer.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <memory.h>
+#include <stddef.h>
+
+// stdout is text mode by default
+#if defined(__WINDOWS_DS__) || defined(__WINDOWS_ASIO__)
+  #include <io.h>
+  #include <fcntl.h>
+#endif
+
+
+
+
+// records are collected and written in blocks of this size (at least one)
+#define FEAT_BUFFER_SIZE    ( 1 << 20 )
+
+// internal data structures
+struct feature_writer_
+{
+    FILE * fp;
+    bool is_stdout;
+    feature_header header;
+    // buffered records
+    unsigned char * buffer;
+    size_t buffer_size;
+    size_t used;
+    // ok so far
+    bool ok;
+};
+
+struct feature_reader_
+{
+    FILE * fp;
+    feature_header header;
+    // the rest of the header page, and where each column's name is in it
+    char * names;
+    const char ** columns;
+    // one record
+    unsigned char * record;
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: feature_writer_open()
+// desc: ...
+//-----------------------------------------------------------------------------
+feature_writer feature_writer_open( const char * path, int columns,
+                                    const char * const * names, int channels,
+                                    int srate, int win_size, int fft_size )
+{
+    int i;
+
+    if( columns <= 0 || channels <= 0 )
+        return NULL;
+
+    // names must fit in the header
+    size_t len = sizeof(feature_header);
+    for( i = 0; i < columns; i++ )
+        len += strlen( names[i] ) + 1;
+    if( len > FEAT_HEADER_SIZE )
+    {
+        fprintf( stderr, "[sndpeek]: error: too many feature columns...\n" );
+        return NULL;
+    }
+
+    feature_writer w = new feature_writer_;
+    memset( w, 0, sizeof(feature_writer_) );
+    w->is_stdout = !strcmp( path, "-" );
+    w->fp = w->is_stdout ? stdout : fopen( path, "wb" );
+    if( !w->fp )
+    {
+        delete w;
+        return NULL;
+    }
+#if defined(__WINDOWS_DS__) || defined(__WINDOWS_ASIO__)
+    if( w->is_stdout ) _setmode( _fileno( stdout ), _O_BINARY );
+#endif
+
+    // float64 time, then the columns, 8-byte aligned
+    feature_header & h = w->header;
+    memcpy( h.magic, FEAT_MAGIC, 8 );
+    h.version = FEAT_VERSION;
+    h.header_size = FEAT_HEADER_SIZE;
+    h.record_size = ( sizeof(double) + columns * sizeof(float) + 7 ) & ~7;
+    h.columns = columns;
+    h.channels = channels;
+    h.srate = srate;
+    h.win_size = win_size;
+    h.fft_size = fft_size;
+    h.records = 0;
+
+    // header page
+    unsigned char * page = new unsigned char[FEAT_HEADER_SIZE];
+    memset( page, 0, FEAT_HEADER_SIZE );
+    memcpy( page, &h, sizeof(h) );
+    char * p = (char *)page + sizeof(h);
+    for( i = 0; i < columns; i++ )
+    {
+        strcpy( p, names[i] );
+        p += strlen( names[i] ) + 1;
+    }
+    w->ok = fwrite( page, 1, FEAT_HEADER_SIZE, w->fp ) == FEAT_HEADER_SIZE;
+    delete [] page;
+
+    // the buffer holds whole records
+    w->buffer_size = FEAT_BUFFER_SIZE - FEAT_BUFFER_SIZE % h.record_size;
+    if( w->buffer_size < h.record_size ) w->buffer_size = h.record_size;
+    w->buffer = new unsigned char[w->buffer_size];
+
+    return w;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: feature_writer_write()
+// desc: ...
+//-----------------------------------------------------------------------------
+bool feature_writer_write( feature_writer w, double time, const float * values )
+{
+    size_t size = w->header.record_size;
+
+    if( w->used + size > w->buffer_size && !feature_writer_flush( w ) )
+        return false;
+
+    unsigned char * r = w->buffer + w->used;
+    memcpy( r, &time, sizeof(double) );
+    memcpy( r + sizeof(double), values, w->header.columns * sizeof(float) );
+    memset( r + sizeof(double) + w->header.columns * sizeof(float), 0,
+            size - sizeof(double) - w->header.columns * sizeof(float) );
+    w->used += size;
+    w->header.records++;
+
+    return true;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: feature_writer_flush()
+// desc: ...
+//-----------------------------------------------------------------------------
+bool feature_writer_flush( feature_writer w )
+{
+    if( w->used && w->ok )
+        w->ok = fwrite( w->buffer, 1, w->used, w->fp ) == w->used;
+    w->used = 0;
+    if( w->ok ) fflush( w->fp );
+
+    return w->ok;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: feature_writer_close()
+// desc: ...
+//-----------------------------------------------------------------------------
+void feature_writer_close( feature_writer & w )
+{
+    if( !w ) return;
+
+    feature_writer_flush( w );
+
+    if( !w->is_stdout )
+    {
+        // now the count is known
+        if( w->ok && !fseek( w->fp, offsetof( feature_header, records ), SEEK_SET ) )
+            fwrite( &w->header.records, sizeof(w->header.records), 1, w->fp );
+        fclose( w->fp );
+    }
+
+    if( !w->ok )
+        fprintf( stderr, "[sndpeek]: error: feature output incomplete...\n" );
+
+    delete [] w->buffer;
+    delete w;
+    w = NULL;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: read_names()
+// desc: the rest of the header page: the column names, one after another
+//       (zero filled past them)
+//-----------------------------------------------------------------------------
+static bool read_names( feature_reader r )
+{
+    const feature_header & h = r->header;
+    unsigned int len = h.header_size - sizeof(h);
+
+    r->names = new char[len + 1];
+    r->columns = new const char *[h.columns];
+    if( fread( r->names, 1, len, r->fp ) != len )
+        return false;
+    r->names[len] = '\0';
+
+    char * p = r->names, * end = r->names + len;
+    for( unsigned int i = 0; i < h.columns; i++ )
+    {
+        if( p >= end )
+            return false;
+        r->columns[i] = p;
+        p += strlen( p ) + 1;
+    }
+
+    return true;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: feature_reader_open()
+// desc: ...
+//-----------------------------------------------------------------------------
+feature_reader feature_reader_open( const char * path )
+{
+    FILE * fp = fopen( path, "rb" );
+    if( !fp )
+        return NULL;
+
+    feature_reader r = new feature_reader_;
+    r->fp = fp;
+    r->names = NULL;
+    r->columns = NULL;
+    r->record = NULL;
+    feature_header & h = r->header;
+
+    // ours, and a layout that makes sense
+    if( fread( &h, sizeof(h), 1, fp ) != 1 || memcmp( h.magic, FEAT_MAGIC, 8 ) ||
+        h.version != FEAT_VERSION || h.header_size <= sizeof(h) || !h.columns ||
+        !h.channels || h.record_size < sizeof(double) + h.columns * sizeof(float) ||
+        !read_names( r ) )
+    {
+        fprintf( stderr, "[sndpeek]: error: '%s' is not a feature file...\n", path );
+        feature_reader_close( r );
+        return NULL;
+    }
+    r->record = new unsigned char[h.record_size];
+
+    return r;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: feature_reader_header()
+// desc: ...
+//-----------------------------------------------------------------------------
+const feature_header * feature_reader_header( feature_reader r )
+{
+    return &r->header;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: feature_reader_column()
+// desc: ...
+//-----------------------------------------------------------------------------
+const char * feature_reader_column( feature_reader r, int column )
+{
+    return r->columns[column];
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: feature_reader_read()
+// desc: ...
+//-----------------------------------------------------------------------------
+bool feature_reader_read( feature_reader r, double & time, float * values )
+{
+    if( fread( r->record, r->header.record_size, 1, r->fp ) != 1 )
+        return false;
+
+    memcpy( &time, r->record, sizeof(double) );
+    memcpy( values, r->record + sizeof(double), r->header.columns * sizeof(float) );
+
+    return true;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: feature_reader_close()
+// desc: ...
+//-----------------------------------------------------------------------------
+void feature_reader_close( feature_reader & r )
+{
+    if( !r ) return;
+
+    fclose( r->fp );
+    delete [] r->names;
+    delete [] r->columns;
+    delete [] r->record;
+    delete r;
+    r = NULL;
+}
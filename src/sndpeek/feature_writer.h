@@ -0,0 +1,72 @@
+//-----------------------------------------------------------------------------
+// name: feature_writer.h
+// desc: binary, columnar feature output (--print:bin, --featfile), and
+//       reading it back (--replay)
+//
+//       layout (all little-endian on the usual hosts, i.e. native):
+//         header   FEAT_HEADER_SIZE bytes (one page): feature_header, then
+//                  the column names, each NUL terminated
+//         records  one per analysis frame (and channel, channels
+//                  interleaved): a float64 time in seconds (start of the
+//                  window) followed by 'columns' float32 values, padded
+//                  to record_size
+//       records start on a page boundary, so a file can be mapped and
+//       viewed directly as an array of records; 'records' is filled in
+//       when a file is closed (it stays 0 when writing to a pipe).
+//-----------------------------------------------------------------------------
+#ifndef __FEATURE_WRITER_H__
+#define __FEATURE_WRITER_H__
+
+#define FEAT_MAGIC          "SPKFEAT1"
+#define FEAT_VERSION        1
+#define FEAT_HEADER_SIZE    4096
+
+// on-disk header
+struct feature_header
+{
+    char magic[8];
+    unsigned int version;
+    unsigned int header_size;
+    unsigned int record_size;
+    unsigned int columns;
+    unsigned int channels;
+    unsigned int srate;
+    unsigned int win_size;
+    unsigned int fft_size;
+    unsigned long long records;
+};
+
+// forward reference
+typedef struct feature_writer_ * feature_writer;
+
+
+// start writing to 'path' ("-" is stdout); the header goes out here
+feature_writer feature_writer_open( const char * path, int columns,
+                                    const char * const * names, int channels,
+                                    int srate, int win_size, int fft_size );
+// append one record (values has 'columns' entries)
+bool feature_writer_write( feature_writer writer, double time, const float * values );
+// flush what's buffered
+bool feature_writer_flush( feature_writer writer );
+// flush, fill in the record count (files only) and close
+void feature_writer_close( feature_writer & writer );
+
+
+// forward reference
+typedef struct feature_reader_ * feature_reader;
+
+// open a feature file for reading, the header is checked here
+feature_reader feature_reader_open( const char * path );
+// its header
+const feature_header * feature_reader_header( feature_reader reader );
+// the name of column 0 .. columns-1
+const char * feature_reader_column( feature_reader reader, int column );
+// the next record (values gets 'columns' entries); false at the end
+bool feature_reader_read( feature_reader reader, double & time, float * values );
+// done
+void feature_reader_close( feature_reader & reader );
+
+
+
+
+#endif
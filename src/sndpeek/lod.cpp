@@ -0,0 +1,68 @@
+//-----------------------------------------------------------------------------
+// name: lod.cpp
+// desc: level of detail for drawing long curves into few pixels
+//-----------------------------------------------------------------------------
+#include "lod.h"
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: lod_minmax()
+// desc: ...
+//-----------------------------------------------------------------------------
+int lod_minmax( const float * xs, const float * ys, int n, int columns,
+                float * out_x, float * out_y )
+{
+    int i, m = 0;
+
+    if( n <= 0 )
+        return 0;
+
+    float x0 = xs ? xs[0] : 0.0f;
+    float x1 = xs ? xs[n-1] : (float)(n-1);
+
+    // nothing to gain: copy
+    if( columns <= 0 || n <= 2 * columns || x1 <= x0 )
+    {
+        for( i = 0; i < n; i++ )
+        {
+            out_x[i] = xs ? xs[i] : (float)i;
+            out_y[i] = ys[i];
+        }
+        return n;
+    }
+
+    // column of a point (the last x lands in the last column)
+    float scale = ( columns - .001f ) / ( x1 - x0 );
+    #define LOD_COLUMN(k) (int)( ( ( xs ? xs[k] : (float)(k) ) - x0 ) * scale )
+
+    i = 0;
+    while( i < n )
+    {
+        int col = LOD_COLUMN(i);
+        int lo = i, hi = i;
+
+        // gather the rest of this column
+        for( i++; i < n && LOD_COLUMN(i) == col; i++ )
+        {
+            if( ys[i] < ys[lo] ) lo = i;
+            if( ys[i] > ys[hi] ) hi = i;
+        }
+
+        // emit extremes in original order
+        int a = lo < hi ? lo : hi;
+        int b = lo < hi ? hi : lo;
+        out_x[m] = xs ? xs[a] : (float)a;
+        out_y[m++] = ys[a];
+        if( b != a )
+        {
+            out_x[m] = xs ? xs[b] : (float)b;
+            out_y[m++] = ys[b];
+        }
+    }
+
+    #undef LOD_COLUMN
+
+    return m;
+}
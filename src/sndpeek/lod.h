@@ -0,0 +1,26 @@
+//-----------------------------------------------------------------------------
+// name: lod.h
+// desc: level of detail for drawing long curves into few pixels
+//
+//       a curve with many more points than the pixel columns it covers is
+//       reduced to the min and max of each column, in their original
+//       order, so peaks survive and the line looks the same on screen.
+//-----------------------------------------------------------------------------
+#ifndef __LOD_H__
+#define __LOD_H__
+
+
+
+
+// reduce (xs[i], ys[i]) to a min/max envelope per column
+// xs must be non-decreasing; if xs is NULL, x is the index i
+// columns are spread evenly between the first and last x
+// output holds at most 2 * columns points (and never more than n)
+// returns the number of points written to out_x / out_y
+int lod_minmax( const float * xs, const float * ys, int n, int columns,
+                float * out_x, float * out_y );
+
+
+
+
+#endif
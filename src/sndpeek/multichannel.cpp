@@ -0,0 +1,244 @@
+//-----------------------------------------------------------------------------
+// name: multichannel.cpp
+// desc: per-channel STFT and spectral features for N-channel input
+//-----------------------------------------------------------------------------
+#include "multichannel.h"
+#include "chuck_fft.h"
+#include <stdlib.h>
+#include <memory.h>
+#include <math.h>
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: MultiAnalyzer()
+// desc: ...
+//-----------------------------------------------------------------------------
+MultiAnalyzer::MultiAnalyzer()
+{
+    m_channels = m_win_size = m_fft_size = m_bins = m_feat_bins = 0;
+    m_window = m_fft = m_mag = NULL;
+    m_norm = m_prev_norm = m_cum = NULL;
+    m_centroid = m_flux = m_rms = m_rolloff = m_rolloff2 = m_acc = NULL;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ~MultiAnalyzer()
+// desc: ...
+//-----------------------------------------------------------------------------
+MultiAnalyzer::~MultiAnalyzer()
+{
+    this->cleanup();
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: initialize()
+// desc: ...
+//-----------------------------------------------------------------------------
+bool MultiAnalyzer::initialize( int channels, int win_size, int fft_size,
+                                const float * window )
+{
+    this->cleanup();
+
+    if( channels < 1 || win_size < 4 || fft_size < win_size )
+        return false;
+
+    m_channels = channels;
+    m_win_size = win_size;
+    m_fft_size = fft_size;
+    m_bins = fft_size / 2;
+    m_feat_bins = win_size / 2;
+
+    m_window = new float[win_size];
+    memcpy( m_window, window, win_size * sizeof(float) );
+    m_fft = new float[fft_size];
+    m_mag = new float[m_bins * channels];
+    m_norm = new float[m_feat_bins * channels];
+    m_prev_norm = new float[m_feat_bins * channels];
+    m_cum = new float[m_feat_bins * channels];
+    m_centroid = new float[channels];
+    m_flux = new float[channels];
+    m_rms = new float[channels];
+    m_rolloff = new float[channels];
+    m_rolloff2 = new float[channels];
+    m_acc = new float[channels * 3];
+
+    memset( m_mag, 0, m_bins * channels * sizeof(float) );
+    memset( m_norm, 0, m_feat_bins * channels * sizeof(float) );
+    memset( m_prev_norm, 0, m_feat_bins * channels * sizeof(float) );
+
+    return true;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: cleanup()
+// desc: ...
+//-----------------------------------------------------------------------------
+void MultiAnalyzer::cleanup()
+{
+    delete [] m_window; delete [] m_fft; delete [] m_mag;
+    delete [] m_norm; delete [] m_prev_norm; delete [] m_cum;
+    delete [] m_centroid; delete [] m_flux; delete [] m_rms;
+    delete [] m_rolloff; delete [] m_rolloff2; delete [] m_acc;
+
+    m_window = m_fft = m_mag = NULL;
+    m_norm = m_prev_norm = m_cum = NULL;
+    m_centroid = m_flux = m_rms = m_rolloff = m_rolloff2 = m_acc = NULL;
+    m_channels = m_win_size = m_fft_size = m_bins = m_feat_bins = 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: analyze()
+// desc: ...
+//-----------------------------------------------------------------------------
+void MultiAnalyzer::analyze( const float * interleaved )
+{
+    int C = m_channels, i, k, c;
+
+    for( c = 0; c < C; c++ )
+    {
+        // de-interleave and window one channel, zero padded
+        for( i = 0; i < m_win_size; i++ )
+            m_fft[i] = interleaved[i * C + c] * m_window[i];
+        memset( m_fft + m_win_size, 0, ( m_fft_size - m_win_size ) * sizeof(float) );
+
+        // forward fft, fft_size/2 complex values
+        rfft( m_fft, m_fft_size / 2, FFT_FORWARD );
+        complex * cbuf = (complex *)m_fft;
+
+        // magnitudes back into the channel's lane
+        for( k = 0; k < m_bins; k++ )
+            m_mag[k * C + c] = cmp_abs( cbuf[k] );
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: features()
+// desc: ...
+//-----------------------------------------------------------------------------
+void MultiAnalyzer::features( float rolloff_a, float rolloff_b )
+{
+    int C = m_channels, N = m_feat_bins, k, c;
+    // zero padding interpolates: every ratio-th bin is the window's spectrum
+    int ratio = m_fft_size / m_win_size;
+    float * m0 = m_acc, * m1 = m_acc + C, * e = m_acc + 2 * C;
+    const float * x;
+    float * cum, * norm, * prev;
+
+    memset( m_acc, 0, C * 3 * sizeof(float) );
+    memset( m_flux, 0, C * sizeof(float) );
+
+    // moments, energy and running sum
+    for( k = 0; k < N; k++ )
+    {
+        x = m_mag + k * ratio * C;
+        cum = m_cum + k * C;
+        for( c = 0; c < C; c++ )
+        {
+            m0[c] += x[c];
+            m1[c] += k * x[c];
+            e[c] += x[c] * x[c];
+            cum[c] = m0[c];
+        }
+    }
+
+    for( c = 0; c < C; c++ )
+    {
+        // centroid (perfectly balanced if silent)
+        m_centroid[c] = m0[c] != 0 ? m1[c] / m0[c] : N / 2;
+        // rms
+        m_rms[c] = sqrt( e[c] / N );
+        // from here on e is the norm, for flux
+        e[c] = sqrt( e[c] );
+        // rolloff: last bin (> 1) still below the fraction, else the top
+        m_rolloff[c] = m_rolloff2[c] = -1;
+        m0[c] = rolloff_a * m_cum[( N - 1 ) * C + c];
+        m1[c] = rolloff_b * m_cum[( N - 1 ) * C + c];
+    }
+
+    for( k = 0; k < N; k++ )
+    {
+        x = m_mag + k * ratio * C;
+        norm = m_norm + k * C;
+        prev = m_prev_norm + k * C;
+        cum = m_cum + k * C;
+        for( c = 0; c < C; c++ )
+        {
+            // normalized spectrum; bins that are zero keep their old value
+            if( e[c] != 0 && x[c] > 0 )
+                norm[c] = x[c] / e[c];
+            m_flux[c] += ( norm[c] - prev[c] ) * ( norm[c] - prev[c] );
+            prev[c] = norm[c];
+
+            if( k > 1 && cum[c] < m0[c] ) m_rolloff[c] = (float)k;
+            if( k > 1 && cum[c] < m1[c] ) m_rolloff2[c] = (float)k;
+        }
+    }
+
+    for( c = 0; c < C; c++ )
+    {
+        // same scaling as marsyas Flux
+        m_flux[c] *= 1000.0f;
+        if( m_rolloff[c] < 0 ) m_rolloff[c] = (float)( N - 1 );
+        if( m_rolloff2[c] < 0 ) m_rolloff2[c] = (float)( N - 1 );
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: get_spectrum()
+// desc: ...
+//-----------------------------------------------------------------------------
+void MultiAnalyzer::get_spectrum( int c, float * out ) const
+{
+    int C = m_channels, k, j;
+
+    if( c >= 0 && c < C )
+    {
+        for( k = 0; k < m_bins; k++ )
+            out[k] = m_mag[k * C + c];
+    }
+    else
+    {
+        for( k = 0; k < m_bins; k++ )
+        {
+            float sum = 0;
+            for( j = 0; j < C; j++ )
+                sum += m_mag[k * C + j];
+            out[k] = sum / C;
+        }
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: get_feature_spectrum()
+// desc: ...
+//-----------------------------------------------------------------------------
+void MultiAnalyzer::get_feature_spectrum( int c, float * out ) const
+{
+    int ratio = m_fft_size / m_win_size;
+
+    for( int k = 0; k < m_feat_bins; k++ )
+        out[k] = m_mag[k * ratio * m_channels + c];
+}
@@ -0,0 +1,86 @@
+//-----------------------------------------------------------------------------
+// name: multichannel.h
+// desc: per-channel STFT and spectral features for N-channel input
+//
+//       spectra are kept bin-major with the channels interleaved, i.e.
+//       mag[bin * channels + c], so every per-bin step of the features
+//       is an inner loop across channels that the compiler can vectorize.
+//       the features follow the marsyas modules sndpeek uses in the
+//       single channel case (Centroid, Flux, RMS, Rolloff), computed on
+//       the window's own spectrum (every fft/win-th bin).
+//-----------------------------------------------------------------------------
+#ifndef __MULTICHANNEL_H__
+#define __MULTICHANNEL_H__
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: class MultiAnalyzer
+// desc: ...
+//-----------------------------------------------------------------------------
+class MultiAnalyzer
+{
+public:
+    MultiAnalyzer();
+    ~MultiAnalyzer();
+
+public:
+    // window is win_size long; fft_size >= win_size, both powers of two
+    bool initialize( int channels, int win_size, int fft_size, const float * window );
+    void cleanup();
+
+public:
+    // interleaved frames [win_size * channels] -> magnitude spectra
+    void analyze( const float * interleaved );
+    // centroid, flux, rms and two rolloffs for every channel
+    void features( float rolloff_a, float rolloff_b );
+
+public:
+    int channels() const { return m_channels; }
+    // bins of the (zero-padded) spectrum: fft_size / 2
+    int bins() const { return m_bins; }
+    // bins the features look at: win_size / 2
+    int feature_bins() const { return m_feat_bins; }
+    // mag()[k * channels() + c]
+    const float * mag() const { return m_mag; }
+    // one channel's spectrum (c >= 0) or the mean over channels (c < 0)
+    void get_spectrum( int c, float * out ) const;
+    // one channel's feature input (feature_bins() long)
+    void get_feature_spectrum( int c, float * out ) const;
+
+public: // per channel, after features()
+    const float * centroid() const { return m_centroid; }
+    const float * flux() const { return m_flux; }
+    const float * rms() const { return m_rms; }
+    const float * rolloff() const { return m_rolloff; }
+    const float * rolloff2() const { return m_rolloff2; }
+
+protected:
+    int m_channels;
+    int m_win_size;
+    int m_fft_size;
+    int m_bins;
+    int m_feat_bins;
+    float * m_window;
+    // one channel, zero padded, for the fft
+    float * m_fft;
+    // [bins * channels]
+    float * m_mag;
+    // feature scratch [feat_bins * channels]
+    float * m_norm;
+    float * m_prev_norm;
+    float * m_cum;
+    // [channels] each
+    float * m_centroid;
+    float * m_flux;
+    float * m_rms;
+    float * m_rolloff;
+    float * m_rolloff2;
+    float * m_acc;
+};
+
+
+
+
+#endif
@@ -0,0 +1,291 @@
+//-----------------------------------------------------------------------------
+// name: pcm_stream.cpp
+// desc: PCM audio from a pipe (e.g. stdin), for sndpeek --stdin
+//-----------------------------------------------------------------------------
+#include "pcm_stream.h"
+#include <stdlib.h>
+#include <string.h>
+#include <memory.h>
+
+// stdin is text mode by default
+#if defined(__WINDOWS_DS__) || defined(__WINDOWS_ASIO__)
+  #include <io.h>
+  #include <fcntl.h>
+#endif
+
+
+
+
+// sample encodings (WAV may bring more than the raw formats)
+enum { PCM_S16 = 0, PCM_S24, PCM_S32, PCM_F32 };
+
+// internal data structure
+struct pcm_stream_
+{
+    FILE * fp;
+    int srate;
+    int channels;
+    int encoding;
+    // bytes per sample
+    int width;
+    // one block of raw bytes
+    unsigned char * block;
+    long block_size;
+    // bytes left in the WAV data chunk (-1: until the stream ends)
+    long long remaining;
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: pcm_le16() / pcm_le32()
+// desc: little-endian integers from bytes (any host)
+//-----------------------------------------------------------------------------
+static inline unsigned int pcm_le16( const unsigned char * p )
+{
+    return p[0] | ( p[1] << 8 );
+}
+
+static inline unsigned int pcm_le32( const unsigned char * p )
+{
+    return p[0] | ( p[1] << 8 ) | ( p[2] << 16 ) | ( (unsigned int)p[3] << 24 );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: pcm_skip()
+// desc: read past n bytes (no seeking on a pipe)
+//-----------------------------------------------------------------------------
+static bool pcm_skip( FILE * fp, unsigned long n )
+{
+    unsigned char scratch[4096];
+
+    while( n > 0 )
+    {
+        size_t len = n < sizeof(scratch) ? n : sizeof(scratch);
+        if( fread( scratch, 1, len, fp ) != len )
+            return false;
+        n -= len;
+    }
+
+    return true;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: pcm_read_wav_header()
+// desc: RIFF/WAVE chunks up to the start of the sample data
+//-----------------------------------------------------------------------------
+static bool pcm_read_wav_header( pcm_stream_ * s )
+{
+    unsigned char h[40];
+    bool have_fmt = false;
+
+    if( fread( h, 1, 12, s->fp ) != 12 || memcmp( h, "RIFF", 4 ) || memcmp( h + 8, "WAVE", 4 ) )
+    {
+        fprintf( stderr, "[sndpeek]: error: stdin is not a WAV stream...\n" );
+        return false;
+    }
+
+    while( fread( h, 1, 8, s->fp ) == 8 )
+    {
+        unsigned long size = pcm_le32( h + 4 );
+
+        if( !memcmp( h, "fmt ", 4 ) )
+        {
+            unsigned long len = size < sizeof(h) ? size : sizeof(h);
+            if( size < 16 || fread( h, 1, len, s->fp ) != len ||
+                !pcm_skip( s->fp, size - len + ( size & 1 ) ) )
+                break;
+
+            unsigned int tag = pcm_le16( h );
+            s->channels = pcm_le16( h + 2 );
+            s->srate = pcm_le32( h + 4 );
+            unsigned int bits = pcm_le16( h + 14 );
+            // WAVE_FORMAT_EXTENSIBLE: the tag starts the sub-format GUID
+            if( tag == 0xFFFE && len >= 26 )
+                tag = pcm_le16( h + 24 );
+
+            if( tag == 1 && bits == 16 ) s->encoding = PCM_S16;
+            else if( tag == 1 && bits == 24 ) s->encoding = PCM_S24;
+            else if( tag == 1 && bits == 32 ) s->encoding = PCM_S32;
+            else if( tag == 3 && bits == 32 ) s->encoding = PCM_F32;
+            else
+            {
+                fprintf( stderr, "[sndpeek]: error: unsupported WAV encoding (tag %u, %u bits)...\n",
+                         tag, bits );
+                return false;
+            }
+            s->width = bits / 8;
+            have_fmt = true;
+        }
+        else if( !memcmp( h, "data", 4 ) )
+        {
+            if( !have_fmt ) break;
+            // writers that stream don't know the size yet
+            s->remaining = ( size == 0 || size == 0xFFFFFFFF ) ? -1 : (long long)size;
+            return true;
+        }
+        else if( !pcm_skip( s->fp, size + ( size & 1 ) ) )
+            break;
+    }
+
+    fprintf( stderr, "[sndpeek]: error: WAV stream ended before its data...\n" );
+    return false;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: pcm_stream_format()
+// desc: ...
+//-----------------------------------------------------------------------------
+int pcm_stream_format( const char * name )
+{
+    size_t len = strcspn( name, ":" );
+
+    if( len == 3 && !strncmp( name, "f32", 3 ) ) return PCM_FORMAT_F32;
+    if( len == 3 && !strncmp( name, "s16", 3 ) ) return PCM_FORMAT_S16;
+    if( len == 3 && !strncmp( name, "wav", 3 ) ) return PCM_FORMAT_WAV;
+
+    return -1;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: pcm_stream_open()
+// desc: ...
+//-----------------------------------------------------------------------------
+pcm_stream pcm_stream_open( FILE * fp, int format, int srate, int channels )
+{
+    pcm_stream_ * s = new pcm_stream_;
+    memset( s, 0, sizeof(pcm_stream_) );
+    s->fp = fp;
+    s->srate = srate;
+    s->channels = channels;
+    s->remaining = -1;
+
+#if defined(__WINDOWS_DS__) || defined(__WINDOWS_ASIO__)
+    _setmode( _fileno( fp ), _O_BINARY );
+#endif
+
+    if( format == PCM_FORMAT_F32 ) { s->encoding = PCM_F32; s->width = 4; }
+    else if( format == PCM_FORMAT_S16 ) { s->encoding = PCM_S16; s->width = 2; }
+    else if( format != PCM_FORMAT_WAV || !pcm_read_wav_header( s ) )
+    {
+        delete s;
+        return NULL;
+    }
+
+    if( s->channels < 1 || s->srate < 1 )
+    {
+        fprintf( stderr, "[sndpeek]: error: stream has %d channels at %d Hz...\n",
+                 s->channels, s->srate );
+        delete s;
+        return NULL;
+    }
+
+    return s;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: pcm_stream_srate() / pcm_stream_channels()
+// desc: ...
+//-----------------------------------------------------------------------------
+int pcm_stream_srate( pcm_stream stream )
+{
+    return stream->srate;
+}
+
+int pcm_stream_channels( pcm_stream stream )
+{
+    return stream->channels;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: pcm_stream_read()
+// desc: ...
+//-----------------------------------------------------------------------------
+long pcm_stream_read( pcm_stream stream, float * out, long frames )
+{
+    pcm_stream_ * s = stream;
+    long frame_bytes = (long)s->width * s->channels;
+    long need = frames * frame_bytes;
+    long i, n;
+
+    // no further than the data chunk
+    if( s->remaining >= 0 && need > s->remaining )
+        need = (long)( s->remaining - s->remaining % frame_bytes );
+    if( need <= 0 )
+        return 0;
+
+    // one block, kept for the next read
+    if( need > s->block_size )
+    {
+        delete [] s->block;
+        s->block = new unsigned char[need];
+        s->block_size = need;
+    }
+
+    // fread waits until the block is full or the stream ends
+    frames = (long)fread( s->block, 1, need, s->fp ) / frame_bytes;
+    if( s->remaining >= 0 )
+        s->remaining -= frames * frame_bytes;
+
+    n = frames * s->channels;
+    const unsigned char * p = s->block;
+    switch( s->encoding )
+    {
+    case PCM_S16:
+        for( i = 0; i < n; i++, p += 2 )
+            out[i] = (short)pcm_le16( p ) / 32768.0f;
+        break;
+    case PCM_S24:
+        for( i = 0; i < n; i++, p += 3 )
+            out[i] = (int)( ( p[0] << 8 ) | ( p[1] << 16 ) | ( (unsigned int)p[2] << 24 ) ) / 2147483648.0f;
+        break;
+    case PCM_S32:
+        for( i = 0; i < n; i++, p += 4 )
+            out[i] = (int)pcm_le32( p ) / 2147483648.0f;
+        break;
+    case PCM_F32:
+        for( i = 0; i < n; i++, p += 4 )
+        {
+            unsigned int bits = pcm_le32( p );
+            memcpy( out + i, &bits, 4 );
+        }
+        break;
+    }
+
+    return frames;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: pcm_stream_close()
+// desc: ...
+//-----------------------------------------------------------------------------
+void pcm_stream_close( pcm_stream & stream )
+{
+    if( !stream ) return;
+
+    delete [] stream->block;
+    delete stream;
+    stream = NULL;
+}
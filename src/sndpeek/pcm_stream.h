@@ -0,0 +1,39 @@
+//-----------------------------------------------------------------------------
+// name: pcm_stream.h
+// desc: PCM audio from a pipe (e.g. stdin), for sndpeek --stdin
+//
+//       raw interleaved little-endian float32 / int16 with the rate and
+//       channels given by the caller, or a WAV stream that describes
+//       itself.  everything is read front to back in whole blocks (a pipe
+//       can't seek), and the only buffer is one block of raw bytes.
+//-----------------------------------------------------------------------------
+#ifndef __PCM_STREAM_H__
+#define __PCM_STREAM_H__
+
+#include <stdio.h>
+
+// forward reference
+typedef struct pcm_stream_ * pcm_stream;
+
+// stream formats
+enum { PCM_FORMAT_F32 = 0, PCM_FORMAT_S16, PCM_FORMAT_WAV };
+
+
+// "f32", "s16" or "wav" (anything after a ':' is ignored), -1 if unknown
+int pcm_stream_format( const char * name );
+// start reading from 'fp'; srate/channels are used for the raw formats,
+// a WAV stream's header is read (and checked) here
+pcm_stream pcm_stream_open( FILE * fp, int format, int srate, int channels );
+// sample rate and channels of the stream
+int pcm_stream_srate( pcm_stream stream );
+int pcm_stream_channels( pcm_stream stream );
+// read up to 'frames' interleaved frames as float, waiting for them to
+// arrive; fewer only at the end of the stream (0 after it)
+long pcm_stream_read( pcm_stream stream, float * out, long frames );
+// done (does not close the FILE)
+void pcm_stream_close( pcm_stream & stream );
+
+
+
+
+#endif
@@ -0,0 +1,409 @@
+//-----------------------------------------------------------------------------
+// name: recorder.cpp
+// desc: session recorder (--record)
+//-----------------------------------------------------------------------------
+#include "recorder.h"
+#include "ringbuffer.h"
+#include "feature_writer.h"
+#include "Thread.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <memory.h>
+
+#if defined(__OS_WINDOWS__)
+  #include <windows.h>
+  #define usleep(x) Sleep( (x/1000 <= 0 ? 1 : x/1000) )
+#else
+  #include <unistd.h>
+#endif
+
+
+
+
+// the wav header is padded (with a JUNK chunk) to this, so the samples
+// start on a page boundary
+#define REC_HEADER_SIZE     4096
+// audio goes to disk in blocks of about this size: whole frames, and
+// whole pages (a multiple of 4096 frames)
+#define REC_BLOCK_SIZE      ( 1 << 18 )
+// the rings hold this long a disk stall
+#define REC_RING_SECONDS    4
+#define REC_RING_RECORDS    8192
+// writer thread naps this long when there's nothing to do (usec)
+#define REC_IDLE_USEC       5000
+
+// internal data structure
+struct recorder_
+{
+    // audio
+    FILE * wav;
+    int srate;
+    int channels;
+    RingBuffer audio;
+    unsigned char * block;
+    unsigned long block_size;
+    unsigned long block_used;
+    unsigned long long data_bytes;
+    // features
+    feature_writer feat;
+    int columns;
+    RingBuffer records;
+    unsigned char * record;
+    // drops (written by the producers only)
+    volatile unsigned long dropped_frames;
+    volatile unsigned long dropped_records;
+    // writer thread (only once it runs: ~Thread() cancels)
+    Thread * thread;
+    volatile bool stop;
+    volatile bool done;
+    bool ok;
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: put_le()
+// desc: little-endian fields for the wav header, on any host
+//-----------------------------------------------------------------------------
+static unsigned char * put_le( unsigned char * p, unsigned long value, int bytes )
+{
+    for( int i = 0; i < bytes; i++ )
+        *p++ = (unsigned char)( value >> ( 8 * i ) );
+    return p;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: wav_header()
+// desc: float32 wav header, padded to REC_HEADER_SIZE
+//-----------------------------------------------------------------------------
+static bool wav_header( FILE * fp, int srate, int channels, unsigned long long data_bytes )
+{
+    unsigned char header[REC_HEADER_SIZE];
+    unsigned char * p = header;
+    // riff sizes are 32 bits
+    unsigned long data = data_bytes > 0xffffffffULL - REC_HEADER_SIZE ?
+        0xffffffffUL - REC_HEADER_SIZE : (unsigned long)data_bytes;
+
+    memset( header, 0, sizeof(header) );
+    memcpy( p, "RIFF", 4 ); p = put_le( p + 4, data + REC_HEADER_SIZE - 8, 4 );
+    memcpy( p, "WAVE", 4 ); p += 4;
+    // format: ieee float
+    memcpy( p, "fmt ", 4 ); p = put_le( p + 4, 16, 4 );
+    p = put_le( p, 3, 2 );
+    p = put_le( p, channels, 2 );
+    p = put_le( p, srate, 4 );
+    p = put_le( p, srate * channels * 4, 4 );
+    p = put_le( p, channels * 4, 2 );
+    p = put_le( p, 32, 2 );
+    // padding
+    memcpy( p, "JUNK", 4 ); p = put_le( p + 4, REC_HEADER_SIZE - ( p - header ) - 16, 4 );
+    p = header + REC_HEADER_SIZE - 8;
+    memcpy( p, "data", 4 ); put_le( p + 4, data, 4 );
+
+    return !fseek( fp, 0, SEEK_SET ) &&
+        fwrite( header, 1, REC_HEADER_SIZE, fp ) == REC_HEADER_SIZE;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: aligned_block()
+// desc: page-aligned buffer
+//-----------------------------------------------------------------------------
+static unsigned char * aligned_block( unsigned long size )
+{
+    void * p = NULL;
+#if defined(_MSC_VER)
+    p = _aligned_malloc( size, 4096 );
+#else
+    if( posix_memalign( &p, 4096, size ) )
+        p = NULL;
+#endif
+    return (unsigned char *)p;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: write_block()
+// desc: (writer thread) the audio block, whole or (at the end) what's in it
+//-----------------------------------------------------------------------------
+static void write_block( recorder r )
+{
+    // samples are little-endian on disk
+    unsigned short one = 1;
+    if( !*(unsigned char *)&one )
+    {
+        unsigned char * p = r->block, t;
+        for( unsigned long i = 0; i < r->block_used; i += 4, p += 4 )
+        {
+            t = p[0]; p[0] = p[3]; p[3] = t;
+            t = p[1]; p[1] = p[2]; p[2] = t;
+        }
+    }
+
+    if( r->ok && fwrite( r->block, 1, r->block_used, r->wav ) != r->block_used )
+        r->ok = false;
+    r->data_bytes += r->block_used;
+    r->block_used = 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: drain()
+// desc: (writer thread) moves what's in the rings to disk; how much it did
+//-----------------------------------------------------------------------------
+static unsigned long drain( recorder r )
+{
+    unsigned long frame_bytes = r->channels * sizeof(float), n, total = 0;
+
+    // audio: fill the block, write it when full
+    while( ( n = r->audio.get( r->block + r->block_used,
+                               ( r->block_size - r->block_used ) / frame_bytes ) ) )
+    {
+        r->block_used += n * frame_bytes;
+        total += n;
+        if( r->block_used == r->block_size )
+            write_block( r );
+    }
+
+    // features (buffered by the feature writer)
+    while( r->records.get( r->record, 1 ) )
+    {
+        double time;
+        memcpy( &time, r->record, sizeof(double) );
+        if( !feature_writer_write( r->feat, time, (float *)( r->record + sizeof(double) ) ) )
+            r->ok = false;
+        total++;
+    }
+
+    return total;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: writer_thread()
+// desc: drains the rings until asked to stop, then once more
+//-----------------------------------------------------------------------------
+static THREAD_RETURN THREAD_TYPE writer_thread( void * data )
+{
+    recorder r = (recorder)data;
+
+    while( !r->stop )
+    {
+        if( !drain( r ) )
+            usleep( REC_IDLE_USEC );
+    }
+
+    // the producers are done: everything left, and the partial block
+    RingBuffer::fence();
+    drain( r );
+    if( r->block_used )
+        write_block( r );
+
+    RingBuffer::fence();
+    r->done = true;
+
+    return 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: recorder_open()
+// desc: ...
+//-----------------------------------------------------------------------------
+recorder recorder_open( const char * prefix, int srate, int channels,
+                        int columns, const char * const * names,
+                        int feat_channels, int win_size, int fft_size )
+{
+    char path[1024];
+
+    if( channels <= 0 || srate <= 0 || columns <= 0 )
+        return NULL;
+
+    // pages of whole frames
+    unsigned long pages = REC_BLOCK_SIZE / ( channels * sizeof(float) * 4096 );
+    recorder r = new recorder_;
+    r->wav = NULL;
+    r->srate = srate;
+    r->channels = channels;
+    r->block_size = ( pages ? pages : 1 ) * 4096 * channels * sizeof(float);
+    r->block = aligned_block( r->block_size );
+    r->block_used = 0;
+    r->data_bytes = 0;
+    r->feat = NULL;
+    r->columns = columns;
+    r->record = new unsigned char[sizeof(double) + columns * sizeof(float)];
+    r->dropped_frames = r->dropped_records = 0;
+    r->thread = NULL;
+    r->stop = r->done = false;
+    r->ok = true;
+
+    // audio
+    sprintf( path, "%.1000s.wav", prefix );
+    r->wav = fopen( path, "wb" );
+    if( !r->wav || !r->block || !wav_header( r->wav, srate, channels, 0 ) )
+    {
+        fprintf( stderr, "[sndpeek]: error: cannot record to '%s'...\n", path );
+        r->stop = r->done = true;
+        recorder_close( r );
+        return NULL;
+    }
+    // the blocks are the buffering
+    setvbuf( r->wav, NULL, _IONBF, 0 );
+
+    // features
+    sprintf( path, "%.1000s.feat", prefix );
+    r->feat = feature_writer_open( path, columns, names, feat_channels, srate,
+                                   win_size, fft_size );
+    if( !r->feat )
+    {
+        fprintf( stderr, "[sndpeek]: error: cannot record to '%s'...\n", path );
+        r->stop = r->done = true;
+        recorder_close( r );
+        return NULL;
+    }
+
+    // rings: a few seconds of audio, a few seconds of feature frames
+    if( !r->audio.initialize( REC_RING_SECONDS * srate, channels * sizeof(float) ) ||
+        !r->records.initialize( REC_RING_RECORDS, sizeof(double) + columns * sizeof(float) ) )
+    {
+        fprintf( stderr, "[sndpeek]: error: cannot allocate the recorder...\n" );
+        r->stop = r->done = true;
+        recorder_close( r );
+        return NULL;
+    }
+
+    r->thread = new Thread;
+    if( !r->thread->start( writer_thread, r ) )
+    {
+        fprintf( stderr, "[sndpeek]: error: cannot start the recorder...\n" );
+        r->stop = r->done = true;
+        recorder_close( r );
+        return NULL;
+    }
+
+    return r;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: recorder_audio()
+// desc: ...
+//-----------------------------------------------------------------------------
+bool recorder_audio( recorder r, const float * frames, unsigned long num_frames )
+{
+    unsigned long put = r->audio.put( frames, num_frames );
+    if( put == num_frames )
+        return true;
+
+    r->dropped_frames += num_frames - put;
+    return false;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: recorder_features()
+// desc: ...
+//-----------------------------------------------------------------------------
+bool recorder_features( recorder r, double time, const float * values )
+{
+    unsigned char record[sizeof(double) + 256 * sizeof(float)];
+    unsigned long size = sizeof(double) + r->columns * sizeof(float);
+
+    // one put, so the writer never sees half a record
+    if( size > sizeof(record) || !r->records.writable() )
+    {
+        r->dropped_records++;
+        return false;
+    }
+    memcpy( record, &time, sizeof(double) );
+    memcpy( record + sizeof(double), values, r->columns * sizeof(float) );
+    r->records.put( record, 1 );
+
+    return true;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: recorder_dropped_frames()
+// desc: ...
+//-----------------------------------------------------------------------------
+unsigned long recorder_dropped_frames( recorder r )
+{
+    return r->dropped_frames;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: recorder_dropped_records()
+// desc: ...
+//-----------------------------------------------------------------------------
+unsigned long recorder_dropped_records( recorder r )
+{
+    return r->dropped_records;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: recorder_close()
+// desc: ...
+//-----------------------------------------------------------------------------
+void recorder_close( recorder & r )
+{
+    if( !r ) return;
+
+    // let the writer finish on its own (Thread::wait() cancels it)
+    RingBuffer::fence();
+    r->stop = true;
+    while( !r->done )
+        usleep( REC_IDLE_USEC );
+    delete r->thread;
+
+    if( r->wav )
+    {
+        // now the sizes are known
+        if( r->ok && !wav_header( r->wav, r->srate, r->channels, r->data_bytes ) )
+            r->ok = false;
+        fclose( r->wav );
+    }
+    feature_writer_close( r->feat );
+
+    if( !r->ok )
+        fprintf( stderr, "[sndpeek]: error: recording incomplete...\n" );
+    if( r->dropped_frames || r->dropped_records )
+        fprintf( stderr, "[sndpeek]: recorder dropped %lu audio frames, %lu feature records...\n",
+                 r->dropped_frames, r->dropped_records );
+
+#if defined(_MSC_VER)
+    _aligned_free( r->block );
+#else
+    free( r->block );
+#endif
+    delete [] r->record;
+    delete r;
+    r = NULL;
+}
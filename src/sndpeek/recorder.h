@@ -0,0 +1,41 @@
+//-----------------------------------------------------------------------------
+// name: recorder.h
+// desc: session recorder (--record): audio and features to disk without
+//       the audio callback or the analysis ever waiting on it
+//
+//       the callback put()s its frames into one lock-free ring and the
+//       analysis its feature records into another; a background thread
+//       drains both, writing the audio to <prefix>.wav (float32, the
+//       sample data starting on a page boundary and written in large
+//       page-aligned blocks) and the features to <prefix>.feat (the
+//       --featfile format).  if the disk falls behind for longer than a
+//       ring holds, what doesn't fit is dropped (and counted), never
+//       waited for.
+//-----------------------------------------------------------------------------
+#ifndef __RECORDER_H__
+#define __RECORDER_H__
+
+// forward reference
+typedef struct recorder_ * recorder;
+
+
+// start recording to <prefix>.wav / <prefix>.feat; audio is 'channels'
+// interleaved, features are records of 'columns' values for
+// 'feat_channels' channels (win_size/fft_size go in the feature header)
+recorder recorder_open( const char * prefix, int srate, int channels,
+                        int columns, const char * const * names,
+                        int feat_channels, int win_size, int fft_size );
+// (audio thread) interleaved frames; false if some had to be dropped
+bool recorder_audio( recorder r, const float * frames, unsigned long num_frames );
+// (analysis thread) one record; false if it had to be dropped
+bool recorder_features( recorder r, double time, const float * values );
+// frames / records dropped so far
+unsigned long recorder_dropped_frames( recorder r );
+unsigned long recorder_dropped_records( recorder r );
+// write out what's left, finish both files
+void recorder_close( recorder & r );
+
+
+
+
+#endif
@@ -0,0 +1,71 @@
+//-----------------------------------------------------------------------------
+// name: ringbuffer.h
+// desc: lock-free single-producer / single-consumer ring buffer
+//
+//       one thread may put() while another thread get()s, without locks.
+//       positions are free-running counters; capacity is rounded up to
+//       a power of two so they can be masked into the storage.
+//-----------------------------------------------------------------------------
+#ifndef __RINGBUFFER_H__
+#define __RINGBUFFER_H__
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: class RingBuffer
+// desc: fixed-width elements, one writer thread, one reader thread
+//-----------------------------------------------------------------------------
+class RingBuffer
+{
+public:
+    RingBuffer();
+    ~RingBuffer();
+
+public:
+    // allocate room for (at least) num_elem elements of width bytes each
+    bool initialize( unsigned long num_elem, unsigned long width );
+    void cleanup();
+
+public: // producer side
+    // copy in up to num_elem elements, returns how many actually fit
+    unsigned long put( const void * data, unsigned long num_elem );
+    // number of elements that can be put right now
+    unsigned long writable() const;
+    // total number of elements ever put
+    unsigned long write_pos() const { return m_write; }
+
+public: // consumer side
+    // copy out up to num_elem elements, returns how many were available
+    unsigned long get( void * data, unsigned long num_elem );
+    // number of elements that can be gotten right now
+    unsigned long readable() const;
+    // drop up to num_elem elements, returns how many were dropped
+    unsigned long discard( unsigned long num_elem );
+    // drop everything before producer position 'pos' (never moves back)
+    void skip_to( unsigned long pos );
+    // total number of elements ever gotten
+    unsigned long read_pos() const { return m_read; }
+
+public:
+    unsigned long capacity() const { return m_max_elem; }
+    unsigned long width() const { return m_width; }
+
+public:
+    // full memory barrier, for publishing flags alongside the ring
+    static void fence();
+
+protected:
+    unsigned char * m_data;
+    unsigned long m_width;
+    unsigned long m_max_elem;
+    unsigned long m_mask;
+    // written only by the producer / only by the consumer
+    volatile unsigned long m_write;
+    volatile unsigned long m_read;
+};
+
+
+
+
+#endif
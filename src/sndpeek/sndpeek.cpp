@@ -58,17 +58,32 @@
 #include "RtAudio.h"
 #include "Thread.h"
 
+// read-ahead
+#include "ringbuffer.h"
+
 // OpenGL
 #if defined(__OS_MACOSX__)
   #include <GLUT/glut.h>
   #include <OpenGL/gl.h>
   #include <OpenGL/glu.h>
 #else
+  // buffer object entry points (GL 1.5)
+  #define GL_GLEXT_PROTOTYPES
   #include <GL/glut.h>
   #include <GL/gl.h>
   #include <GL/glu.h>
 #endif
 
+// offscreen rendering (headless, see --render)
+#if defined(__SNDPEEK_OSMESA__)
+  #include <GL/osmesa.h>
+#endif
+
+// vertex buffer waterfall (opengl32 on windows only exports GL 1.1)
+#if !defined(__OS_WINDOWS__)
+  #define __SNDPEEK_VBO__
+#endif
+
 // process related
 #if defined(__OS_WINDOWS__)
   #include <process.h>
@@ -82,15 +97,27 @@
 
 // FFT
 #include "chuck_fft.h"
+// STFT cache
+#include "stft_cache.h"
+// level of detail
+#include "lod.h"
+// instrumentation
+#include "stats.h"
+// N-channel analysis
+#include "multichannel.h"
+// PCM from a pipe
+#include "pcm_stream.h"
+// binary feature output
+#include "feature_writer.h"
+// session recording (--record)
+#include "recorder.h"
+// per-stream analysis (marsyas features)
+#include "stream_analyzer.h"
 
 // Marsyas
-#include "Centroid.h"
 #include "DownSampler.h"
-#include "Flux.h"
-#include "LPC.h"
-#include "MFCC.h"
-#include "RMS.h"
-#include "Rolloff.h"
+#include "ShmCommunicator.h"
+#include "UnixCommunicator.h"
 
 
 
@@ -105,10 +132,49 @@ void keyboardFunc( unsigned char, int, int );
 void mouseFunc( int button, int state, int x, int y );
 void initialize_graphics( );
 bool initialize_audio( );
-void initialize_analysis( );
+bool initialize_analysis( );
 void extract_buffer( );
+bool start_read_ahead( );
+void stop_read_ahead( );
 double compute_log_spacing( int fft_size, double factor );
 double compute_pow_spacing( int fft_size, double factor );
+bool initialize_vbo( );
+void clear_history( );
+const GLfloat * get_history_row( GLint row );
+void upload_spectrum_row( GLint row );
+GLint get_layer_vertices( GLint row, const GLfloat ** xs, const GLfloat ** ys );
+GLint lod_columns( GLfloat x0, GLfloat y0, GLfloat z0, GLfloat x1, GLfloat y1, GLfloat z1 );
+void update_waterfall_lod( );
+int render_offline( );
+bool initialize_buffers( );
+void split_channels( const MY_FLOAT * in, long frames, GLint channels );
+void play_frames( const MY_FLOAT * in, long frames, MY_FLOAT * out );
+GLint window_room( unsigned int frames );
+void window_filled( GLint frames );
+bool initialize_windows( );
+void push_window( );
+void wake_analysis( );
+void wait_window( );
+bool open_feature_output( );
+void close_feature_output( );
+void close_feature_bus( );
+void close_cache( );
+bool open_recorder( );
+void close_recorder( );
+void record_audio( const MY_FLOAT * frames, long num_frames, long pos );
+double record_time( double time );
+bool open_replay( );
+GLboolean replay_step( );
+void read_window( long & pos, long target );
+void stats_poll( );
+void draw_stats( );
+void timerFunc( int value );
+bool start_analysis( );
+void stop_analysis( );
+void analyze_window( );
+void advance_waterfall( );
+void reset_waterfall( );
+void shed_layers( double cost );
 
 
 
@@ -117,11 +183,24 @@ double compute_pow_spacing( int fft_size, double factor );
 // global variables and #defines
 //-----------------------------------------------------------------------------
 #define SAMPLE                  MY_FLOAT
+// defaults, see --winsize and --fftsize
 #define SND_BUFFER_SIZE         1024
 #define SND_FFT_SIZE            ( SND_BUFFER_SIZE * 2 )
-#define SND_MARSYAS_SIZE        ( 512 )
+#define SND_MARSYAS_SIZE        ( SND_BUFFER_SIZE / 2 )
+#define SND_MIN_SIZE            64
+#define SND_MAX_SIZE            65536
 #define INC_VAL_MOUSE           1.0f
 #define INC_VAL_KB              .025f
+// analyzed windows the display can fall behind by
+#define SND_DISPLAY_ROWS        128
+// seconds of windows the analysis can fall behind the audio by (and the
+// fewest windows that is)
+#define SND_WINDOW_QUEUE        2.0
+#define SND_MIN_WINDOWS         16
+// share of the frame period a frame may take before layers are shed,
+// and frames between changes to the number of layers
+#define SND_FRAME_BUDGET        .8
+#define SND_SHED_FRAMES         10
 
 
 // width and height of the window
@@ -145,26 +224,154 @@ GLfloat g_inc = 0.0f;
 GLfloat g_eye_y = 0.0f; // 0.2f for stria, otherwise 0
 
 
-// global audio buffer
-SAMPLE g_fft_buffer[SND_FFT_SIZE];
-SAMPLE g_audio_buffer[SND_BUFFER_SIZE]; // latest mono buffer (possibly preview)
-SAMPLE g_stereo_buffer[SND_BUFFER_SIZE*2]; // current stereo buffer (now playing)
-SAMPLE g_back_buffer[SND_BUFFER_SIZE]; // for lissajous
-SAMPLE g_cur_buffer[SND_BUFFER_SIZE];  // current mono buffer (now playing), for lissajous
-GLfloat g_window[SND_BUFFER_SIZE]; // DFT transform window
-GLfloat g_log_positions[SND_FFT_SIZE/2]; // precompute positions for log spacing
+// global audio buffers (allocated for the sizes below, see initialize_buffers)
+SAMPLE * g_fft_buffer = NULL; // [g_fft_size]
+SAMPLE * g_audio_buffer = NULL; // [g_buffer_size] latest mono buffer (possibly preview)
+SAMPLE * g_stereo_buffer = NULL; // [g_buffer_size*2] current stereo buffer (now playing)
+SAMPLE * g_back_buffer = NULL; // [g_buffer_size] for lissajous
+SAMPLE * g_cur_buffer = NULL; // [g_buffer_size] current mono buffer (now playing), for lissajous
+SAMPLE * g_spectrum = NULL; // [g_fft_size/2] magnitude spectrum of latest window (FFT or cache)
+GLfloat * g_window = NULL; // [g_buffer_size] DFT transform window
+GLfloat * g_log_positions = NULL; // [g_fft_size/2] precompute positions for log spacing
+SAMPLE * g_extract_buffer = NULL; // [g_buffer_size] for extract_buffer()
+SAMPLE * g_multi_buffer = NULL; // [g_buffer_size*g_channels] latest buffer, all channels interleaved
+// analysis window (= audio buffer) and zero-padded FFT size
 GLint g_buffer_size = SND_BUFFER_SIZE;
 GLint g_fft_size = SND_FFT_SIZE;
+// spectrum size for the marsyas features (window size / 2)
+GLint g_marsyas_size = SND_MARSYAS_SIZE;
+// keeps the waterfall height independent of the window size
+GLfloat g_mag_norm = 1.0f;
 
 // real-time audio
 RtAudio * g_audio = NULL;
-GLboolean g_ready = FALSE;
 Mutex g_mutex;
 
 // file reading
 SNDFILE * g_sf = NULL;
 SF_INFO g_sf_info;
 
+// read-ahead: a thread decodes the file into g_read_ring, the audio
+// callback only copies out of it and never touches the file itself
+RingBuffer g_read_ring;
+Thread g_read_thread;
+volatile GLboolean g_read_stop = FALSE;
+volatile GLboolean g_read_done = FALSE;
+// seconds of audio to decode ahead of playback
+GLfloat g_read_ahead = 4.0f;
+// seek handshake (callback bumps the request, reader bumps the ack)
+volatile GLuint g_seek_request = 0;
+volatile GLuint g_seek_ack = 0;
+// ring write position at the moment of the last seek
+volatile unsigned long g_seek_flush = 0;
+// reader has hit the end of the file
+volatile GLboolean g_read_eof = FALSE;
+// file position (in frames) of the audio last taken from the ring
+volatile long g_play_pos = 0;
+// number of callbacks the ring could not fully satisfy
+GLint g_read_underruns = 0;
+// callback is waiting for the reader to finish a seek
+GLboolean g_seeking = FALSE;
+// file position (in frames) of the start of g_audio_buffer
+long g_audio_pos = 0;
+
+// analysis thread (display mode): analyzes every window the audio
+// delivers and hands the display one row per window through g_rows, so
+// the analysis keeps audio time however slowly frames get drawn
+struct DisplayRow
+{
+    long pos;           // file position of the window (frames)
+    long frame;         // cache frame index
+    GLboolean seeking;  // callback was seeking
+    GLboolean restart;  // the stream (re)started: waterfall cleared first
+    float features[5];  // centroid, flux, rms, rolloffs (on view)
+    float pitch[2];     // yin: period (samples, 0: unvoiced), voicing
+    // then g_buffer_size waveform samples and g_fft_size/2 magnitudes
+};
+RingBuffer g_rows;
+// (whoever puts windows) the stream (re)started; the next window, then
+// its row, carry it to the display thread, the only one to touch the
+// waterfall
+GLboolean g_rows_restart = FALSE;
+
+// every whole window, in order, from whatever reads the input (the audio
+// callback, the main loop, replay or the renderer) to the analysis; one
+// it has fallen too far behind to take is counted
+struct AudioWindow
+{
+    long pos;           // stream position of its first frame
+    GLboolean seeking;  // callback was seeking
+    GLboolean restart;  // the stream (re)started
+    // then g_buffer_size mono samples, g_buffer_size * g_channels interleaved
+};
+RingBuffer g_windows;
+// one window each for the side that puts and the side that gets
+unsigned char * g_window_in = NULL;
+unsigned char * g_window_out = NULL;
+unsigned long g_window_size = 0;
+volatile unsigned long g_windows_dropped = 0;
+// the analysis sleeps until a window comes; the callback only wakes it
+#if defined(__OS_WINDOWS__) && !defined(__WINDOWS_PTHREAD__)
+HANDLE g_window_event = NULL;
+#else
+pthread_mutex_t g_window_lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t g_window_cond = PTHREAD_COND_INITIALIZER;
+#endif
+Thread g_analysis_thread;
+GLboolean g_async = FALSE;
+volatile GLboolean g_analysis_stop = FALSE;
+volatile GLboolean g_analysis_done = FALSE;
+// one row each for the analysis and the display side
+unsigned char * g_row_in = NULL;
+unsigned char * g_row_out = NULL;
+unsigned long g_row_size = 0;
+// rows the display fell too far behind to take
+volatile unsigned long g_rows_dropped = 0;
+// frame pacing: target rate (0: every vsync), smoothed frame cost (usec)
+// and the waterfall layers that fit in the budget
+GLfloat g_display_fps = 60.0f;
+double g_frame_cost = 0;
+GLuint g_draw_depth = 0;
+unsigned long g_frames_drawn = 0;
+unsigned long g_frames_skipped = 0;
+
+// instrumentation: per-stage timing (usec) and ring depth (frames);
+// STAT_FFT..STAT_PITCH are g_stream's stages, in STAGE_* order
+enum { STAT_CALLBACK = 0, STAT_QUEUE, STAT_FFT, STAT_CENTROID, STAT_FLUX,
+       STAT_RMS, STAT_ROLLOFF, STAT_ROLLOFF2, STAT_LPC, STAT_MFCC, STAT_PITCH,
+       STAT_FEATURES, STAT_RENDER, NUM_STATS };
+const char * g_stat_names[NUM_STATS] = { "callback", "queue", "fft", "centroid",
+    "flux", "rms", "rolloff50", "rolloff80", "lpc", "mfcc", "pitch", "features",
+    "render" };
+StatHistogram g_stats[NUM_STATS];
+// callbacks flagged by the driver (input overflow / output underflow)
+volatile unsigned long g_xruns = 0;
+// callbacks so far
+volatile unsigned long g_callbacks = 0;
+// on-screen timing display
+GLboolean g_show_stats = FALSE;
+// periodic JSON lines
+const char * g_stats_file = NULL;
+FILE * g_stats_fp = NULL;
+GLfloat g_stats_interval = 1.0f;
+// the last interval as stats_poll() saw it; the display gets copies
+// through g_stats_out rather than reading g_stats under a roll()
+struct StatsSnapshot
+{
+    double cb_rate;
+    double frame_rate;
+    double draw_rate;
+    StatSummary stages[NUM_STATS];
+};
+RingBuffer g_stats_out;
+// the newest of them, display side
+StatsSnapshot g_stats_shown;
+
+// persistent STFT cache (file mode)
+GLboolean g_use_cache = FALSE;
+const char * g_cache_file = NULL;
+stft_cache g_cache = NULL;
+
 // default sample rate
 #if defined(__LINUX_ALSA__) || defined(__LINUX_OSS__) || defined(__LINUX_JACK__)
   GLuint g_srate = 48000;
@@ -200,31 +407,73 @@ GLint g_wf = 0;
 GLint g_starting = 0;
 
 // delay for pseudo-Lissajous in mono stuff
-GLint g_delay = SND_BUFFER_SIZE/2;
+GLint g_delay = SND_BUFFER_SIZE/2; // at most g_buffer_size
 
 // number of real-time audio channels
 GLint g_sndout = 2;
 GLint g_sndin = 2;
+// channels in g_multi_buffer (capture channels, or the file's)
+GLint g_channels = 2;
+// analyze every channel on its own (--channels), not just the downmix
+GLboolean g_multi = FALSE;
+MultiAnalyzer g_analyzer;
+// channel shown and fed to the display features (-1: all channels summed)
+GLint g_view_channel = -1;
 
 // input filename
 const char * g_filename = NULL;
+// PCM on stdin instead (--stdin), format and channels of raw PCM
+pcm_stream g_stdin = NULL;
+GLint g_stdin_format = -1;
+GLint g_stdin_channels = 2;
 
-// marsyas analysis modules
-Centroid * g_centroid = NULL;
+// marsyas analysis
+StreamAnalyzer g_stream;
 DownSampler * g_down_sampler = NULL;
-Flux * g_flux = NULL;
-LPC * g_lpc = NULL;
-MFCC * g_mfcc = NULL;
-RMS * g_rms = NULL;
-Rolloff * g_rolloff = NULL;
-Rolloff * g_rolloff2 = NULL;
 
 // global flags with default...
 // ---
 // print features to stdout
 GLboolean g_stdout = FALSE;
+// binary features instead (--print:bin is "-", or --featfile)
+const char * g_feat_file = NULL;
+feature_writer g_feat_writer = NULL;
+// feature bus for other local processes (--shm:<name>, --socket:<path>),
+// one vector per frame (and channel): time, channel (-1: all),
+// centroid, flux, rms, rolloff50, rolloff80, mfcc 0..12
+#define SND_BUS_SIZE            ( 2 + 5 + 13 )
+const char * g_shm_name = NULL;
+const char * g_socket_path = NULL;
+ShmCommunicator * g_shm = NULL;
+UnixCommunicator * g_socket = NULL;
 // opengl dislpay
 GLboolean g_display = TRUE;
+// session recording (--record:<prefix>) to <prefix>.wav and <prefix>.feat
+const char * g_record_prefix = NULL;
+recorder g_recorder = NULL;
+// (under g_mutex) frames recorded so far, and the last block of them:
+// its stream position (-1: none yet) and length.  the stream may jump
+// (restart, seek) while the recording runs on; features are timed by
+// where their window is in the recording, not in the stream
+long g_record_frames = 0;
+long g_record_last_pos = -1;
+long g_record_last_count = 0;
+// replay of a recording (--replay:<prefix>), silent, at --speed
+// (0: one window per step); the features come from its .feat if any
+const char * g_replay_prefix = NULL;
+char g_replay_wav[1024];
+GLfloat g_replay_speed = 1.0f;
+feature_reader g_replay_feat = NULL;
+// latest replayed features [channels][columns], the record read ahead
+float * g_replay_values = NULL;
+float * g_replay_record = NULL;
+double g_replay_time = 0;
+GLboolean g_replay_pending = FALSE;
+long g_replay_index = 0;
+// render frames offscreen to <prefix>NNNNNN.ppm instead of a window
+const char * g_render_prefix = NULL;
+GLboolean g_headless = FALSE;
+GLfloat g_render_fps = 30.0f;
 // fullscreen
 GLboolean g_fullscreen = FALSE;
 // waveform
@@ -274,9 +523,14 @@ GLfloat g_begintime = 0;
 GLint g_buffer_count_a = 0;
 GLint g_buffer_count_b = 0;
 
-// for waterfall
-struct Pt2D { float x; float y; };
-Pt2D ** g_spectrums = NULL;
+// for waterfall: x is shared by every layer (g_log_positions), only y is
+// kept per layer, quantized to g_hist_bits, all layers in one ring
+#define SND_HIST_Y_MIN          ( -2.0f )
+#define SND_HIST_Y_MAX          ( 6.0f )
+void * g_history = NULL;
+GLint g_hist_bits = 16;
+GLint g_hist_bins = 0; // values per layer
+GLfloat * g_hist_row = NULL; // one dequantized layer
 GLuint g_depth = 48; // for john: 64
 GLfloat g_z = 0.0f;
 GLboolean g_z_set = FALSE;
@@ -284,11 +538,40 @@ GLfloat g_space = .12f; // for john: .1f
 GLboolean g_downsample = FALSE;
 GLint g_ds = 0; // downsample amount
 
+// waterfall in a vertex buffer, used as a ring of g_depth layers
+GLboolean g_use_vbo = TRUE;
+GLboolean g_vbo_ok = FALSE;
+GLuint g_vbo = 0;
+// vertices per layer
+GLint g_vbo_stride = 0;
+// x positions (log spacing, trim) changed: upload every layer again
+GLboolean g_vbo_dirty = TRUE;
+// one layer of (x,y) vertices, staged for upload
+GLfloat * g_vbo_staging = NULL;
+// vertices actually in each layer's slot (fewer with level of detail)
+GLint * g_vbo_counts = NULL;
+
+// level of detail: min/max per pixel column
+GLboolean g_use_lod = TRUE;
+// columns a waterfall layer covers on screen (power of two)
+GLint g_lod_columns = 0;
+// scratch [g_fft_size]
+GLfloat * g_lod_in = NULL;
+GLfloat * g_lod_x = NULL;
+GLfloat * g_lod_y = NULL;
+
 // for time domain waterfall
 SAMPLE ** g_waveforms = NULL;
 GLfloat g_wf_delay_ratio = 1.0f / 3.0f;
 GLuint g_wf_delay = (GLuint)(g_depth * g_wf_delay_ratio + .5f);
 GLuint g_wf_index = 0;
+// (callback) frames of the current g_waveforms[g_wf_index] played so far
+GLint g_wf_fill = 0;
+// (callback) the device's buffer need not be --winsize: the window builds
+// up in g_multi_buffer over as many callbacks as it takes; frames in it
+// so far, and the file (or stream) position of its first
+GLint g_window_fill = 0;
+long g_window_pos = 0;
 
 
 //-----------------------------------------------------------------------------
@@ -315,8 +598,11 @@ void help()
     fprintf( stderr, "'b' - toggle waterfall moving backwards/forwards\n" );
     fprintf( stderr, "'e' - toggle between linear->LOG and linear->POW freq scaling\n" );
     fprintf( stderr, "'*' - restart file playback (if applicable)\n" );
+    fprintf( stderr, "'{', '}' - seek back/forward 5 seconds (if applicable)\n" );
     fprintf( stderr, "'p' - print current settings to terminal\n" );
     fprintf( stderr, "'m' - mute\n" );
+    fprintf( stderr, "'o' - toggle timing display (per stage, usec)\n" );
+    fprintf( stderr, "'n' - next channel to view (all summed, 0, 1, ...)\n" );
     fprintf( stderr, "'j' - move spectrum + z\n" );
     fprintf( stderr, "'k' - move spectrum - z\n" );
     fprintf( stderr, "'u' - spacing more!\n" );
@@ -357,11 +643,17 @@ void usage()
     fprintf( stderr, "usage: sndpeek  --[options] [filename]\n" );
     fprintf( stderr, "  ON/OFF options: fullscreen|waveform|lissajous|waterfall|\n" );
     fprintf( stderr, "                  dB|features|fallcolors|backward|showtime|\n" );
-    fprintf( stderr, "                  freeze\n" );
+    fprintf( stderr, "                  freeze|cache|vbo|lod|hud\n" );
     fprintf( stderr, "  number options: timescale|freqscale|lissscale|logfactor|powfactor|\n" );
     fprintf( stderr, "                  spacing|zpos|dzpos|depth|preview|yview|\n" );
-    fprintf( stderr, "                  rotatem|rotatek|begintime|ds|ltrim\n" );
-    fprintf( stderr, "   other options: nodisplay|print\n" );
+    fprintf( stderr, "                  rotatem|rotatek|begintime|ds|ltrim|readahead|\n" );
+    fprintf( stderr, "                  histbits (8|16)|fps (0: vsync)|size (WxH)|winsize|fftsize|\n" );
+    fprintf( stderr, "                  statsinterval|channels (analyze each channel)\n" );
+    fprintf( stderr, "   other options: nodisplay|print|cachefile|render (prefix)|stats (file or -)|\n" );
+    fprintf( stderr, "                  stdin (f32[:channels]|s16[:channels]|wav, implies nodisplay)|\n" );
+    fprintf( stderr, "                  print:bin (binary features to stdout)|featfile (binary features)|\n" );
+    fprintf( stderr, "                  shm (name, shared memory feature ring)|socket (path, feature datagrams)|\n" );
+    fprintf( stderr, "                  record (prefix, audio + features)|replay (prefix)|speed (replay, 0: fast)\n" );
     fprintf( stderr, "\n" );
     fprintf( stderr, "example:\n" );
     fprintf( stderr, "    sndpeek --fullscreen:ON --features:OFF --spacing:.05\n" );
@@ -382,6 +674,7 @@ int main( int argc, char ** argv )
 {
     // remember command line
     GLboolean set_play = FALSE;
+    GLint win_size = 0, fft_size = 0;
 
     // command line arguments
     for( int i = 1; i < argc; i++ )
@@ -390,6 +683,28 @@ int main( int argc, char ** argv )
         {
             if( !strcmp( argv[i], "--print" ) )
                 g_stdout = TRUE;
+            else if( !strcmp( argv[i], "--print:bin" ) )
+                g_feat_file = "-";
+            else if( !strncmp( argv[i], "--featfile:", 11 ) )
+                g_feat_file = argv[i]+11;
+            else if( !strncmp( argv[i], "--shm:", 6 ) )
+                g_shm_name = argv[i]+6;
+            else if( !strncmp( argv[i], "--socket:", 9 ) )
+                g_socket_path = argv[i]+9;
+            else if( !strncmp( argv[i], "--record:", 9 ) )
+                g_record_prefix = argv[i]+9;
+            else if( !strncmp( argv[i], "--replay:", 9 ) )
+                g_replay_prefix = argv[i]+9;
+            else if( !strncmp( argv[i], "--speed:", 8 ) )
+            {
+                g_replay_speed = atof( argv[i]+8 );
+                if( g_replay_speed < 0 )
+                {
+                    fprintf( stderr, "[sndpeek]: --speed requires value >= 0...\n" );
+                    usage();
+                    return -1;
+                }
+            }
             else if( !strcmp( argv[i], "--help" ) || !strcmp( argv[i], "--about" ) )
             {
                 usage();
@@ -397,6 +712,29 @@ int main( int argc, char ** argv )
             }
             else if( !strcmp( argv[i], "--sndout" ) )
                 g_sndout = 2;
+            else if( !strncmp( argv[i], "--channels:", 11 ) )
+            {
+                g_sndin = atoi( argv[i]+11 );
+                if( g_sndin < 1 || g_sndin > 256 )
+                {
+                    fprintf( stderr, "[sndpeek]: --channels requires 1 <= value <= 256...\n" );
+                    usage();
+                    return -1;
+                }
+                g_multi = TRUE;
+            }
+            else if( !strncmp( argv[i], "--stdin:", 8 ) )
+            {
+                const char * channels = strchr( argv[i]+8, ':' );
+                g_stdin_format = pcm_stream_format( argv[i]+8 );
+                g_stdin_channels = channels ? atoi( channels+1 ) : g_stdin_channels;
+                if( g_stdin_format < 0 || g_stdin_channels < 1 || g_stdin_channels > 256 )
+                {
+                    fprintf( stderr, "[sndpeek]: --stdin requires f32[:channels], s16[:channels] or wav...\n" );
+                    usage();
+                    return -1;
+                }
+            }
             else if( !strcmp( argv[i], "--nodisplay" ) )
                 g_display = FALSE;
             else if( !strcmp(argv[i], "--fullscreen") || !strcmp(argv[i], "--fullscreen:ON") )
@@ -443,6 +781,23 @@ int main( int argc, char ** argv )
                 g_draw_play = set_play = TRUE;
             else if( !strcmp(argv[i], "--drawplay:OFF") )
             {   g_show_time = FALSE; set_play = TRUE;   } 
+            else if( !strcmp(argv[i], "--cache") || !strcmp(argv[i], "--cache:ON") )
+                g_use_cache = TRUE;
+            else if( !strcmp(argv[i], "--cache:OFF") )
+                g_use_cache = FALSE;
+            else if( !strcmp(argv[i], "--vbo") || !strcmp(argv[i], "--vbo:ON") )
+                g_use_vbo = TRUE;
+            else if( !strcmp(argv[i], "--vbo:OFF") )
+                g_use_vbo = FALSE;
+            else if( !strcmp(argv[i], "--lod") || !strcmp(argv[i], "--lod:ON") )
+                g_use_lod = TRUE;
+            else if( !strcmp(argv[i], "--lod:OFF") )
+                g_use_lod = FALSE;
+            else if( !strncmp(argv[i], "--cachefile:", 12) )
+            {
+                g_cache_file = argv[i]+12;
+                g_use_cache = TRUE;
+            }
             else if( !strncmp(argv[i], "--srate:", 8) )
                 g_srate = atoi( argv[i]+8 ) > 0 ? atoi( argv[i]+8 ) : g_srate;
             else if( !strncmp(argv[i], "--timescale:", 12) )
@@ -482,6 +837,16 @@ int main( int argc, char ** argv )
             {
                 g_depth = atoi( argv[i]+8 ) > 0 ? atoi( argv[i]+8 ) : g_depth;
             }
+            else if( !strncmp(argv[i], "--histbits:", 11) )
+            {
+                g_hist_bits = atoi( argv[i]+11 );
+                if( g_hist_bits != 8 && g_hist_bits != 16 )
+                {
+                    fprintf( stderr, "[sndpeek]: --histbits must be 8 or 16...\n" );
+                    usage();
+                    return -1;
+                }
+            }
             else if( !strncmp(argv[i], "--preview:", 10) )
             {
                 g_wf_delay_ratio = atof( argv[i]+10 );
@@ -496,6 +861,46 @@ int main( int argc, char ** argv )
                 g_eye_y = atof( argv[i] + 8 );
             else if( !strncmp( argv[i], "--begintime:", 12 ) )
                 g_begintime = atof( argv[i]+12 ) >= 0 ? atof( argv[i]+12 ) : g_begintime; 
+            else if( !strncmp( argv[i], "--render:", 9 ) )
+            {
+#if defined(__SNDPEEK_OSMESA__)
+                g_render_prefix = argv[i]+9;
+#else
+                fprintf( stderr, "[sndpeek]: --render needs a build with offscreen rendering (makefile.headless)...\n" );
+                return -1;
+#endif
+            }
+            else if( !strcmp(argv[i], "--hud") || !strcmp(argv[i], "--hud:ON") )
+                g_show_stats = TRUE;
+            else if( !strcmp(argv[i], "--hud:OFF") )
+                g_show_stats = FALSE;
+            else if( !strncmp( argv[i], "--stats:", 8 ) )
+                g_stats_file = argv[i]+8;
+            else if( !strncmp( argv[i], "--statsinterval:", 16 ) )
+                g_stats_interval = atof( argv[i]+16 ) > 0 ? atof( argv[i]+16 ) : g_stats_interval;
+            else if( !strncmp( argv[i], "--winsize:", 10 ) )
+                win_size = atoi( argv[i]+10 );
+            else if( !strncmp( argv[i], "--fftsize:", 10 ) )
+                fft_size = atoi( argv[i]+10 );
+            else if( !strncmp( argv[i], "--fps:", 6 ) )
+            {
+                // offscreen: frames of the file; live: target rate, 0 = every vsync
+                g_render_fps = atof( argv[i]+6 ) > 0 ? atof( argv[i]+6 ) : g_render_fps;
+                g_display_fps = atof( argv[i]+6 ) >= 0 ? atof( argv[i]+6 ) : g_display_fps;
+            }
+            else if( !strncmp( argv[i], "--size:", 7 ) )
+            {
+                int w = 0, h = 0;
+                if( sscanf( argv[i]+7, "%dx%d", &w, &h ) != 2 || w <= 0 || h <= 0 )
+                {
+                    fprintf( stderr, "[sndpeek]: --size requires WIDTHxHEIGHT...\n" );
+                    usage();
+                    return -1;
+                }
+                g_width = w; g_height = h;
+            }
+            else if( !strncmp( argv[i], "--readahead:", 12 ) )
+                g_read_ahead = atof( argv[i]+12 ) > 0 ? atof( argv[i]+12 ) : g_read_ahead;
             else if( !strncmp( argv[i], "--ds:", 5 ) )
             {
                 g_ds = atoi( argv[i] + 5 ) >= 0 ? atoi( argv[i] + 5 ) : 0; 
@@ -527,9 +932,101 @@ int main( int argc, char ** argv )
     // compute delay, but disable delay if it's mic input
     g_wf_delay = g_filename ? (GLuint)(g_wf_delay_ratio * g_depth + .5f) : 0;
 
+    // window and FFT sizes: powers of two, FFT (zero-padded) at least the window
+    if( !win_size ) win_size = fft_size ? fft_size / 2 : SND_BUFFER_SIZE;
+    if( !fft_size ) fft_size = win_size * 2;
+    if( win_size < SND_MIN_SIZE || fft_size > SND_MAX_SIZE || fft_size < win_size ||
+        ( win_size & (win_size-1) ) || ( fft_size & (fft_size-1) ) )
+    {
+        fprintf( stderr, "[sndpeek]: --winsize/--fftsize must be powers of 2, %d <= winsize <= fftsize <= %d...\n",
+                 SND_MIN_SIZE, SND_MAX_SIZE );
+        usage();
+        return -1;
+    }
+    g_buffer_size = win_size;
+    g_fft_size = fft_size;
+    if( !initialize_buffers() )
+    {
+        fprintf( stderr, "[sndpeek]: error: cannot allocate buffers...\n" );
+        return -3;
+    }
+
+    // one thing at a time on stdout
+    if( g_feat_file && !strcmp( g_feat_file, "-" ) &&
+        ( g_stdout || ( g_stats_file && !strcmp( g_stats_file, "-" ) ) ) )
+    {
+        fprintf( stderr, "[sndpeek]: --print:bin cannot share stdout with --print or --stats:-...\n" );
+        usage();
+        return -1;
+    }
+
+    // timing reports
+    if( !g_stats_out.initialize( 4, sizeof(StatsSnapshot) ) )
+    {
+        fprintf( stderr, "[sndpeek]: error: cannot allocate buffers...\n" );
+        return -3;
+    }
+    if( g_stats_file )
+    {
+        g_stats_fp = !strcmp( g_stats_file, "-" ) ? stdout : fopen( g_stats_file, "a" );
+        if( !g_stats_fp )
+        {
+            fprintf( stderr, "[sndpeek]: error: cannot open '%s' for stats...\n", g_stats_file );
+            return -1;
+        }
+    }
+
+    // offscreen: no window, no audio device, the file sets the pace
+    if( g_render_prefix )
+    {
+        if( !g_filename )
+        {
+            fprintf( stderr, "[sndpeek]: --render requires a file...\n" );
+            usage();
+            return -1;
+        }
+        g_headless = TRUE;
+        g_display = FALSE;
+        g_sndout = 0;
+    }
+
+    // pipeline: no window, no audio device, the stream sets the pace
+    if( g_stdin_format >= 0 )
+    {
+        if( g_filename || g_render_prefix )
+        {
+            fprintf( stderr, "[sndpeek]: --stdin cannot be used with a file...\n" );
+            usage();
+            return -1;
+        }
+        g_display = FALSE;
+        g_sndout = 0;
+        g_sndin = 0;
+    }
+
+    // replay: the recording is the file, and our own clock the pace
+    if( g_replay_prefix )
+    {
+        if( g_filename || g_stdin_format >= 0 || g_render_prefix )
+        {
+            fprintf( stderr, "[sndpeek]: --replay cannot be used with a file, --stdin or --render...\n" );
+            usage();
+            return -1;
+        }
+        if( g_record_prefix && !strcmp( g_record_prefix, g_replay_prefix ) )
+        {
+            fprintf( stderr, "[sndpeek]: --record would overwrite the recording being replayed...\n" );
+            return -1;
+        }
+        sprintf( g_replay_wav, "%.1000s.wav", g_replay_prefix );
+        g_filename = g_replay_wav;
+        g_sndout = 0;
+        g_starting = 1;
+    }
+
     // infer settings
     if( g_filename ) g_sndin = 0;
-    if( !g_sndin && !g_sndout ) g_display = FALSE;
+    if( !g_sndin && !g_sndout && !g_replay_prefix ) g_display = FALSE;
     if( !set_play && g_filename ) g_draw_play = TRUE;
 
     // if using graphics
@@ -560,8 +1057,11 @@ int main( int argc, char ** argv )
         if( g_fullscreen )
             glutFullScreen();
 
-        // set the idle function - called when idle
-        glutIdleFunc( idleFunc );
+        // draw at g_display_fps, or as often as the swap allows
+        if( g_display_fps > 0 )
+            glutTimerFunc( 0, timerFunc, 0 );
+        else
+            glutIdleFunc( idleFunc );
         // set the display function - called when redrawing
         glutDisplayFunc( displayFunc );
         // set the reshape function - called when client area changes
@@ -576,7 +1076,11 @@ int main( int argc, char ** argv )
     }
     
     // initialize analysis
-    initialize_analysis( );
+    if( !initialize_analysis( ) )
+    {
+        fprintf( stderr, "[sndpeek]: cannot initialize analysis...\n" );
+        return -3;
+    }
     
     // intialize real-time audio
     if( !initialize_audio( ) )
@@ -584,10 +1088,73 @@ int main( int argc, char ** argv )
         fprintf( stderr, "[sndpeek]: exiting...\n" );
         return -3;
     }
+    // (registered before stop_analysis: closes after it)
+    if( g_cache )
+        atexit( close_cache );
+
+    // binary features (knows the rate and channels now)
+    if( g_feat_file )
+    {
+        if( !open_feature_output() )
+        {
+            fprintf( stderr, "[sndpeek]: error: cannot open '%s' for features...\n", g_feat_file );
+            return -1;
+        }
+        // 'q' and friends exit() from anywhere
+        atexit( close_feature_output );
+    }
+
+    // feature bus
+    if( g_shm_name )
+    {
+        g_shm = new ShmCommunicator( g_shm_name, SND_BUS_SIZE );
+        if( !g_shm->ok() )
+        {
+            fprintf( stderr, "[sndpeek]: error: cannot create shared memory '%s'...\n", g_shm_name );
+            return -1;
+        }
+    }
+    if( g_socket_path )
+    {
+        g_socket = new UnixCommunicator( g_socket_path, true );
+        if( !g_socket->ok() )
+        {
+            fprintf( stderr, "[sndpeek]: error: cannot bind socket '%s'...\n", g_socket_path );
+            return -1;
+        }
+    }
+    // the ring and socket go away with the process
+    if( g_shm || g_socket )
+        atexit( close_feature_bus );
+
+    // session recording
+    if( g_record_prefix )
+    {
+        if( !open_recorder() )
+            return -1;
+        atexit( close_recorder );
+    }
+
+    // features of the recording being replayed
+    if( g_replay_prefix && !open_replay() )
+        return -1;
+
+    // offscreen
+    if( g_headless )
+        return render_offline();
 
     // display mode
     if( g_display )
     {
+        // analysis keeps to the audio on its own thread
+        if( !start_analysis() )
+        {
+            fprintf( stderr, "[sndpeek]: error: cannot start the analysis thread...\n" );
+            return -3;
+        }
+        // (registered last: stops before the outputs close)
+        atexit( stop_analysis );
+
         // let GLUT handle the current thread from here
         glutMainLoop();
     }
@@ -597,12 +1164,50 @@ int main( int argc, char ** argv )
         sf_count_t count;
         while( g_running )
         {
-            if( g_filename && !g_sndout )
+            if( g_replay_prefix )
+            {
+                // one hop at a time, at the chosen speed
+                if( !replay_step() )
+                {
+                    fprintf( stderr, "[sndpeek]: end of recording...\n" );
+                    break;
+                }
+                // recorded features are already out (the window isn't needed)
+                if( g_replay_feat )
+                {
+                    g_windows.discard( g_windows.readable() );
+                    continue;
+                }
+            }
+            else if( g_stdin )
+            {
+                // one window at a time, waiting for the pipe
+                count = pcm_stream_read( g_stdin, g_multi_buffer, g_buffer_size );
+                if( !count )
+                {
+                    fprintf( stderr, "[sndpeek]: end of input stream...\n" );
+                    break;
+                }
+                memset( g_multi_buffer + count * g_channels, 0,
+                        (g_buffer_size - count) * g_channels * sizeof(SAMPLE) );
+                split_channels( g_multi_buffer, g_buffer_size, g_channels );
+                g_audio_pos = g_play_pos;
+                g_play_pos += count;
+                record_audio( g_multi_buffer, count, g_audio_pos );
+                push_window( );
+            }
+            else if( g_filename && !g_sndout )
             {
-                // TODO: (to check) does this work for stereo files? 
-                count = sf_read_float( g_sf, g_audio_buffer, g_buffer_size );
+                // whole frames, any number of channels
+                count = sf_readf_float( g_sf, g_multi_buffer, g_buffer_size );
+                memset( g_multi_buffer + count * g_channels, 0,
+                        (g_buffer_size - count) * g_channels * sizeof(SAMPLE) );
+                split_channels( g_multi_buffer, g_buffer_size, g_channels );
+                g_audio_pos = g_play_pos;
+                g_play_pos += count;
+                record_audio( g_multi_buffer, count, g_audio_pos );
                 g_buffer_count_a++;
-                g_ready = TRUE;
+                push_window( );
                 if( !count )
                 {
                     g_file_running = FALSE;
@@ -621,6 +1226,232 @@ int main( int argc, char ** argv )
 
 
 
+//-----------------------------------------------------------------------------
+// name: new_samples()
+// desc: zeroed buffer of n floats, aligned for vector loads
+//-----------------------------------------------------------------------------
+SAMPLE * new_samples( long n )
+{
+    void * p = NULL;
+#if defined(_MSC_VER)
+    p = _aligned_malloc( n * sizeof(SAMPLE), 32 );
+#else
+    if( posix_memalign( &p, 32, n * sizeof(SAMPLE) ) )
+        p = NULL;
+#endif
+    if( p ) memset( p, 0, n * sizeof(SAMPLE) );
+    return (SAMPLE *)p;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: initialize_buffers()
+// desc: allocates everything sized by g_buffer_size / g_fft_size
+//-----------------------------------------------------------------------------
+bool initialize_buffers( )
+{
+    g_fft_buffer = new_samples( g_fft_size );
+    g_audio_buffer = new_samples( g_buffer_size );
+    g_stereo_buffer = new_samples( g_buffer_size * 2 );
+    g_back_buffer = new_samples( g_buffer_size );
+    g_cur_buffer = new_samples( g_buffer_size );
+    g_spectrum = new_samples( g_fft_size / 2 );
+    g_window = new_samples( g_buffer_size );
+    g_log_positions = new_samples( g_fft_size / 2 );
+    g_extract_buffer = new_samples( g_buffer_size );
+    g_lod_in = new_samples( g_fft_size );
+    g_lod_x = new_samples( g_fft_size );
+    g_lod_y = new_samples( g_fft_size );
+
+    if( !g_fft_buffer || !g_audio_buffer || !g_stereo_buffer || !g_back_buffer ||
+        !g_cur_buffer || !g_spectrum || !g_window || !g_log_positions ||
+        !g_extract_buffer || !g_lod_in || !g_lod_x || !g_lod_y )
+        return false;
+
+    // features see the window's own spectrum
+    g_marsyas_size = g_buffer_size / 2;
+    // magnitudes grow with the window
+    g_mag_norm = (GLfloat)SND_BUFFER_SIZE / g_buffer_size;
+    // lissajous delay
+    if( g_delay > g_buffer_size ) g_delay = g_buffer_size / 2;
+
+    return true;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: split_channels()
+// desc: from interleaved frames of any width, fills g_stereo_buffer (first
+//       two channels, mono doubled) and g_audio_buffer (mean of all)
+//-----------------------------------------------------------------------------
+void split_channels( const SAMPLE * in, long frames, GLint channels )
+{
+    for( long i = 0; i < frames; i++ )
+    {
+        const SAMPLE * frame = in + i * channels;
+        SAMPLE sum = 0;
+        for( GLint c = 0; c < channels; c++ )
+            sum += frame[c];
+        g_audio_buffer[i] = sum / channels;
+        g_stereo_buffer[i*2] = frame[0];
+        g_stereo_buffer[i*2+1] = channels > 1 ? frame[1] : frame[0];
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: open_feature_output()
+// desc: binary features to g_feat_file, columns named by the modules
+//-----------------------------------------------------------------------------
+bool open_feature_output( )
+{
+    // in the order output_features() writes them
+    const char * columns[ANALYZE_COLUMNS];
+    int n = g_stream.feature_names( columns );
+
+    g_feat_writer = feature_writer_open( g_feat_file, n, columns,
+                                         g_multi ? g_channels : 1, g_srate,
+                                         g_buffer_size, g_fft_size );
+    return g_feat_writer != NULL;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: close_feature_output()
+// desc: flushes and finishes the feature file (at exit)
+//-----------------------------------------------------------------------------
+void close_feature_output( )
+{
+    feature_writer_close( g_feat_writer );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: close_feature_bus()
+// desc: removes the shared memory ring / socket (at exit)
+//-----------------------------------------------------------------------------
+void close_feature_bus( )
+{
+    delete g_shm; g_shm = NULL;
+    delete g_socket; g_socket = NULL;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: close_cache()
+// desc: unmaps the STFT cache (at exit, after the analysis stops)
+//-----------------------------------------------------------------------------
+void close_cache( )
+{
+    stft_cache_close( g_cache );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: open_recorder()
+// desc: starts recording the session (--record)
+//-----------------------------------------------------------------------------
+bool open_recorder( )
+{
+    // features as output_features() writes them
+    const char * columns[ANALYZE_COLUMNS];
+    int n = g_stream.feature_names( columns );
+
+    recorder r = recorder_open( g_record_prefix, g_srate, g_channels, n, columns,
+                                g_multi ? g_channels : 1, g_buffer_size, g_fft_size );
+    if( !r )
+        return false;
+
+    // the callback may be running already
+    g_mutex.lock();
+    g_recorder = r;
+    g_mutex.unlock();
+
+    fprintf( stderr, "[sndpeek]: recording to %s.wav / %s.feat...\n",
+             g_record_prefix, g_record_prefix );
+    return true;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: close_recorder()
+// desc: finishes the recording (at exit)
+//-----------------------------------------------------------------------------
+void close_recorder( )
+{
+    // the callback records under the lock
+    g_mutex.lock();
+    recorder r = g_recorder;
+    g_recorder = NULL;
+    g_mutex.unlock();
+
+    recorder_close( r );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: record_audio()
+// desc: new input frames (all channels) starting at stream position 'pos'
+//-----------------------------------------------------------------------------
+void record_audio( const SAMPLE * frames, long num_frames, long pos )
+{
+    if( !g_recorder || num_frames <= 0 )
+        return;
+
+    // features are timed by this
+    g_record_frames += num_frames;
+    g_record_last_pos = pos;
+    g_record_last_count = num_frames;
+    recorder_audio( g_recorder, frames, num_frames );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: record_time()
+// desc: where stream time 'time' is in the recording (seconds); -1 if it
+//       isn't (before the recording, or in a stretch the stream has
+//       since jumped away from)
+//-----------------------------------------------------------------------------
+double record_time( double time )
+{
+    // the recorder's frame count, plus the offset in its last block
+    g_mutex.lock();
+    long frames = g_record_frames, last = g_record_last_pos;
+    long start = g_record_frames - g_record_last_count;
+    g_mutex.unlock();
+
+    if( last < 0 )
+        return -1;
+    double frame = start + ( time * g_srate - last );
+    if( frame < 0 || frame > frames )
+        return -1;
+
+    return frame / g_srate;
+}
+
+
+
+
 //-----------------------------------------------------------------------------
 // name: cb()
 // desc: audio callback
@@ -631,15 +1462,20 @@ int cb( void * outputBuffer, void * inputBuffer, unsigned int numFrames,
     // cast
     SAMPLE * outBuffy = (SAMPLE *)outputBuffer;
     SAMPLE * inBuffy = (SAMPLE *)inputBuffer;
+    // timing
+    double start = stats_now_usec();
+
+    // count
+    g_callbacks++;
+    if( status ) g_xruns++;
     
     // clear
     memset( outBuffy, 0, numFrames * 2 * sizeof(SAMPLE) );
 
-    // freeze frame
+    // freeze frame (nothing new for the analysis either)
     if( g_freeze )
     {
         memset( outBuffy, 0, numFrames * 2 * sizeof(SAMPLE) );
-        g_ready = TRUE;
         return 0;
     }
 
@@ -648,104 +1484,101 @@ int cb( void * outputBuffer, void * inputBuffer, unsigned int numFrames,
     // check if reading from file
     if( !g_filename )
     {
-        // copy
-        memcpy( g_stereo_buffer, inBuffy, numFrames * 2 * sizeof(SAMPLE) );
-        // convert stereo to mono
-        for( int i = 0; i < numFrames; i++)
+        for( unsigned int done = 0, n; done < numFrames; done += n )
         {
-            g_audio_buffer[i] = g_stereo_buffer[i*2] + g_stereo_buffer[i*2+1];
-            g_audio_buffer[i] /= 2.0f;
+            const SAMPLE * piece = inBuffy + done * g_channels;
+            n = window_room( numFrames - done );
+            // copy (all channels)
+            memcpy( g_multi_buffer + g_window_fill * g_channels, piece,
+                    n * g_channels * sizeof(SAMPLE) );
+            // session recording
+            record_audio( piece, n, g_play_pos );
+            // position in the input stream
+            g_play_pos += n;
+            window_filled( n );
         }
     }
     else
     {
+        // seek handshake
+        static GLuint flushed = 0;
+        // end of file, sampled before reading so no trailing frames are lost
+        GLboolean eof = g_read_eof;
+
         // check for restart
         if( g_restart )
         {
-            // set playback position to begin
-            sf_seek( g_sf, (int)(g_begintime * g_srate), SEEK_SET );
+            // ask the read-ahead thread to seek to the beginning
+            g_seek_request++;
+            g_seeking = TRUE;
             g_wf_index = 0;
-            g_wf = 0;
-            g_starting = 1;
+            g_wf_fill = 0;
             g_restart = FALSE;
-            // clear waveforms and waterfall and drawing booleans
-            for( GLint i = 0; i < g_wf_delay || i < g_depth; i++ )
-            {
-                if( i < g_wf_delay )
-                    memset( g_waveforms[i], 0, g_buffer_size * 2 * sizeof(SAMPLE) );
-                if( g_display && i < g_depth )
-                {
-                    memset( g_spectrums[i], 0, sizeof(Pt2D)*SND_FFT_SIZE );
-                    g_draw[i] = false;
-                }
-            }
+            // clear waveforms; the display clears the waterfall
+            for( GLint i = 0; g_waveforms && i < g_wf_delay; i++ )
+                memset( g_waveforms[i], 0, g_buffer_size * 2 * sizeof(SAMPLE) );
+            g_rows_restart = TRUE;
         }
 
-        // if not done yet...
-        if( sf_seek(g_sf, 0, SEEK_CUR) < g_sf_info.frames && !g_pause )
+        // reader has seeked: drop everything it decoded before that (and
+        // the window begun before it)
+        if( flushed != g_seek_ack && g_seek_ack == g_seek_request )
         {
-            // get the mono/stereo version
-            sf_readf_float( g_sf, g_stereo_buffer, numFrames );
+            RingBuffer::fence();
+            g_read_ring.skip_to( g_seek_flush );
+            g_audio_pos = g_play_pos = (long)(g_begintime * g_srate);
+            g_window_fill = 0;
+            flushed = g_seek_ack;
+            g_seeking = FALSE;
+            eof = FALSE;
+        }
 
-            // if stereo, convert to mono
-            if( g_sf_info.channels == 2 )
+        // how far the reader is ahead
+        g_stats[STAT_QUEUE].add( g_read_ring.readable() );
+
+        for( unsigned int done = 0, n; done < numFrames; done += n )
+        {
+            n = window_room( numFrames - done );
+            SAMPLE * piece = g_multi_buffer + g_window_fill * g_channels;
+            unsigned long got = 0;
+
+            // still seeking, or paused
+            if( flushed != g_seek_request || g_pause )
+                memset( piece, 0, n * g_channels * sizeof(SAMPLE) );
+            // if not done yet...
+            else if( (got = g_read_ring.get( piece, n )) || !eof )
             {
-                // convert stereo to mono
-                for( int i = 0; i < numFrames; i++)
+                // not enough decoded yet (disk too slow); pad with silence
+                if( got < n )
                 {
-                    g_audio_buffer[i] = g_stereo_buffer[i*2] + g_stereo_buffer[i*2+1];
-                    g_audio_buffer[i] /= 2.0f;
+                    memset( piece + got * g_channels, 0, (n - got) * g_channels * sizeof(SAMPLE) );
+                    g_read_underruns++;
                 }
+                // session recording
+                record_audio( piece, got, g_play_pos );
+                // advance play position
+                g_play_pos += got;
+                // play stereo (through the preview delay)
+                play_frames( piece, n, outBuffy + done * 2 );
+                // count (the window this piece ends, if it does)
+                if( g_window_fill + (GLint)n == g_buffer_size )
+                    g_buffer_count_a++;
             }
             else
             {
-                // actually mono
-                memcpy( g_audio_buffer, g_stereo_buffer, numFrames * sizeof(SAMPLE) );
-                // convert mono to stereo
-                for( int i = 0; i < numFrames; i++ )
-                {
-                    g_stereo_buffer[i*2] = g_stereo_buffer[i*2+1] = g_audio_buffer[i];
-                }
-            }
-
-            // time-domain waterfall delay
-            if( g_waveforms != NULL )
-            {
-                // put current buffer in time-domain waterfall
-                memcpy( g_waveforms[g_wf_index], g_stereo_buffer, numFrames * 2 * sizeof(SAMPLE) );
-                // incrment index (this is also the index to copy out of)
-                g_wf_index = (g_wf_index + 1) % g_wf_delay;
-                // copy delayed buffer out of time-domain waterfall
-                memcpy( g_stereo_buffer, g_waveforms[g_wf_index], numFrames * 2 * sizeof(SAMPLE) );
+                // done...
+                g_running = FALSE;
+                // zero
+                memset( piece, 0, n * g_channels * sizeof(SAMPLE) );
+                // what is left in the preview delay, then silence
+                if( g_waveforms )
+                    play_frames( piece, n, outBuffy + done * 2 );
             }
 
-            // play stereo
-            memcpy( outBuffy, g_stereo_buffer, numFrames * 2 * sizeof(SAMPLE) );
-
-            // count
-            g_buffer_count_a++;
-        }
-        else
-        {
-            // done...
-            g_running = FALSE;
-            // zero
-            memset( g_audio_buffer, 0, numFrames * sizeof(SAMPLE) );
-            // copy remaining delayed waveform buffers one by one
-            if( g_wf_delay )
-            {
-                memset( g_waveforms[g_wf_index], 0, numFrames * 2 * sizeof(SAMPLE) );
-                g_wf_index = (g_wf_index + 1) % g_wf_delay; 
-                memcpy( g_stereo_buffer, g_waveforms[g_wf_index], numFrames * 2 * sizeof(SAMPLE) );
-                memcpy( outBuffy, g_stereo_buffer, numFrames * 2 * sizeof(SAMPLE) );
-            }
-            else
-                memset( outBuffy, 0, 2 * numFrames * sizeof(SAMPLE) );
+            window_filled( n );
         }
     }
-    
-    // set flag
-    g_ready = TRUE;
+
     // unlock
     g_mutex.unlock();
 
@@ -753,12 +1586,464 @@ int cb( void * outputBuffer, void * inputBuffer, unsigned int numFrames,
     if( g_mute )
         memset( outBuffy, 0, numFrames * 2 * sizeof(SAMPLE) );
 
+    g_stats[STAT_CALLBACK].add( stats_now_usec() - start );
+
     return 0;
 }
 
 
 
 
+//-----------------------------------------------------------------------------
+// name: window_room()
+// desc: (callback) how many of 'frames' fit in the rest of the window
+//       (a new one starts where the stream is now)
+//-----------------------------------------------------------------------------
+GLint window_room( unsigned int frames )
+{
+    GLint room = g_buffer_size - g_window_fill;
+    if( !g_window_fill )
+        g_window_pos = g_play_pos;
+    return frames < (unsigned int)room ? (GLint)frames : room;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: window_filled()
+// desc: (callback) 'frames' more in g_multi_buffer; a whole window goes
+//       to the analysis
+//-----------------------------------------------------------------------------
+void window_filled( GLint frames )
+{
+    g_window_fill += frames;
+    if( g_window_fill < g_buffer_size )
+        return;
+
+    // stereo and mono
+    split_channels( g_multi_buffer, g_buffer_size, g_channels );
+    // (what is playing is the window out of the preview delay)
+    if( g_waveforms )
+        memcpy( g_stereo_buffer, g_waveforms[(g_wf_index + 1) % g_wf_delay],
+                g_buffer_size * 2 * sizeof(SAMPLE) );
+    g_audio_pos = g_window_pos;
+    g_window_fill = 0;
+
+    // to the analysis
+    push_window( );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: play_frames()
+// desc: (callback) 'frames' interleaved frames out as stereo, through the
+//       preview delay (if any) a frame at a time
+//-----------------------------------------------------------------------------
+void play_frames( const SAMPLE * in, long frames, SAMPLE * out )
+{
+    for( long i = 0; i < frames; i++ )
+    {
+        const SAMPLE * frame = in + i * g_channels;
+        SAMPLE left = frame[0], right = g_channels > 1 ? frame[1] : frame[0];
+
+        if( g_waveforms != NULL )
+        {
+            // in now, out of the next slot: g_wf_delay - 1 windows later
+            SAMPLE * slot = g_waveforms[g_wf_index] + g_wf_fill * 2;
+            const SAMPLE * late = g_waveforms[(g_wf_index + 1) % g_wf_delay] + g_wf_fill * 2;
+            slot[0] = left;
+            slot[1] = right;
+            left = late[0];
+            right = late[1];
+            // on to the next slot
+            if( ++g_wf_fill == g_buffer_size )
+            {
+                g_wf_fill = 0;
+                g_wf_index = (g_wf_index + 1) % g_wf_delay;
+            }
+        }
+
+        out[i*2] = left;
+        out[i*2+1] = right;
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: window_mono() / window_multi()
+// desc: a queued window's mono and interleaved samples, after its header
+//-----------------------------------------------------------------------------
+inline SAMPLE * window_mono( unsigned char * window )
+{
+    return (SAMPLE *)( window + sizeof(AudioWindow) );
+}
+
+inline SAMPLE * window_multi( unsigned char * window )
+{
+    return window_mono( window ) + g_buffer_size;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: initialize_windows()
+// desc: the window queue, once the rate and channels are known
+//-----------------------------------------------------------------------------
+bool initialize_windows( )
+{
+    unsigned long count = (unsigned long)( SND_WINDOW_QUEUE * g_srate / g_buffer_size );
+    if( count < SND_MIN_WINDOWS ) count = SND_MIN_WINDOWS;
+
+    g_window_size = sizeof(AudioWindow) + g_buffer_size * ( 1 + g_channels ) * sizeof(SAMPLE);
+    g_window_in = new unsigned char[g_window_size];
+    g_window_out = new unsigned char[g_window_size];
+    memset( g_window_in, 0, g_window_size );
+    memset( g_window_out, 0, g_window_size );
+
+#if defined(__OS_WINDOWS__) && !defined(__WINDOWS_PTHREAD__)
+    // (auto-reset: a wake with no one waiting isn't lost)
+    if( !( g_window_event = CreateEvent( NULL, FALSE, FALSE, NULL ) ) )
+        return false;
+#endif
+
+    return g_windows.initialize( count, g_window_size );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: push_window()
+// desc: the whole window in g_audio_buffer / g_multi_buffer, at g_audio_pos,
+//       to the analysis (counted if there's no room for it)
+//-----------------------------------------------------------------------------
+void push_window( )
+{
+    AudioWindow * window = (AudioWindow *)g_window_in;
+
+    window->pos = g_audio_pos;
+    window->seeking = g_seeking;
+    window->restart = g_rows_restart;
+    memcpy( window_mono( g_window_in ), g_audio_buffer, g_buffer_size * sizeof(SAMPLE) );
+    memcpy( window_multi( g_window_in ), g_multi_buffer,
+            g_buffer_size * g_channels * sizeof(SAMPLE) );
+
+    // (a restart that doesn't fit waits for the next window)
+    if( g_windows.put( g_window_in, 1 ) )
+        g_rows_restart = FALSE;
+    else
+        g_windows_dropped++;
+
+    wake_analysis( );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: wake_analysis()
+// desc: a window is queued (or the analysis is to stop)
+//-----------------------------------------------------------------------------
+void wake_analysis( )
+{
+#if defined(__OS_WINDOWS__) && !defined(__WINDOWS_PTHREAD__)
+    if( g_window_event ) SetEvent( g_window_event );
+#else
+    pthread_mutex_lock( &g_window_lock );
+    pthread_cond_signal( &g_window_cond );
+    pthread_mutex_unlock( &g_window_lock );
+#endif
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: wait_window()
+// desc: sleeps until a window is queued (or the analysis is to stop)
+//-----------------------------------------------------------------------------
+void wait_window( )
+{
+#if defined(__OS_WINDOWS__) && !defined(__WINDOWS_PTHREAD__)
+    while( !g_windows.readable() && !g_analysis_stop )
+        WaitForSingleObject( g_window_event, INFINITE );
+#else
+    pthread_mutex_lock( &g_window_lock );
+    while( !g_windows.readable() && !g_analysis_stop )
+        pthread_cond_wait( &g_window_cond, &g_window_lock );
+    pthread_mutex_unlock( &g_window_lock );
+#endif
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: read_ahead_thread()
+// desc: decodes the file into g_read_ring ahead of the audio callback
+//-----------------------------------------------------------------------------
+THREAD_RETURN THREAD_TYPE read_ahead_thread( void * data )
+{
+    // frames per read
+    sf_count_t chunk = g_buffer_size;
+    // decode buffer (native channel count)
+    SAMPLE * buffer = new SAMPLE[chunk * g_sf_info.channels];
+    // last seek request serviced
+    GLuint seek = g_seek_ack;
+    sf_count_t count;
+
+    while( !g_read_stop )
+    {
+        // restart requested by the callback
+        if( seek != g_seek_request )
+        {
+            seek = g_seek_request;
+            // set playback position to begin
+            sf_seek( g_sf, (sf_count_t)(g_begintime * g_srate), SEEK_SET );
+            g_read_eof = FALSE;
+            // everything before this position is stale
+            g_seek_flush = g_read_ring.write_pos();
+            // publish flush position before the ack
+            RingBuffer::fence();
+            g_seek_ack = seek;
+        }
+
+        // keep the ring topped up
+        if( !g_read_eof && g_read_ring.writable() >= (unsigned long)chunk )
+        {
+            count = sf_readf_float( g_sf, buffer, chunk );
+            if( count > 0 )
+                g_read_ring.put( buffer, (unsigned long)count );
+            // publish the data before the end of file
+            if( count < chunk )
+            {
+                RingBuffer::fence();
+                g_read_eof = TRUE;
+            }
+        }
+        else
+        {
+            // full (or done): wait for the callback to drain some
+            usleep( 2000 );
+        }
+    }
+
+    delete [] buffer;
+
+    RingBuffer::fence();
+    g_read_done = TRUE;
+
+    return 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: start_read_ahead()
+// desc: allocates the read-ahead ring and starts the reader thread
+//-----------------------------------------------------------------------------
+bool start_read_ahead( )
+{
+    // at least a few callback buffers worth
+    unsigned long frames = (unsigned long)(g_read_ahead * g_sf_info.samplerate);
+    if( frames < (unsigned long)g_buffer_size * 4 )
+        frames = g_buffer_size * 4;
+
+    // one element per (multichannel) frame
+    if( !g_read_ring.initialize( frames, g_sf_info.channels * sizeof(SAMPLE) ) )
+        return false;
+
+    // set initial position
+    sf_seek( g_sf, (sf_count_t)(g_begintime * g_sf_info.samplerate), SEEK_SET );
+
+    // go
+    if( !g_read_thread.start( read_ahead_thread, NULL ) )
+        return false;
+
+    // 'q' and friends exit() from anywhere
+    atexit( stop_read_ahead );
+    return true;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: stop_read_ahead()
+// desc: quiets the callback, lets the reader finish, then closes the file
+//       and frees the ring (at exit)
+//-----------------------------------------------------------------------------
+void stop_read_ahead( )
+{
+    // the callback copies out of the ring
+    if( g_audio && g_audio->isStreamRunning() )
+    {
+        try { g_audio->stopStream(); }
+        catch( RtError & e ) { }
+    }
+
+    g_read_stop = TRUE;
+    while( !g_read_done )
+        usleep( 1000 );
+
+    sf_close( g_sf );
+    g_sf = NULL;
+    g_read_ring.cleanup();
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: write_ppm()
+// desc: writes the current color buffer to a binary PPM
+//-----------------------------------------------------------------------------
+bool write_ppm( const char * path, GLint w, GLint h, unsigned char * pixels )
+{
+    FILE * fp = fopen( path, "wb" );
+    if( !fp )
+        return false;
+
+    glPixelStorei( GL_PACK_ALIGNMENT, 1 );
+    glReadPixels( 0, 0, w, h, GL_RGB, GL_UNSIGNED_BYTE, pixels );
+
+    // GL rows go bottom up, PPM rows top down
+    fprintf( fp, "P6\n%d %d\n255\n", w, h );
+    for( GLint y = h - 1; y >= 0; y-- )
+        fwrite( pixels + y * w * 3, 1, w * 3, fp );
+
+    bool ok = !ferror( fp );
+    fclose( fp );
+    return ok;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: read_window()
+// desc: slides g_multi_buffer (all channels) along the file from 'pos' to
+//       'target' (so its last frame is the one before 'target')
+//-----------------------------------------------------------------------------
+void read_window( long & pos, long target )
+{
+    GLint ch = g_channels;
+
+    // skip what no window will see
+    if( target - pos > g_buffer_size )
+    {
+        pos = target - g_buffer_size;
+        sf_seek( g_sf, pos < g_sf_info.frames ? pos : g_sf_info.frames, SEEK_SET );
+    }
+
+    // slide the window along by what's new
+    long n = target - pos, got = 0;
+    SAMPLE * fresh = g_multi_buffer + (g_buffer_size - n) * ch;
+    memmove( g_multi_buffer, g_multi_buffer + n * ch, (g_buffer_size - n) * ch * sizeof(SAMPLE) );
+    if( pos < g_sf_info.frames )
+        got = sf_readf_float( g_sf, fresh, n );
+    memset( fresh + got * ch, 0, (n - got) * ch * sizeof(SAMPLE) );
+    pos = target;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: render_offline()
+// desc: headless mode - reads the file at a fixed frame rate (not the audio
+//       clock), renders each frame with displayFunc() into an offscreen
+//       buffer and writes it out as <prefix>NNNNNN.ppm
+//-----------------------------------------------------------------------------
+int render_offline( )
+{
+#if defined(__SNDPEEK_OSMESA__)
+    GLint w = g_width, h = g_height, ch = g_channels;
+    // offscreen color buffer
+    unsigned char * color = new unsigned char[w * h * 4];
+    unsigned char * pixels = new unsigned char[w * h * 3];
+    char path[1024];
+    long k, pos, target, start = (long)(g_begintime * g_srate);
+    // to the end of the file, then let the preview delay drain
+    long total = (long)( ( g_sf_info.frames - start ) * (double)g_render_fps / g_srate + .999 ) + g_wf_delay;
+
+    // software GL context with a depth buffer
+    OSMesaContext ctx = OSMesaCreateContextExt( OSMESA_RGBA, 16, 0, 0, NULL );
+    if( !ctx || !OSMesaMakeCurrent( ctx, color, GL_UNSIGNED_BYTE, w, h ) )
+    {
+        fprintf( stderr, "[sndpeek]: error: cannot create offscreen context...\n" );
+        return -4;
+    }
+
+    // same setup as the window
+    initialize_graphics( );
+    reshapeFunc( w, h );
+    hanning( g_window, g_buffer_size );
+
+    fprintf( stderr, "[sndpeek]: rendering %s to %s*.ppm (%dx%d @ %.2f fps)...\n",
+             g_filename, g_render_prefix, w, h, g_render_fps );
+
+    // the newest window of each frame ends at the frame's time
+    pos = start;
+    sf_seek( g_sf, pos, SEEK_SET );
+    memset( g_multi_buffer, 0, g_buffer_size * ch * sizeof(SAMPLE) );
+    for( k = 0; k < total && g_running; k++ )
+    {
+        target = start + (long)( (k + 1) * (double)g_srate / g_render_fps + .5 );
+
+        // slide the window (all channels) along by what's new
+        read_window( pos, target );
+
+        // newest stereo and mono, before any preview delay
+        split_channels( g_multi_buffer, g_buffer_size, ch );
+
+        // where this frame's window starts, as the callback would see it
+        g_play_pos = pos;
+        g_audio_pos = pos - g_buffer_size;
+
+        // preview delay is counted in frames here
+        if( g_waveforms != NULL )
+        {
+            memcpy( g_waveforms[g_wf_index], g_stereo_buffer, g_buffer_size * 2 * sizeof(SAMPLE) );
+            g_wf_index = (g_wf_index + 1) % g_wf_delay;
+            memcpy( g_stereo_buffer, g_waveforms[g_wf_index], g_buffer_size * 2 * sizeof(SAMPLE) );
+        }
+
+        // draw (analyzing this window)
+        push_window( );
+        displayFunc( );
+        glFinish( );
+
+        // write
+        sprintf( path, "%s%06ld.ppm", g_render_prefix, k );
+        if( !write_ppm( path, w, h, pixels ) )
+        {
+            fprintf( stderr, "[sndpeek]: error: cannot write '%s'...\n", path );
+            break;
+        }
+    }
+
+    fprintf( stderr, "[sndpeek]: rendered %ld frames...\n", k );
+
+    OSMesaDestroyContext( ctx );
+    delete [] pixels;
+    delete [] color;
+    return 0;
+#else
+    return -4;
+#endif
+}
+
+
+
+
 //-----------------------------------------------------------------------------
 // Name: initialize_audio( )
 // Desc: set up audio capture and playback and initializes any application data
@@ -787,6 +2072,40 @@ bool initialize_audio( )
         // set srate from the WvIn
         fprintf( stderr, "[sndpeek]: setting sample rate to %d\n", g_srate );
         g_srate = g_sf_info.samplerate;
+
+        // analysis cache (replaces the audio delay line for preview)
+        if( g_use_cache && g_multi )
+            fprintf( stderr, "[sndpeek]: warning: STFT cache only holds the downmix, analyzing live...\n" );
+        else if( g_use_cache )
+        {
+            // (opened again: the last file's goes first)
+            stft_cache_close( g_cache );
+            g_cache = stft_cache_open( g_filename, g_cache_file, g_buffer_size,
+                                       g_fft_size, g_buffer_size );
+            if( !g_cache )
+                fprintf( stderr, "[sndpeek]: warning: cannot use STFT cache, analyzing live...\n" );
+        }
+
+        // decode ahead of the audio callback
+        if( g_sndout && !start_read_ahead() )
+        {
+            fprintf( stderr, "[sndpeek]: error: cannot start read-ahead thread...\n" );
+            return false;
+        }
+    }
+    else if( g_stdin_format >= 0 )
+    {
+        // the header of a WAV stream arrives here
+        g_stdin = pcm_stream_open( stdin, g_stdin_format, g_srate, g_stdin_channels );
+        if( !g_stdin )
+        {
+            fprintf( stderr, "[sndpeek]: error: cannot read PCM from stdin...\n" );
+            return false;
+        }
+        g_srate = pcm_stream_srate( g_stdin );
+        g_wf_delay = 0;
+        fprintf( stderr, "[sndpeek]: reading stdin (%i channel(s) at %i Hz)...\n",
+                 pcm_stream_channels( g_stdin ), g_srate );
     }
     else
     {
@@ -794,8 +2113,20 @@ bool initialize_audio( )
         g_wf_delay = 0;
     }
 
+    // every channel of the input, before the callback can run
+    g_channels = g_filename ? g_sf_info.channels :
+                 g_stdin ? pcm_stream_channels( g_stdin ) : g_sndin;
+    g_multi_buffer = new_samples( g_buffer_size * g_channels );
+    if( !g_multi_buffer || !initialize_windows() )
+    {
+        fprintf( stderr, "[sndpeek]: error: cannot allocate %i channel buffers...\n", g_channels );
+        return false;
+    }
+    if( g_multi )
+        fprintf( stderr, "[sndpeek]: analyzing %i channel(s)...\n", g_channels );
+
     // make sound
-    if( !g_filename || g_sndout )
+    if( ( !g_filename && !g_stdin ) || g_sndout )
     {
         // initialize rtaudio
         try
@@ -835,13 +2166,11 @@ bool initialize_audio( )
             
             // open a stream
             g_audio->openStream( &oParams, &iParams, RTAUDIO_FLOAT32, g_srate, &bufsize, &cb, (void *)&bufferBytes, &options );            
-            // test
+            // the callback builds --winsize windows out of whatever the
+            // device settled on
             if( bufsize != g_buffer_size )
-            {
-                // potential problem
-                fprintf( stderr, "[sndpeek]: warning: using different buffer sizes: %i : %i\n",
+                fprintf( stderr, "[sndpeek]: device buffer is %i frames, windows are %i...\n",
                          bufsize, g_buffer_size );
-            }
             // compute
             bufferBytes = bufferFrames * 2 * sizeof(SAMPLE);
             
@@ -859,9 +2188,16 @@ bool initialize_audio( )
 
     // make the transform window
     hanning( g_window, g_buffer_size );
+
+    // per-channel analysis
+    if( g_multi && !g_analyzer.initialize( g_channels, g_buffer_size, g_fft_size, g_window ) )
+    {
+        fprintf( stderr, "[sndpeek]: error: cannot initialize %i channel analysis...\n", g_channels );
+        return false;
+    }
     
-    // initialize
-    if( g_wf_delay )
+    // initialize (not needed when previewing from the cache)
+    if( g_wf_delay && !g_cache )
     {
         g_waveforms = new SAMPLE *[g_wf_delay];
         for( int i = 0; i < g_wf_delay; i++ )
@@ -883,25 +2219,17 @@ bool initialize_audio( )
 // Name: initialize_analysis( )
 // Desc: sets initial audio analysis parameters
 //-----------------------------------------------------------------------------
-void initialize_analysis( )
+bool initialize_analysis( )
 {
-    // spectral centroid
-    g_centroid = new Centroid( SND_MARSYAS_SIZE );
     // down sampler
     g_down_sampler = new DownSampler( g_buffer_size, 2 );
-    // flux
-    g_flux = new Flux( SND_MARSYAS_SIZE );
-    // lpc
-    g_lpc = new LPC( SND_MARSYAS_SIZE );
-    g_lpc->init();
-    // mfcc
-    g_mfcc = new MFCC( SND_MARSYAS_SIZE, 0 );
-    g_mfcc->init();
-    // rms
-    g_rms = new RMS( SND_MARSYAS_SIZE );
-    // rolloff
-    g_rolloff = new Rolloff( SND_MARSYAS_SIZE, 0.5f );
-    g_rolloff2 = new Rolloff( SND_MARSYAS_SIZE, 0.8f );
+    // centroid, flux, lpc, mfcc, rms, rolloff
+    if( !g_stream.initialize( g_buffer_size ) )
+        return false;
+    // timed into the instrumentation
+    g_stream.set_stats( g_stats + STAT_FFT );
+
+    return true;
 }
 
 
@@ -946,14 +2274,34 @@ void initialize_graphics()
     // glEnable( GL_BLEND );
 
     // initialize
-    g_spectrums = new Pt2D *[g_depth];
-    for( int i = 0; i < g_depth; i++ )
+    g_hist_bins = g_fft_size / g_freq_view;
+    g_history = malloc( g_depth * g_hist_bins * (g_hist_bits/8) );
+    g_hist_row = new GLfloat[g_hist_bins];
+    if( !g_history )
     {
-        g_spectrums[i] = new Pt2D[SND_FFT_SIZE];
-        memset( g_spectrums[i], 0, sizeof(Pt2D)*SND_FFT_SIZE );
+        fprintf( stderr, "[sndpeek]: cannot allocate history for depth %i...\n", g_depth );
+        exit( 1 );
     }
+    clear_history();
     g_draw = new GLboolean[g_depth];
     memset( g_draw, 0, sizeof(GLboolean)*g_depth );
+    g_draw_depth = g_depth;
+
+    // analysis -> display
+    g_row_size = sizeof(DisplayRow) + ( g_buffer_size + g_fft_size / 2 ) * sizeof(SAMPLE);
+    g_row_in = new unsigned char[g_row_size];
+    g_row_out = new unsigned char[g_row_size];
+    memset( g_row_in, 0, g_row_size );
+    memset( g_row_out, 0, g_row_size );
+    if( !g_rows.initialize( SND_DISPLAY_ROWS, g_row_size ) )
+    {
+        fprintf( stderr, "[sndpeek]: cannot allocate display rows...\n" );
+        exit( 1 );
+    }
+
+    // waterfall vertex buffer
+    if( g_use_vbo && !initialize_vbo() )
+        fprintf( stderr, "[sndpeek]: vertex buffers not available, drawing immediate mode...\n" );
 
     // compute log spacing
     if( g_use_log )
@@ -968,45 +2316,212 @@ void initialize_graphics()
 
 
 //-----------------------------------------------------------------------------
-// Name: reshapeFunc( )
-// Desc: called when window size changes
+// Name: initialize_vbo( )
+// Desc: allocates the waterfall vertex buffer, if the GL has them
 //-----------------------------------------------------------------------------
-void reshapeFunc( int w, int h )
+bool initialize_vbo( )
 {
-    // save the new window size
-    g_width = w; g_height = h;
-    // map the view port to the client area
-    glViewport( 0, 0, w, h );
-    // set the matrix mode to project
-    glMatrixMode( GL_PROJECTION );
-    // load the identity matrix
-    glLoadIdentity( );
-    // create the viewing frustum
-    gluPerspective( 45.0, (GLfloat) w / (GLfloat) h, 1.0, 300.0 );
-    // set the matrix mode to modelview
-    glMatrixMode( GL_MODELVIEW );
-    // load the identity matrix
-    glLoadIdentity( );
-    // position the view point
-    gluLookAt( 0.0f, 3.5f * sin( g_eye_y ), 3.5f * cos( g_eye_y ), 
-               0.0f, 0.0f, 0.0f, 
-               0.0f, ( cos( g_eye_y ) < 0 ? -1.0f : 1.0f ), 0.0f );
+#ifdef __SNDPEEK_VBO__
+    // buffer objects are core in 1.5
+    const char * version = (const char *)glGetString( GL_VERSION );
+    const char * ext = (const char *)glGetString( GL_EXTENSIONS );
+    int major = 0, minor = 0;
+    if( version ) sscanf( version, "%d.%d", &major, &minor );
+    if( major < 1 || ( major == 1 && minor < 5 ) )
+    {
+        if( !ext || !strstr( ext, "GL_ARB_vertex_buffer_object" ) )
+            return false;
+    }
 
-    // set the position of the lights
-    glLightfv( GL_LIGHT0, GL_POSITION, g_light0_pos );
-    glLightfv( GL_LIGHT1, GL_POSITION, g_light1_pos );
+    // one layer of (x,y) per waterfall row
+    g_vbo_stride = g_fft_size / g_freq_view;
+    g_vbo_staging = new GLfloat[g_vbo_stride * 2];
+    g_vbo_counts = new GLint[g_depth];
+    memset( g_vbo_counts, 0, sizeof(GLint) * g_depth );
+
+    glGenBuffers( 1, &g_vbo );
+    glBindBuffer( GL_ARRAY_BUFFER, g_vbo );
+    glBufferData( GL_ARRAY_BUFFER, g_depth * g_vbo_stride * 2 * sizeof(GLfloat),
+                  NULL, GL_DYNAMIC_DRAW );
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
+
+    if( glGetError() != GL_NO_ERROR )
+    {
+        glDeleteBuffers( 1, &g_vbo );
+        g_vbo = 0;
+        return false;
+    }
+
+    g_vbo_ok = TRUE;
+    g_vbo_dirty = TRUE;
+    return true;
+#else
+    return false;
+#endif
 }
 
 
 
 
 //-----------------------------------------------------------------------------
-// Name: keyboardFunc( )
-// Desc: key event
+// Name: upload_spectrum_row( )
+// Desc: copies one waterfall layer into its slot in the vertex buffer
 //-----------------------------------------------------------------------------
-void keyboardFunc( unsigned char key, int x, int y )
+void upload_spectrum_row( GLint row )
 {
-    switch( key )
+#ifdef __SNDPEEK_VBO__
+    const GLfloat * xs, * ys;
+    GLint n = get_layer_vertices( row, &xs, &ys );
+    GLfloat * v = g_vbo_staging;
+
+    // same vertices the immediate mode path would draw
+    for( GLint j = 0; j < n; j++ )
+    {
+        *v++ = xs[j];
+        *v++ = ys[j];
+    }
+    g_vbo_counts[row] = n;
+
+    glBindBuffer( GL_ARRAY_BUFFER, g_vbo );
+    glBufferSubData( GL_ARRAY_BUFFER, row * g_vbo_stride * 2 * sizeof(GLfloat),
+                     n * 2 * sizeof(GLfloat), g_vbo_staging );
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
+#endif
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// Name: get_layer_vertices( )
+// Desc: the vertices to draw for one waterfall layer: left trim applied,
+//       reduced to the columns it covers (valid until the next call)
+//-----------------------------------------------------------------------------
+GLint get_layer_vertices( GLint row, const GLfloat ** xs, const GLfloat ** ys )
+{
+    const GLfloat * pt = get_history_row( row );
+    GLint n = g_hist_bins;
+
+    // trimmed bins sit on the baseline
+    for( GLint j = 0; j < n; j++ )
+        g_lod_in[j] = (double)j/n >= g_left_trim ? pt[j] : -1.0f;
+
+    if( !g_use_lod )
+    {
+        *xs = g_log_positions;
+        *ys = g_lod_in;
+        return n;
+    }
+
+    *xs = g_lod_x;
+    *ys = g_lod_y;
+    return lod_minmax( g_log_positions, g_lod_in, n, g_lod_columns, g_lod_x, g_lod_y );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// Name: lod_columns( )
+// Desc: pixels between two points under the current transform
+//-----------------------------------------------------------------------------
+GLint lod_columns( GLfloat x0, GLfloat y0, GLfloat z0, GLfloat x1, GLfloat y1, GLfloat z1 )
+{
+    GLdouble model[16], proj[16];
+    GLint view[4];
+    GLdouble ax, ay, az, bx, by, bz;
+
+    glGetDoublev( GL_MODELVIEW_MATRIX, model );
+    glGetDoublev( GL_PROJECTION_MATRIX, proj );
+    glGetIntegerv( GL_VIEWPORT, view );
+
+    if( !gluProject( x0, y0, z0, model, proj, view, &ax, &ay, &az ) ||
+        !gluProject( x1, y1, z1, model, proj, view, &bx, &by, &bz ) )
+        return 0;
+
+    // at least one column, and nothing silly when behind the eye
+    double w = ::sqrt( (bx-ax)*(bx-ax) + (by-ay)*(by-ay) );
+    if( w < 1 ) w = 1;
+    if( w > g_fft_size ) w = g_fft_size;
+
+    return (GLint)( w + .999 );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// Name: update_waterfall_lod( )
+// Desc: columns for the waterfall layers, from the widest (nearest) layer;
+//       rounded to a power of two so the layers aren't re-decimated while
+//       the view drifts
+//-----------------------------------------------------------------------------
+void update_waterfall_lod( )
+{
+    GLint n = g_fft_size / g_freq_view, w, cols = 1;
+
+    glPushMatrix();
+    // same transform as the layers
+    glTranslatef( -1.8f, 0.0f, g_z );
+    glScalef( 3.6f / g_fft_size * g_freq_view, 1.0f, -g_space );
+    w = lod_columns( g_log_positions[0], -1, 0, g_log_positions[n-1], -1, 0 );
+    GLint wb = lod_columns( g_log_positions[0], -1, g_depth, g_log_positions[n-1], -1, g_depth );
+    if( wb > w ) w = wb;
+    glPopMatrix();
+
+    while( cols < w ) cols <<= 1;
+
+    // grow right away, shrink only well past the next size down
+    if( cols > g_lod_columns || w < g_lod_columns * 2 / 5 )
+    {
+        g_lod_columns = cols;
+        g_vbo_dirty = TRUE;
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// Name: reshapeFunc( )
+// Desc: called when window size changes
+//-----------------------------------------------------------------------------
+void reshapeFunc( int w, int h )
+{
+    // save the new window size
+    g_width = w; g_height = h;
+    // map the view port to the client area
+    glViewport( 0, 0, w, h );
+    // set the matrix mode to project
+    glMatrixMode( GL_PROJECTION );
+    // load the identity matrix
+    glLoadIdentity( );
+    // create the viewing frustum
+    gluPerspective( 45.0, (GLfloat) w / (GLfloat) h, 1.0, 300.0 );
+    // set the matrix mode to modelview
+    glMatrixMode( GL_MODELVIEW );
+    // load the identity matrix
+    glLoadIdentity( );
+    // position the view point
+    gluLookAt( 0.0f, 3.5f * sin( g_eye_y ), 3.5f * cos( g_eye_y ), 
+               0.0f, 0.0f, 0.0f, 
+               0.0f, ( cos( g_eye_y ) < 0 ? -1.0f : 1.0f ), 0.0f );
+
+    // set the position of the lights
+    glLightfv( GL_LIGHT0, GL_POSITION, g_light0_pos );
+    glLightfv( GL_LIGHT1, GL_POSITION, g_light1_pos );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// Name: keyboardFunc( )
+// Desc: key event
+//-----------------------------------------------------------------------------
+void keyboardFunc( unsigned char key, int x, int y )
+{
+    switch( key )
     {
     case 'j':
         g_z += g_dz;
@@ -1112,6 +2627,18 @@ void keyboardFunc( unsigned char key, int x, int y )
             fprintf( stderr, "[sndpeek]: restarting file...\n" );
         }
     break;
+    case '{':
+    case '}':
+        if( g_sf )
+        {
+            // what is being heard now (behind the preview delay, if any)
+            GLfloat now = ( g_play_pos - (g_waveforms ? g_wf_delay * g_buffer_size : 0) ) / (GLfloat)g_srate;
+            g_begintime = now + ( key == '{' ? -5.0f : 5.0f );
+            if( g_begintime < 0 ) g_begintime = 0;
+            g_restart = TRUE;
+            fprintf( stderr, "[sndpeek]: seeking to %.1f seconds...\n", g_begintime );
+        }
+    break;
     case '2':
         g_lissajous = !g_lissajous;
         fprintf( stderr, "[sndpeek]: lissajous:%s\n", g_lissajous ? "ON" : "OFF" );
@@ -1177,6 +2704,24 @@ void keyboardFunc( unsigned char key, int x, int y )
         g_rainbow = !g_rainbow;
         fprintf( stderr, "[sndpeek]: fallcolors:%s\n", g_rainbow ? "ON" : "OFF" );
     break;
+    case 'o':
+        g_show_stats = !g_show_stats;
+        fprintf( stderr, "[sndpeek]: hud:%s\n", g_show_stats ? "ON" : "OFF" );
+    break;
+    case 'n':
+        // the cache only has the downmix
+        if( g_cache )
+        {
+            fprintf( stderr, "[sndpeek]: view: single channels need --cache:OFF\n" );
+            break;
+        }
+        // -1 (summed), 0 .. g_channels-1
+        g_view_channel = g_view_channel + 1 < g_channels ? g_view_channel + 1 : -1;
+        if( g_view_channel < 0 )
+            fprintf( stderr, "[sndpeek]: view: all channels\n" );
+        else
+            fprintf( stderr, "[sndpeek]: view: channel %i\n", g_view_channel );
+    break;
     case 't':
         g_show_time = !g_show_time; 
         fprintf( stderr, "[sndpeek]: show time:%s\n", g_show_time ? "ON" : "OFF" ); 
@@ -1267,6 +2812,8 @@ void keyboardFunc( unsigned char key, int x, int y )
         fprintf( stderr, "[sndpeek]: dB:%s\n", g_usedb ? "ON" : "OFF" );
         fprintf( stderr, "[sndpeek]: mute:%s\n", g_mute ? "ON" : "OFF" );
         fprintf( stderr, "[sndpeek]: showtime:%s\n", g_show_time ? "ON" : "OFF" ); 
+        fprintf( stderr, "[sndpeek]: vbo:%s\n", g_vbo_ok ? "ON" : "OFF" );
+        fprintf( stderr, "[sndpeek]: lod:%s (%i columns)\n", g_use_lod ? "ON" : "OFF", g_lod_columns );
         fprintf( stderr, "[sndpeek]: freeze:%s\n", g_freeze ? "ON" : "OFF" ); 
         fprintf( stderr, "[sndpeek]: timescale:%f\n", g_time_scale ); 
         fprintf( stderr, "[sndpeek]: freqscale:%f\n", g_freq_scale );
@@ -1279,12 +2826,17 @@ void keyboardFunc( unsigned char key, int x, int y )
         fprintf( stderr, "[sndpeek]: dzpos:%f\n", g_dz ); 
         fprintf( stderr, "[sndpeek]: spacing:%f\n", g_space );
         fprintf( stderr, "[sndpeek]: yview:%f\n", g_eye_y );
-        fprintf( stderr, "[sndpeek]: depth:%i\n", g_depth );
+        fprintf( stderr, "[sndpeek]: winsize:%i fftsize:%i\n", g_buffer_size, g_fft_size );
+        fprintf( stderr, "[sndpeek]: channels:%i%s (view: %i, -1 is all)\n", g_channels,
+                 g_multi ? " analyzed separately" : "", g_view_channel );
+        fprintf( stderr, "[sndpeek]: depth:%i (history: %i-bit, %.1f KB)\n", g_depth, g_hist_bits,
+                 g_depth * g_hist_bins * (g_hist_bits/8) / 1024.0f );
         fprintf( stderr, "[sndpeek]: preview:%f (delay: %i)\n", g_wf_delay_ratio, g_wf_delay);
         fprintf( stderr, "[sndpeek]: rotatem:%f\n", g_inc_val_mouse );
         fprintf( stderr, "[sndpeek]: rotatek:%f\n", g_inc_val_kb * (INC_VAL_MOUSE/INC_VAL_KB) );
         fprintf( stderr, "[sndpeek]: begintime:%f (seconds)\n", g_begintime ); 
         fprintf( stderr, "[sndpeek]: ds:%i\n", g_ds ); 
+        fprintf( stderr, "[sndpeek]: readahead:%f (seconds, %i underruns)\n", g_read_ahead, g_read_underruns );
         fprintf( stderr, "----------------------------------------------------\n" );
     break;
     }
@@ -1341,168 +2893,913 @@ void idleFunc( )
 
 
 //-----------------------------------------------------------------------------
-// name: draw_string()
-// desc: ...
+// Name: timerFunc( )
+// Desc: callback from GLUT, once per frame at g_display_fps
+//-----------------------------------------------------------------------------
+void timerFunc( int value )
+{
+    static double next = 0;
+    double now = stats_now_usec(), period = 1e6 / g_display_fps;
+
+    // behind: drop the frames we missed instead of catching up
+    if( !next || now - next > period )
+    {
+        if( next )
+            g_frames_skipped += (unsigned long)( ( now - next ) / period );
+        next = now;
+    }
+    next += period;
+
+    // render the scene
+    glutPostRedisplay( );
+    // and again at the next frame
+    glutTimerFunc( (unsigned int)( ( next - now ) / 1000 ), timerFunc, 0 );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: draw_string()
+// desc: ...
+//-----------------------------------------------------------------------------
+void draw_string( GLfloat x, GLfloat y, GLfloat z, const char * str, GLfloat scale = 1.0f )
+{
+    GLint len = strlen( str ), i;
+
+    // glut isn't initialized when rendering offscreen: no fonts
+    if( g_headless )
+        return;
+
+    glPushMatrix();
+    glTranslatef( x, y, z );
+    glScalef( .001f * scale, .001f * scale, .001f * scale );
+
+    for( i = 0; i < len; i++ )
+        glutStrokeCharacter( GLUT_STROKE_ROMAN, str[i] );
+    
+    glPopMatrix();
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ...
+// desc: ...
+//-----------------------------------------------------------------------------
+void drawLissajous( SAMPLE * stereobuffer, int len, int channels)
+{
+    float x, y;
+    SAMPLE * buffer;
+    
+    // 1 or 2 channels only for now
+    assert( channels >= 1 && channels <= 2 );
+
+    // mono
+    if( channels == 1 )
+    {
+        buffer = g_cur_buffer; 
+        // convert to mono
+        for( int m = 0; m < len; m++)
+        {
+            buffer[m] = stereobuffer[m*2] + stereobuffer[m*2+1];
+            buffer[m] /= 2.0f;
+        }
+    }
+    else
+    {
+        buffer = stereobuffer;
+    }
+    
+    // color
+    glColor3f( 1.0f, 1.0f, .5f );
+    // save current matrix state
+    glPushMatrix();
+    // translate
+    glTranslatef( 1.2f, 0.0f, 0.0f );
+    // draw it
+    glBegin( GL_LINE_STRIP );
+    for( int i = 0; i < len * channels; i += channels )
+    {
+        x = buffer[i] * g_lissajous_scale;
+        if( channels == 1 )
+        {
+            // delay
+            y = (i - g_delay >= 0) ? buffer[i-g_delay] : g_back_buffer[len + i-g_delay]; 
+            y *= g_lissajous_scale;
+        }
+        else
+        {
+            y = buffer[i + channels-1] * g_lissajous_scale;
+        }
+
+        glVertex3f( x, y, 0.0f );
+        // glVertex3f( x, y, sqrt( x*x + y*y ) * -g_lissajous_scale );
+    }
+    glEnd();
+    // restore matrix state
+    glPopMatrix();
+    
+    // hmm...
+    if( channels == 1 )
+        memcpy( g_back_buffer, buffer, len * sizeof(SAMPLE) );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// Name: map_log_spacing( )
+// Desc: ...
+//-----------------------------------------------------------------------------
+inline double map_log_spacing( double ratio, double power )
+{
+    if( ratio <= g_left_trim ) ratio = 0;
+    else ratio = (ratio - g_left_trim) / (1.0 - g_left_trim);
+
+    // compute location
+    if( ratio < (1.0/g_fft_size) ) return 0; // g_centering/2 * g_zooming * g_fft_size/g_freq_view;
+    double offset = -log(1.0/g_fft_size);
+    return ((1-power)*ratio + (power)*(offset+log(ratio))/offset) * g_fft_size/g_freq_view;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// Name: map_pow_spacing( )
+// Desc: ...
+//-----------------------------------------------------------------------------
+inline double map_pow_spacing( double ratio, double power )
+{
+    if( ratio <= g_left_trim ) ratio = 0;
+    else ratio = (ratio - g_left_trim) / (1.0 - g_left_trim);
+
+    // compute location
+    return ::pow(ratio, power) * g_fft_size/g_freq_view;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// Name: compute_log_spacing( )
+// Desc: ...
+//-----------------------------------------------------------------------------
+double compute_log_spacing( int fft_size, double power )
+{
+    int maxbin = fft_size; // for future in case we want to draw smaller range
+    int minbin = 0; // what about adding this one?
+
+    for(int i = 0; i < fft_size; i++)
+    {
+        // compute location
+        g_log_positions[i] = map_log_spacing( (double)i/fft_size, power );
+        if( g_log_positions[i] < 0 )
+            fprintf( stderr, "%d %f\n", i, g_log_positions[i] );
+        // normalize, 1 if maxbin == fft_size
+        g_log_positions[i] /= pow((double)maxbin/fft_size, power);
+    }
+
+    // layers in the vertex buffer have stale x positions
+    g_vbo_dirty = TRUE;
+
+    return 1/::log(fft_size);
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// Name: compute_pow_spacing( )
+// Desc: ...
+//-----------------------------------------------------------------------------
+double compute_pow_spacing( int fft_size, double power )
+{
+    int maxbin = fft_size; // for future in case we want to draw smaller range
+    int minbin = 0; // what about adding this one?
+
+    for(int i = 0; i < fft_size; i++)
+    {
+        // compute location
+        g_log_positions[i] = map_pow_spacing( (double)i/fft_size, power );
+        // normalize, 1 if maxbin == fft_size
+        g_log_positions[i] /= pow((double)maxbin/fft_size, power);
+    }
+
+    // layers in the vertex buffer have stale x positions
+    g_vbo_dirty = TRUE;
+
+    return 1/::log(fft_size);
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// Name: fill_spectrum_row( )
+// Desc: magnitude spectrum -> one waterfall layer, in display coordinates
+//-----------------------------------------------------------------------------
+void fill_spectrum_row( GLint row, const SAMPLE * mag )
+{
+    GLfloat y = -1.0f, v;
+    // quantization step
+    GLfloat levels = (GLfloat)( (1 << g_hist_bits) - 1 );
+    GLfloat scale = levels / ( SND_HIST_Y_MAX - SND_HIST_Y_MIN );
+    unsigned char * q8 = (unsigned char *)g_history + row * g_hist_bins;
+    unsigned short * q16 = (unsigned short *)g_history + row * g_hist_bins;
+
+    for( GLint i = 0; i < g_hist_bins; i++ )
+    {
+        // y, depending on scaling
+        if( !g_usedb ) {
+            v = g_gain * g_freq_scale * 1.8f *
+                ::pow( 25 * mag[i] * g_mag_norm, .5 ) + y;
+        } else {
+            v = g_gain * g_freq_scale * 
+                ( 20.0f * log10( mag[i] * g_mag_norm / 8.0 ) + 80.0f ) / 80.0f + y + .5f;
+        }
+        // quantize (log10(0) is -inf, clamps to the bottom)
+        v = ( v - SND_HIST_Y_MIN ) * scale + .5f;
+        if( !( v > 0 ) ) v = 0;
+        else if( v > levels ) v = levels;
+        if( g_hist_bits == 8 ) q8[i] = (unsigned char)v;
+        else q16[i] = (unsigned short)v;
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// Name: get_history_row( )
+// Desc: dequantize one waterfall layer (valid until the next call)
+//-----------------------------------------------------------------------------
+const GLfloat * get_history_row( GLint row )
+{
+    GLfloat step = ( SND_HIST_Y_MAX - SND_HIST_Y_MIN ) / ( (1 << g_hist_bits) - 1 );
+    const unsigned char * q8 = (const unsigned char *)g_history + row * g_hist_bins;
+    const unsigned short * q16 = (const unsigned short *)g_history + row * g_hist_bins;
+
+    if( g_hist_bits == 8 )
+        for( GLint i = 0; i < g_hist_bins; i++ )
+            g_hist_row[i] = SND_HIST_Y_MIN + q8[i] * step;
+    else
+        for( GLint i = 0; i < g_hist_bins; i++ )
+            g_hist_row[i] = SND_HIST_Y_MIN + q16[i] * step;
+
+    return g_hist_row;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// Name: clear_history( )
+// Desc: every layer back to zero magnitude (the baseline)
+//-----------------------------------------------------------------------------
+void clear_history( )
+{
+    if( !g_history ) return;
+
+    // baseline is y = -1
+    GLfloat v = ( -1.0f - SND_HIST_Y_MIN ) * ( (1 << g_hist_bits) - 1 )
+                / ( SND_HIST_Y_MAX - SND_HIST_Y_MIN ) + .5f;
+    long n = (long)g_depth * g_hist_bins;
+
+    if( g_hist_bits == 8 )
+        memset( g_history, (unsigned char)v, n );
+    else
+    {
+        // fill the first layer, copy it over the rest of the ring
+        unsigned short * q16 = (unsigned short *)g_history;
+        for( GLint i = 0; i < g_hist_bins; i++ )
+            q16[i] = (unsigned short)v;
+        for( GLuint r = 1; r < g_depth; r++ )
+            memcpy( q16 + r * g_hist_bins, q16, g_hist_bins * sizeof(unsigned short) );
+    }
+
+    g_vbo_dirty = TRUE;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// Name: view_value( )
+// Desc: a per-channel feature for the channel on view (or the channel mean)
+//-----------------------------------------------------------------------------
+inline float view_value( const float * values )
+{
+    if( g_view_channel >= 0 )
+        return values[g_view_channel];
+
+    float sum = 0;
+    for( GLint c = 0; c < g_channels; c++ )
+        sum += values[c];
+    return sum / g_channels;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// Name: replay_value( )
+// Desc: a recorded feature for the channel on view (or the channel mean)
+//-----------------------------------------------------------------------------
+inline float replay_value( GLint column )
+{
+    const feature_header * h = feature_reader_header( g_replay_feat );
+    GLint C = h->channels;
+
+    if( g_view_channel >= 0 && g_view_channel < C )
+        return g_replay_values[g_view_channel * h->columns + column];
+
+    float sum = 0;
+    for( GLint c = 0; c < C; c++ )
+        sum += g_replay_values[c * h->columns + column];
+    return sum / C;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// Name: feature_output( )
+// Desc: anyone taking features?
+//-----------------------------------------------------------------------------
+inline bool feature_output( )
+{
+    return g_stdout || g_feat_writer || g_shm || g_socket || g_recorder;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// Name: output_features( )
+// Desc: one frame of features (of one channel, if channel >= 0): a binary
+//       record, or a line of text on stdout prefixed "chN"
+//-----------------------------------------------------------------------------
+void output_features( GLint channel, double time, float centroid, float flux,
+                      float rms, float rolloff, float rolloff2, fvec & mfcc )
+{
+    // time, channel, then the same columns as open_feature_output() names
+    static fvec bus(SND_BUS_SIZE);
+    float * values = bus.getData() + 2;
+
+    values[0] = centroid; values[1] = flux; values[2] = rms;
+    values[3] = rolloff; values[4] = rolloff2;
+    for( int i = 0; i < 13; i++ )
+        values[5 + i] = mfcc(i);
+
+    if( g_feat_writer )
+        feature_writer_write( g_feat_writer, time, values );
+
+    // relative to the recorded audio (nothing outside it)
+    if( g_recorder )
+    {
+        double at = record_time( time );
+        if( at >= 0 )
+            recorder_features( g_recorder, at, values );
+    }
+
+    if( g_shm || g_socket )
+    {
+        bus(0) = (float)time;
+        bus(1) = (float)channel;
+        if( g_shm ) bus.send( g_shm );
+        if( g_socket ) bus.send( g_socket );
+    }
+
+    if( !g_stdout )
+        return;
+
+    if( channel >= 0 )
+        fprintf( stdout, "ch%i  ", channel );
+    fprintf( stdout, "%.2f  %.2f  %.8f  %.2f  %.2f  ", centroid, flux, rms, rolloff, rolloff2 );
+    fprintf( stdout, "%.2f  %.2f  %.2f  %.2f  %.2f  %.2f  %.2f  %.2f  %.2f  %.2f  %.2f %.2f %.2f  ", 
+             mfcc(0), mfcc(1), mfcc(2), mfcc(3), mfcc(4), mfcc(5), mfcc(6),
+             mfcc(7), mfcc(8), mfcc(9), mfcc(10), mfcc(11), mfcc(12) );
+    fprintf( stdout, "\n" );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: open_replay()
+// desc: the features of the recording (--replay), if it has them
+//-----------------------------------------------------------------------------
+bool open_replay( )
+{
+    char path[1024];
+
+    sprintf( path, "%.1000s.feat", g_replay_prefix );
+    g_replay_feat = feature_reader_open( path );
+    if( !g_replay_feat )
+    {
+        fprintf( stderr, "[sndpeek]: warning: no features in '%s', analyzing the audio...\n", path );
+        return true;
+    }
+
+    // fed back as output_features() columns: only if they are ours, by
+    // name and in order, so nothing goes out under another's name
+    const feature_header * h = feature_reader_header( g_replay_feat );
+    const char * columns[ANALYZE_COLUMNS];
+    GLint i, n = g_stream.feature_names( columns );
+    bool ours = (GLint)h->columns == n;
+    for( i = 0; ours && i < n; i++ )
+        ours = !strcmp( feature_reader_column( g_replay_feat, i ), columns[i] );
+    if( !ours )
+    {
+        fprintf( stderr, "[sndpeek]: warning: '%s' has other features, analyzing the audio...\n", path );
+        feature_reader_close( g_replay_feat );
+        return true;
+    }
+
+    g_replay_values = new float[h->channels * h->columns];
+    g_replay_record = new float[h->columns];
+    memset( g_replay_values, 0, h->channels * h->columns * sizeof(float) );
+    fprintf( stderr, "[sndpeek]: replaying %s at %.2fx (%i feature channel(s))...\n",
+             g_replay_prefix, g_replay_speed, h->channels );
+
+    return true;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: replay_features()
+// desc: every recorded feature frame up to 'time', out as if just computed
+//       (unless 'skip')
+//-----------------------------------------------------------------------------
+void replay_features( double time, GLboolean skip )
+{
+    static fvec mfcc(13);
+
+    if( !g_replay_feat )
+        return;
+
+    const feature_header * h = feature_reader_header( g_replay_feat );
+    GLint C = h->channels;
+
+    while( true )
+    {
+        // read ahead by one
+        if( !g_replay_pending )
+        {
+            if( !feature_reader_read( g_replay_feat, g_replay_time, g_replay_record ) )
+                break;
+            g_replay_pending = TRUE;
+        }
+        if( g_replay_time > time )
+            break;
+
+        // channels are interleaved by frame
+        GLint ch = g_replay_index++ % C;
+        float * v = g_replay_values + ch * h->columns;
+        memcpy( v, g_replay_record, h->columns * sizeof(float) );
+        g_replay_pending = FALSE;
+
+        if( !skip && feature_output() )
+        {
+            for( GLint i = 0; i < 13; i++ )
+                mfcc(i) = v[5 + i];
+            output_features( C > 1 ? ch : -1, g_replay_time, v[0], v[1], v[2], v[3], v[4], mfcc );
+        }
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: replay_step()
+// desc: the next hop of the recording, when the clock gets there, and its
+//       features; FALSE at the end
+//-----------------------------------------------------------------------------
+GLboolean replay_step( )
+{
+    // frames read, and where the recording should be by now
+    static long pos = 0;
+    static double clock = 0, last = 0;
+    double now = stats_now_usec();
+    long start = (long)( g_begintime * g_srate ), target;
+
+    // (re)start, also the first time
+    if( g_restart )
+    {
+        pos = start;
+        clock = start;
+        sf_seek( g_sf, pos, SEEK_SET );
+        memset( g_multi_buffer, 0, g_buffer_size * g_channels * sizeof(SAMPLE) );
+        g_restart = FALSE;
+        // the display clears the waterfall
+        g_rows_restart = TRUE;
+        // features from the start again
+        if( g_replay_feat )
+        {
+            char path[1024];
+            sprintf( path, "%.1000s.feat", g_replay_prefix );
+            feature_reader_close( g_replay_feat );
+            g_replay_feat = feature_reader_open( path );
+            g_replay_pending = FALSE;
+            g_replay_index = 0;
+            replay_features( (double)start / g_srate - 1e-9, TRUE );
+        }
+        g_file_running = TRUE;
+        last = now;
+    }
+
+    // the replay clock stands still while paused
+    if( !g_pause )
+        clock += ( now - last ) / 1e6 * g_replay_speed * g_srate;
+    last = now;
+
+    if( pos >= g_sf_info.frames + g_buffer_size )
+    {
+        // all of it has been through the window
+        g_file_running = FALSE;
+        return FALSE;
+    }
+
+    // paused: nothing new (the display keeps the last window)
+    if( g_pause )
+    {
+        usleep( 10000 );
+        return TRUE;
+    }
+
+    if( g_replay_speed <= 0 )
+        target = pos + g_buffer_size;
+    else
+    {
+        // every hop, waiting for the clock to get there
+        target = pos + g_buffer_size;
+        if( clock < target )
+        {
+            usleep( (useconds_t)( ( target - clock ) / ( g_replay_speed * g_srate ) * 1e6 ) );
+            clock = target;
+            last = stats_now_usec();
+        }
+    }
+
+    if( target > pos )
+    {
+        // only the frames new to the window get recorded
+        long fresh = target - pos < g_buffer_size ? target - pos : g_buffer_size;
+        read_window( pos, target );
+        record_audio( g_multi_buffer + ( g_buffer_size - fresh ) * g_channels, fresh, pos - fresh );
+        split_channels( g_multi_buffer, g_buffer_size, g_channels );
+        g_play_pos = pos;
+        g_audio_pos = pos - g_buffer_size;
+    }
+
+    // the recording's features, up to this window
+    replay_features( (double)g_audio_pos / g_srate, FALSE );
+
+    push_window( );
+    return TRUE;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: row_wave() / row_spectrum()
+// desc: the waveform and magnitude spectrum after a row's header
+//-----------------------------------------------------------------------------
+inline SAMPLE * row_wave( unsigned char * row )
+{
+    return (SAMPLE *)( row + sizeof(DisplayRow) );
+}
+
+inline SAMPLE * row_spectrum( unsigned char * row )
+{
+    return row_wave( row ) + g_buffer_size;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: analyze_window()
+// desc: the newest window: spectrum, features and their output, then a
+//       row for the display (on the analysis thread; offscreen, on the
+//       render loop)
+//-----------------------------------------------------------------------------
+void analyze_window( )
+{
+    static fvec in(g_marsyas_size),
+        centroid(1), flux(1), rms(1), rolloff(1), rolloff2(1);
+
+    DisplayRow * row = (DisplayRow *)g_row_in;
+    AudioWindow * window = (AudioWindow *)g_window_out;
+    SAMPLE * buffer = g_fft_buffer, * ptr = in.getData(), * multi;
+    SAMPLE * spectrum = row_spectrum( g_row_in );
+    GLint i;
+    long pos;
+
+    // the next window (possibly preview), in the order it came
+    if( !g_windows.get( g_window_out, 1 ) )
+        return;
+    multi = window_multi( g_window_out );
+
+    // zero padded
+    memset( buffer, 0, g_fft_size * sizeof(SAMPLE) );
+    memcpy( buffer, window_mono( g_window_out ), g_buffer_size * sizeof(SAMPLE) );
+    // where it is in the file (cache frame index)
+    pos = row->pos = window->pos;
+    row->frame = ( pos + g_buffer_size / 2 ) / g_buffer_size;
+    row->seeking = window->seeking;
+    row->restart = window->restart;
+
+    // just the channel on view
+    if( g_view_channel >= 0 )
+    {
+        for( i = 0; i < g_buffer_size; i++ )
+            buffer[i] = multi[i * g_channels + g_view_channel];
+    }
+
+    // pitch, from the window as it came in (the display's only)
+    if( !g_freeze && g_draw_features && !g_replay_feat )
+        g_stream.track_pitch( (float *)buffer );
+    row->pitch[0] = g_stream.pitch();
+    row->pitch[1] = g_stream.voicing();
+
+    // apply the transform window; that's the waveform on display too
+    apply_window( (float*)buffer, g_window, g_buffer_size );
+    memcpy( row_wave( g_row_in ), buffer, g_buffer_size * sizeof(SAMPLE) );
+
+    // magnitude spectrum of the newest layer
+    if( g_cache )
+    {
+        // look g_wf_delay buffers ahead instead of delaying playback
+        if( !stft_cache_get( g_cache, row->frame + g_wf_delay, spectrum ) )
+            memset( spectrum, 0, g_fft_size/2 * sizeof(SAMPLE) );
+    }
+    else if( g_multi )
+    {
+        // every channel's spectrum, then the one on view (or the mean)
+        double fft_start = stats_now_usec();
+        g_analyzer.analyze( multi );
+        g_stats[STAT_FFT].add( stats_now_usec() - fft_start );
+        g_analyzer.get_spectrum( g_view_channel, spectrum );
+    }
+    else
+    {
+        // take forward FFT; result in buffer as FFT_SIZE/2 complex values
+        double fft_start = stats_now_usec();
+        rfft( (float *)buffer, g_fft_size/2, FFT_FORWARD );
+        g_stats[STAT_FFT].add( stats_now_usec() - fft_start );
+        // cast to complex
+        complex * cbuf = (complex *)buffer;
+        // magnitude
+        for( i = 0; i < g_fft_size/2; i++ )
+            spectrum[i] = cmp_abs( cbuf[i] );
+    }
+
+    // features, for the display and the outputs (unless frozen)
+    if( !g_freeze && ( g_draw_features || feature_output() ) )
+    {
+        if( g_replay_feat )
+        {
+            // as recorded
+            centroid(0) = replay_value( 0 );
+            flux(0) = replay_value( 1 );
+            rms(0) = replay_value( 2 );
+            rolloff(0) = replay_value( 3 );
+            rolloff2(0) = replay_value( 4 );
+        }
+        else if( g_multi )
+        {
+            // every channel in one pass
+            double features_start = stats_now_usec();
+            g_analyzer.features( .5f, .8f );
+            g_stats[STAT_FEATURES].add( stats_now_usec() - features_start );
+            // show the channel on view (or the mean)
+            centroid(0) = view_value( g_analyzer.centroid() );
+            flux(0) = view_value( g_analyzer.flux() );
+            rms(0) = view_value( g_analyzer.rms() );
+            rolloff(0) = view_value( g_analyzer.rolloff() );
+            rolloff2(0) = view_value( g_analyzer.rolloff2() );
+        }
+        else
+        {
+            // zero padding interpolates: every ratio-th bin is exactly
+            // the spectrum of the (unpadded) window
+            int ratio = g_fft_size / g_buffer_size;
+            // get magnitude response
+            for( i = 0; i < g_marsyas_size; i++ )
+                ptr[i] = spectrum[i*ratio];
+
+            // centroid, flux, rms, rolloffs (and mfcc, if it goes out)
+            g_stream.features( ptr, feature_output() ? ANALYZE_SPECTRAL | ANALYZE_MFCC
+                                                     : ANALYZE_SPECTRAL );
+            centroid(0) = g_stream.centroid();
+            flux(0) = g_stream.flux();
+            rms(0) = g_stream.rms();
+            rolloff(0) = g_stream.rolloff();
+            rolloff2(0) = g_stream.rolloff2();
+        }
+    }
+    row->features[0] = centroid(0);
+    row->features[1] = flux(0);
+    row->features[2] = rms(0);
+    row->features[3] = rolloff(0);
+    row->features[4] = rolloff2(0);
+
+    // print to console (one line per channel); a replay's come from
+    // the recording
+    if( g_replay_feat )
+        ;
+    else if( feature_output() && g_multi )
+    {
+        for( i = 0; i < g_channels; i++ )
+        {
+            // mfcc one channel at a time
+            g_analyzer.get_feature_spectrum( i, ptr );
+            g_stream.features( ptr, ANALYZE_MFCC );
+
+            output_features( i, (double)pos / g_srate, g_analyzer.centroid()[i],
+                             g_analyzer.flux()[i], g_analyzer.rms()[i],
+                             g_analyzer.rolloff()[i], g_analyzer.rolloff2()[i],
+                             g_stream.mfcc() );
+        }
+    }
+    else if( feature_output() )
+        output_features( -1, (double)pos / g_srate, centroid(0), flux(0), rms(0),
+                         rolloff(0), rolloff2(0), g_stream.mfcc() );
+
+    // to the display; if it's that far behind, it goes without
+    if( !g_rows.put( g_row_in, 1 ) )
+        g_rows_dropped++;
+
+    // maintain count from analysis
+    g_buffer_count_b++;
+    // check against count from reading function
+    if( g_filename && !g_file_running && g_buffer_count_b == g_buffer_count_a )
+        g_running = FALSE;
+
+    // close the timing interval?
+    stats_poll( );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: analysis_thread()
+// desc: analyzes every window the audio delivers, in order, until stopped
 //-----------------------------------------------------------------------------
-void draw_string( GLfloat x, GLfloat y, GLfloat z, const char * str, GLfloat scale = 1.0f )
+THREAD_RETURN THREAD_TYPE analysis_thread( void * data )
 {
-    GLint len = strlen( str ), i;
+    while( !g_analysis_stop )
+    {
+        // replay: the next hop, when its time comes (read right here)
+        if( g_replay_prefix )
+        {
+            if( !replay_step() )
+            {
+                usleep( 10000 );
+                continue;
+            }
+        }
+        // otherwise the callback's, once there is one
+        else
+            wait_window( );
 
-    glPushMatrix();
-    glTranslatef( x, y, z );
-    glScalef( .001f * scale, .001f * scale, .001f * scale );
+        // all of those queued
+        while( g_windows.readable() && !g_analysis_stop )
+            analyze_window( );
+    }
 
-    for( i = 0; i < len; i++ )
-        glutStrokeCharacter( GLUT_STROKE_ROMAN, str[i] );
-    
-    glPopMatrix();
+    RingBuffer::fence();
+    g_analysis_done = TRUE;
+
+    return 0;
 }
 
 
 
 
 //-----------------------------------------------------------------------------
-// name: ...
-// desc: ...
+// name: start_analysis()
+// desc: moves the analysis off the render thread
 //-----------------------------------------------------------------------------
-void drawLissajous( SAMPLE * stereobuffer, int len, int channels)
+bool start_analysis( )
 {
-    float x, y;
-    SAMPLE * buffer;
-    
-    // 1 or 2 channels only for now
-    assert( channels >= 1 && channels <= 2 );
+    // the fft initializes itself on first use
+    memset( g_fft_buffer, 0, g_fft_size * sizeof(SAMPLE) );
+    rfft( g_fft_buffer, g_fft_size/2, FFT_FORWARD );
 
-    // mono
-    if( channels == 1 )
-    {
-        buffer = g_cur_buffer; 
-        // convert to mono
-        for( int m = 0; m < len; m++)
-        {
-            buffer[m] = stereobuffer[m*2] + stereobuffer[m*2+1];
-            buffer[m] /= 2.0f;
-        }
-    }
-    else
+    g_async = TRUE;
+    if( !g_analysis_thread.start( analysis_thread, NULL ) )
     {
-        buffer = stereobuffer;
+        g_async = FALSE;
+        return false;
     }
-    
-    // color
-    glColor3f( 1.0f, 1.0f, .5f );
-    // save current matrix state
-    glPushMatrix();
-    // translate
-    glTranslatef( 1.2f, 0.0f, 0.0f );
-    // draw it
-    glBegin( GL_LINE_STRIP );
-    for( int i = 0; i < len * channels; i += channels )
-    {
-        x = buffer[i] * g_lissajous_scale;
-        if( channels == 1 )
-        {
-            // delay
-            y = (i - g_delay >= 0) ? buffer[i-g_delay] : g_back_buffer[len + i-g_delay]; 
-            y *= g_lissajous_scale;
-        }
-        else
-        {
-            y = buffer[i + channels-1] * g_lissajous_scale;
-        }
 
-        glVertex3f( x, y, 0.0f );
-        // glVertex3f( x, y, sqrt( x*x + y*y ) * -g_lissajous_scale );
-    }
-    glEnd();
-    // restore matrix state
-    glPopMatrix();
-    
-    // hmm...
-    if( channels == 1 )
-        memcpy( g_back_buffer, buffer, len * sizeof(SAMPLE) );
+    return true;
 }
 
 
 
 
 //-----------------------------------------------------------------------------
-// Name: map_log_spacing( )
-// Desc: ...
+// name: stop_analysis()
+// desc: lets the analysis thread finish (at exit, before the outputs close)
 //-----------------------------------------------------------------------------
-inline double map_log_spacing( double ratio, double power )
+void stop_analysis( )
 {
-    if( ratio <= g_left_trim ) ratio = 0;
-    else ratio = (ratio - g_left_trim) / (1.0 - g_left_trim);
+    if( !g_async ) return;
 
-    // compute location
-    if( ratio < (1.0/g_fft_size) ) return 0; // g_centering/2 * g_zooming * g_fft_size/g_freq_view;
-    double offset = -log(1.0/g_fft_size);
-    return ((1-power)*ratio + (power)*(offset+log(ratio))/offset) * g_fft_size/g_freq_view;
+    g_analysis_stop = TRUE;
+    wake_analysis( );
+    while( !g_analysis_done )
+        usleep( 1000 );
 }
 
 
 
 
 //-----------------------------------------------------------------------------
-// Name: map_pow_spacing( )
-// Desc: ...
+// name: reset_waterfall()
+// desc: (display thread) a (re)started stream: the waterfall from empty
 //-----------------------------------------------------------------------------
-inline double map_pow_spacing( double ratio, double power )
+void reset_waterfall( )
 {
-    if( ratio <= g_left_trim ) ratio = 0;
-    else ratio = (ratio - g_left_trim) / (1.0 - g_left_trim);
-
-    // compute location
-    return ::pow(ratio, power) * g_fft_size/g_freq_view;
+    g_wf = 0;
+    g_starting = 1;
+    for( GLint i = 0; i < g_depth; i++ )
+        g_draw[i] = false;
+    clear_history();
 }
 
 
 
 
 //-----------------------------------------------------------------------------
-// Name: compute_log_spacing( )
-// Desc: ...
+// name: advance_waterfall()
+// desc: done with the newest layer, on to the next
 //-----------------------------------------------------------------------------
-double compute_log_spacing( int fft_size, double power )
+void advance_waterfall( )
 {
-    int maxbin = fft_size; // for future in case we want to draw smaller range
-    int minbin = 0; // what about adding this one?
+    // if flagged, mark layer NOT to be drawn
+    if( !g_wutrfall )
+        g_draw[(g_wf+g_wf_delay)%g_depth] = false;
 
-    for(int i = 0; i < fft_size; i++)
+    // wtrfll
+    if( !g_freeze )
     {
-        // compute location
-        g_log_positions[i] = map_log_spacing( (double)i/fft_size, power );
-        if( g_log_positions[i] < 0 )
-            fprintf( stderr, "%d %f\n", i, g_log_positions[i] );
-        // normalize, 1 if maxbin == fft_size
-        g_log_positions[i] /= pow((double)maxbin/fft_size, power);
+        // advance index
+        g_wf--;
+        // mod
+        g_wf = (g_wf + g_depth) % g_depth; 
+        // can't remember what this does anymore...
+        if( g_wf == g_depth - g_wf_delay )
+            g_starting = 0;
     }
-
-    return 1/::log(fft_size);
 }
 
 
 
 
 //-----------------------------------------------------------------------------
-// Name: compute_pow_spacing( )
-// Desc: ...
+// name: shed_layers()
+// desc: frame cost (usec) against the frame budget: fewer waterfall layers
+//       while over it, back to all of them once well under
 //-----------------------------------------------------------------------------
-double compute_pow_spacing( int fft_size, double power )
+void shed_layers( double cost )
 {
-    int maxbin = fft_size; // for future in case we want to draw smaller range
-    int minbin = 0; // what about adding this one?
+    static GLint frames = 0;
+    // (every vsync: assume 60Hz)
+    double budget = 1e6 / ( g_display_fps > 0 ? g_display_fps : 60 ) * SND_FRAME_BUDGET;
+    // never fewer than the preview and some of the past
+    GLuint least = g_wf_delay + 8 < g_depth ? g_wf_delay + 8 : g_depth;
 
-    for(int i = 0; i < fft_size; i++)
+    g_frames_drawn++;
+    g_frame_cost = g_frame_cost ? .9 * g_frame_cost + .1 * cost : cost;
+
+    // offscreen, every frame is drawn in full; live, let the cost settle
+    // after each change
+    if( g_headless || ++frames < SND_SHED_FRAMES )
+        return;
+
+    if( g_frame_cost > budget && g_draw_depth > least )
     {
-        // compute location
-        g_log_positions[i] = map_pow_spacing( (double)i/fft_size, power );
-        // normalize, 1 if maxbin == fft_size
-        g_log_positions[i] /= pow((double)maxbin/fft_size, power);
+        g_draw_depth = g_draw_depth * 3 / 4 > least ? g_draw_depth * 3 / 4 : least;
+        frames = 0;
+    }
+    else if( g_frame_cost < budget / 2 && g_draw_depth < g_depth )
+    {
+        g_draw_depth += g_depth / 16 > 1 ? g_depth / 16 : 1;
+        if( g_draw_depth > g_depth ) g_draw_depth = g_depth;
+        frames = 0;
     }
-
-    return 1/::log(fft_size);
 }
 
 
@@ -1519,15 +3816,90 @@ void displayFunc( )
     static long int count = 0;
     static char str[1024];
     static float centroid_val, flux_val, rms_val, rolloff_val, rolloff2_val;
-    static fvec in(SND_MARSYAS_SIZE),
-        centroid(1), flux(1), lpc(g_lpc->outSize()), mfcc(13), rms(1), rolloff(1),
-        rolloff2(1), centroid_lp(LP), flux_lp(LP), rms_lp(LP), rolloff_lp(LP),
-        rolloff2_lp(LP);
+    static float pitch_val, voicing_val;
+    static fvec centroid_lp(LP), flux_lp(LP), rms_lp(LP), rolloff_lp(LP), rolloff2_lp(LP);
+    // the last row is in the waterfall; move on before the next
+    static GLboolean advance = FALSE;
 
     // local variables
-    SAMPLE * buffer = g_fft_buffer, * ptr = in.getData();
+    DisplayRow * row = (DisplayRow *)g_row_out;
+    SAMPLE * buffer = row_wave( g_row_out );
     GLfloat ytemp, fval;
-    GLint i;
+    GLint i, rows = 0;
+
+    // offscreen: this frame's window, analyzed right here
+    if( !g_async )
+        analyze_window( );
+
+    // render timing starts once there's data
+    double render_start = stats_now_usec();
+
+    // every window analyzed since the last frame goes into the waterfall
+    // (and the feature lowpass); the newest one gets drawn
+    while( g_rows.get( g_row_out, 1 ) )
+    {
+        // (re)started: this row is the first layer again
+        if( row->restart )
+        {
+            reset_waterfall( );
+            advance = FALSE;
+        }
+        if( advance )
+            advance_waterfall( );
+        advance = TRUE;
+        rows++;
+
+        // cache: the whole history is known, fill it in after a (re)start
+        if( g_cache && g_starting && !row->seeking )
+        {
+            for( i = 1; i < g_depth; i++ )
+            {
+                GLint layer = (g_wf + i) % g_depth;
+                if( stft_cache_get( g_cache, row->frame + g_wf_delay - i, g_spectrum ) )
+                {
+                    fill_spectrum_row( layer, g_spectrum );
+                    g_draw[layer] = g_wutrfall;
+                }
+            }
+            g_starting = 0;
+            g_vbo_dirty = TRUE;
+        }
+
+        // copy current magnitude spectrum into waterfall memory
+        fill_spectrum_row( g_wf, row_spectrum( g_row_out ) );
+        // ...and into the vertex buffer (unless all of it goes anyway)
+        if( g_vbo_ok && !g_vbo_dirty )
+            upload_spectrum_row( g_wf );
+
+        // draw the right things
+        g_draw[g_wf] = g_wutrfall;
+        if( !g_starting )
+            g_draw[(g_wf+g_wf_delay)%g_depth] = true;
+
+        // lowpass
+        if( !g_freeze )
+        {
+            centroid_lp(count % LP) = row->features[0];
+            flux_lp(count % LP) = row->features[1];
+            rms_lp(count % LP) = row->features[2];
+            rolloff_lp(count % LP) = row->features[3];
+            rolloff2_lp(count % LP) = row->features[4];
+            // (not averaged: unvoiced frames would drag it down)
+            pitch_val = row->pitch[0];
+            voicing_val = row->pitch[1];
+            count++;
+        }
+    }
+
+    // get average values
+    if( rows && !g_freeze )
+    {
+        centroid_val = centroid_lp.mean();
+        flux_val = flux_lp.mean();
+        rms_val = rms_lp.mean();
+        rolloff_val = rolloff_lp.mean();
+        rolloff2_val = rolloff2_lp.mean();
+    }
 
     // clear the color and depth buffers
     glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
@@ -1538,38 +3910,18 @@ void displayFunc( )
         // rotate the sphere about y axis
         glRotatef( g_angle_y += g_inc, 0.0f, 1.0f, 0.0f );
 
-        // wait for data
-        while( !g_ready ) usleep( 1000 );
-
-        // lock
-        g_mutex.lock();
-
-        // get the latest (possibly preview) window
-        memset( buffer, 0, SND_FFT_SIZE * sizeof(SAMPLE) );
-
-        // copy currently playing audio into buffer
-        memcpy( buffer, g_audio_buffer, g_buffer_size * sizeof(SAMPLE) );
-
-        // some flag (hand off to audio cb thread)
-        g_ready = FALSE;
-
-        // unlock
-        g_mutex.unlock();
-
         // lissajous
         if( g_lissajous )
         {
             if( !g_filename ) { // real-time mic input
                 drawLissajous( g_stereo_buffer, g_buffer_size, 1 );
             } else { // reading from file
-                drawLissajous( g_stereo_buffer, g_buffer_size, g_sf_info.channels );
+                drawLissajous( g_stereo_buffer, g_buffer_size, g_channels > 2 ? 2 : g_channels );
             }
         }
 
-        // soon to be used drawing offsets
+        // soon to be used drawing offsets (the waveform is windowed already)
         GLfloat x = -1.8f, inc = 3.6f / g_buffer_size, y = .7f;
-        // apply the transform window
-        apply_window( (float*)buffer, g_window, g_buffer_size );
 
         // draw the time domain waveform
         if( g_waveform )
@@ -1585,14 +3937,27 @@ void displayFunc( )
             // set vertex normals (for somewhat controlled lighting)
             glNormal3f( 0.0f, 0.0f, 1.0f );
             // draw waveform
-            glBegin( GL_LINE_STRIP );
             {
                 GLint ii = ( g_buffer_size - (g_buffer_size/g_time_view) ) / 2;
+                GLint n = g_buffer_size / g_time_view;
                 GLfloat xcoord = 0.0f;
-                // loop through samples
-                for( i = ii; i < ii + g_buffer_size / g_time_view; i++ )
+                // min/max of the samples under each pixel column
+                if( g_use_lod )
+                    n = lod_minmax( NULL, buffer + ii, n, lod_columns( 0, 0, 0, n-1, 0, 0 ),
+                                    g_lod_x, g_lod_y );
+                glBegin( GL_LINE_STRIP );
+                if( g_use_lod )
+                {
+                    for( i = 0; i < n; i++ )
+                        glVertex2f( g_lod_x[i], g_lod_y[i] );
+                }
+                else
                 {
-                    glVertex2f( xcoord++ , buffer[i] );
+                    // loop through samples
+                    for( i = ii; i < ii + n; i++ )
+                    {
+                        glVertex2f( xcoord++ , buffer[i] );
+                    }
                 }
                 glEnd();
             }
@@ -1600,11 +3965,6 @@ void displayFunc( )
             glPopMatrix();
         }
 
-        // take forward FFT; result in buffer as FFT_SIZE/2 complex values
-        rfft( (float *)buffer, g_fft_size/2, FFT_FORWARD );
-        // cast to complex
-        complex * cbuf = (complex *)buffer;
-
         // reset drawing offsets
         x = -1.8f;
         y = -1.0f;
@@ -1614,28 +3974,18 @@ void displayFunc( )
         // set vertex normals
         glNormal3f( 0.0f, 1.0f, 0.0f );
 
-        // copy current magnitude spectrum into waterfall memory
-        for( i = 0; i < g_fft_size/2; i++ )
+        // columns covered on screen, layers go stale if that changes
+        if( g_use_lod )
+            update_waterfall_lod();
+
+        // everything into the vertex buffer, if x changed
+        if( g_vbo_ok && g_vbo_dirty )
         {
-            // copy x coordinate
-            g_spectrums[g_wf][i].x = x;
-            // copy y, depending on scaling
-            if( !g_usedb ) {
-                g_spectrums[g_wf][i].y = g_gain * g_freq_scale * 1.8f *
-                    ::pow( 25 * cmp_abs( cbuf[i] ), .5 ) + y;
-            } else {
-                g_spectrums[g_wf][i].y = g_gain * g_freq_scale * 
-                    ( 20.0f * log10( cmp_abs(cbuf[i])/8.0 ) + 80.0f ) / 80.0f + y + .5f;
-            }            
-            // increment x
-            x += inc * g_freq_view;
+            for( i = 0; i < g_depth; i++ )
+                upload_spectrum_row( i );
+            g_vbo_dirty = FALSE;
         }
 
-        // draw the right things
-        g_draw[g_wf] = g_wutrfall;
-        if( !g_starting )
-            g_draw[(g_wf+g_wf_delay)%g_depth] = true;
-        
         // reset drawing variables
         x = -1.8f;
         inc = 3.6f / g_fft_size;
@@ -1646,16 +3996,23 @@ void displayFunc( )
         glTranslatef( x, 0.0, g_z );
         // scale it
         glScalef( inc*g_freq_view , 1.0 , -g_space );
-        // loop through each layer of waterfall
-        for( i = 0; i < g_depth; i++ )
+#ifdef __SNDPEEK_VBO__
+        // source layers from the vertex buffer
+        if( g_vbo_ok )
+        {
+            glBindBuffer( GL_ARRAY_BUFFER, g_vbo );
+            glVertexPointer( 2, GL_FLOAT, 0, 0 );
+            glEnableClientState( GL_VERTEX_ARRAY );
+        }
+#endif
+        // loop through each layer of waterfall (as many as we can afford)
+        for( i = 0; i < g_draw_depth; i++ )
         {
             if( i == g_wf_delay || !g_freeze || g_wutrfall )
             {
                 // if layer is flagged for draw
                 if( g_draw[(g_wf+i)%g_depth] )
                 {
-                    // get the magnitude spectrum of layer
-                    Pt2D * pt = g_spectrums[(g_wf+i)%g_depth];
                     // future
                     if( i < g_wf_delay )
                     {
@@ -1698,85 +4055,58 @@ void displayFunc( )
                         }
                     }
 
+                    // depth of the layer
+                    float d = g_backwards ? g_depth - (float) i : (float) i;
+#ifdef __SNDPEEK_VBO__
+                    // render the layer straight out of the vertex buffer
+                    if( g_vbo_ok )
+                    {
+                        glPushMatrix();
+                        glTranslatef( 0.0f, 0.0f, d );
+                        GLint row = (g_wf+i)%g_depth;
+                        glDrawArrays( GL_LINE_STRIP, row * g_vbo_stride, g_vbo_counts[row] );
+                        glPopMatrix();
+                    }
+                    else
+#endif
+                    {
+                    // get the magnitude spectrum of layer
+                    const GLfloat * xs, * ys;
+                    GLint n = get_layer_vertices( (g_wf+i)%g_depth, &xs, &ys );
                     // render the actual spectrum layer
                     glBegin( GL_LINE_STRIP );
-                    for( GLint j = 0; j < g_fft_size/g_freq_view; j++, pt++ )
+                    for( GLint j = 0; j < n; j++ )
                     {
                         // draw the vertex
-                        float d = g_backwards ? g_depth - (float) i : (float) i;
-                        glVertex3f( g_log_positions[j], (double)j/(g_fft_size/g_freq_view) >= g_left_trim ? pt->y : y, d );
+                        glVertex3f( xs[j], ys[j], d );
                     }
                     glEnd();
+                    }
 
                     // back to default line width
                     glLineWidth(1.0f);
                 }
             }
         }
-        // restore matrix state
-        glPopMatrix();
-        
-        // if flagged, mark layer NOT to be drawn
-        if( !g_wutrfall )
-            g_draw[(g_wf+g_wf_delay)%g_depth] = false;
-
-        // wtrfll
-        if( !g_freeze )
+#ifdef __SNDPEEK_VBO__
+        if( g_vbo_ok )
         {
-            // advance index
-            g_wf--;
-            // mod
-            g_wf = (g_wf + g_depth) % g_depth; 
-            // can't remember what this does anymore...
-            if( g_wf == g_depth - g_wf_delay )
-                g_starting = 0;
+            glDisableClientState( GL_VERTEX_ARRAY );
+            glBindBuffer( GL_ARRAY_BUFFER, 0 );
         }
+#endif
+        // restore matrix state
+        glPopMatrix();
 
-        // calculate and draw features
+        // draw features
         if( g_draw_features )
         {
-            // if not frozen
-            if( !g_freeze )
-            {
-                // for rough downsampling
-                int ratio = g_fft_size / SND_MARSYAS_SIZE / 2;
-                // get magnitude response
-                for( i = 0; i < SND_MARSYAS_SIZE; i++ )
-                    ptr[i] = cmp_abs( cbuf[i*ratio] );
-        
-                // centroid
-                g_centroid->process( in, centroid );
-                // flux
-                g_flux->process( in, flux );
-                // rms
-                g_rms->process( in, rms );
-                // rolloff 1
-                g_rolloff->process( in, rolloff );
-                // rolloff 2
-                g_rolloff2->process( in, rolloff2 );
-        
-                // lowpass
-                centroid_lp(count % LP) = centroid(0);
-                flux_lp(count % LP) = flux(0);
-                rms_lp(count % LP) = rms(0);
-                rolloff_lp(count % LP) = rolloff(0);
-                rolloff2_lp(count % LP) = rolloff2(0);
-                count++;
-
-                // get average values
-                centroid_val = centroid_lp.mean();
-                flux_val = flux_lp.mean();
-                rms_val = rms_lp.mean();
-                rolloff_val = rolloff_lp.mean();
-                rolloff2_val = rolloff2_lp.mean();
-            }
-
             // draw the centroid
             // TODO: need to update 'inc'?
             ytemp = y+.04f + 2 * (::pow( 30 * rms_val, .5 ) );
             float centroid_x = g_use_log ?
-                map_log_spacing( centroid_val/SND_MARSYAS_SIZE, g_log_factor ) :
-                map_pow_spacing( centroid_val/SND_MARSYAS_SIZE, g_pow_factor );
+                map_log_spacing( centroid_val/g_marsyas_size, g_log_factor ) :
+                map_pow_spacing( centroid_val/g_marsyas_size, g_pow_factor );
             centroid_x *= (inc*g_freq_view);
             glColor3f( 1.0f, .4f, .4f );
             glBegin( GL_LINE_STRIP );
@@ -1792,7 +4122,7 @@ void displayFunc( )
             glEnd();
         
             // print centroid
-            sprintf( str, "centroid = %.0f Hz", centroid_val / SND_MARSYAS_SIZE * g_srate / 2 );
+            sprintf( str, "centroid = %.0f Hz", centroid_val / g_marsyas_size * g_srate / 2 );
             draw_string( -1.7f + centroid_x, y-.14f, 0.0f + g_z, str, .4f );
 
             // rms value
@@ -1808,8 +4138,8 @@ void displayFunc( )
             // draw the rolloff
             glColor3f( 1.0f, 1.0f, .4f );
             float rolloff_x = g_use_log ?
-                map_log_spacing( rolloff_val/SND_MARSYAS_SIZE, g_log_factor ) :
-                map_pow_spacing( rolloff_val/SND_MARSYAS_SIZE, g_pow_factor );
+                map_log_spacing( rolloff_val/g_marsyas_size, g_log_factor ) :
+                map_pow_spacing( rolloff_val/g_marsyas_size, g_pow_factor );
             rolloff_x *= (inc*g_freq_view);
             glBegin( GL_LINE_STRIP );
               glVertex3f( -1.8f + rolloff_x, y-.04f, 0.0f + g_z );
@@ -1819,8 +4149,8 @@ void displayFunc( )
             // draw other rolloff
             glColor3f( 1.0f, 1.0f, 1.0f );
             float rolloff2_x = g_use_log ?
-                map_log_spacing( rolloff2_val/SND_MARSYAS_SIZE, g_log_factor ) :
-                map_pow_spacing( rolloff2_val/SND_MARSYAS_SIZE, g_pow_factor );                
+                map_log_spacing( rolloff2_val/g_marsyas_size, g_log_factor ) :
+                map_pow_spacing( rolloff2_val/g_marsyas_size, g_pow_factor );                
             rolloff2_x *= (inc*g_freq_view);
             glBegin( GL_LINE_STRIP );
               glVertex3f( -1.8f + rolloff2_x, y-.04f, 0.0f + g_z );
@@ -1828,7 +4158,7 @@ void displayFunc( )
             glEnd();
         
             // centroid
-            sprintf( str, "centroid = %.0f", centroid_val / SND_MARSYAS_SIZE * g_srate / 2 );
+            sprintf( str, "centroid = %.0f", centroid_val / g_marsyas_size * g_srate / 2 );
             draw_string( -1.7f, 0.4f, 0.0f, str, 0.4f );
             // flux
             sprintf( str, "flux = %.1f", flux_val );
@@ -1837,21 +4167,17 @@ void displayFunc( )
             sprintf( str, "RMS = %.4f", 1000 * rms_val );
             draw_string( -1.7f, 0.2f, 0.0f, str, 0.4f );
             // flux
-            sprintf( str, "50%% rolloff= %.0f", rolloff_val / SND_MARSYAS_SIZE * g_srate / 2 );
+            sprintf( str, "50%% rolloff= %.0f", rolloff_val / g_marsyas_size * g_srate / 2 );
             draw_string( -1.7f, 0.1f, 0.0f, str, 0.4f );
             // flux
-            sprintf( str, "80%% rolloff = %.0f", rolloff2_val / SND_MARSYAS_SIZE * g_srate / 2 );
+            sprintf( str, "80%% rolloff = %.0f", rolloff2_val / g_marsyas_size * g_srate / 2 );
             draw_string( -1.7f, 0.0f, 0.0f, str, 0.4f );
-        }
-
-        // print to console
-        if( g_stdout )
-        {
-            fprintf( stdout, "%.2f  %.2f  %.8f  %.2f  %.2f  ", centroid(0), flux(0), rms(0), rolloff(0), rolloff2(0) );
-            fprintf( stdout, "%.2f  %.2f  %.2f  %.2f  %.2f  %.2f  %.2f  %.2f  %.2f  %.2f  %.2f %.2f %.2f  ", 
-                     mfcc(0), mfcc(1), mfcc(2), mfcc(3), mfcc(4), mfcc(5), mfcc(6),
-                     mfcc(7), mfcc(8), mfcc(9), mfcc(10), mfcc(11), mfcc(12) );
-            fprintf( stdout, "\n" );
+            // pitch (yin), and how voiced
+            if( pitch_val > 0 )
+                sprintf( str, "pitch = %.1f Hz (%.2f)", g_srate / pitch_val, voicing_val );
+            else
+                sprintf( str, "pitch = - (%.2f)", voicing_val );
+            draw_string( -1.7f, -0.1f, 0.0f, str, 0.4f );
         }
 
         // set color
@@ -1863,11 +4189,21 @@ void displayFunc( )
         // time
         if( g_show_time )
         {
-            float fsec = ((double)sf_seek(g_sf,0,SEEK_CUR) - (double)g_wf_delay * g_buffer_size) / (double)g_srate;
+            float fsec = ((double)g_play_pos - (double)(g_waveforms ? g_wf_delay : 0) * g_buffer_size) / (double)g_srate;
             sprintf( str, "%.0f", fsec ); 
             draw_string( -1.7f, 1.1f, -.2f, str, .4f );
         }
 
+        // channel on view
+        if( g_multi || g_view_channel >= 0 )
+        {
+            if( g_view_channel < 0 )
+                sprintf( str, "all %i channels", g_channels );
+            else
+                sprintf( str, "channel %i of %i", g_view_channel, g_channels );
+            draw_string( -1.7f, 1.05f, -.2f, str, .4f );
+        }
+
         // pause?
         if( g_pause )
             draw_string( 0.95f, 1.1f, -.2f, "paused... (press f to resume)", .4f );
@@ -1876,19 +4212,25 @@ void displayFunc( )
         if( g_mute )
             draw_string( 0.95f, 1.05f, -.2f, "muted... (press m to unmute)", .4f );
 
+        // timing (keep up with stats_poll() even with the HUD off)
+        while( g_stats_out.get( &g_stats_shown, 1 ) );
+        if( g_show_stats )
+            draw_stats( );
+
     // restore matrix state
     glPopMatrix( );
 
     // flush gl commands
     glFlush( );
-    // swap the buffers
-    glutSwapBuffers( );
-
-    // maintain count from render
-    g_buffer_count_b++;
-    // check against count from reading function
-    if( g_filename && !g_file_running && g_buffer_count_b == g_buffer_count_a )
-        g_running = FALSE;
+    // (not counting the swap, which may wait for vsync)
+    double cost = stats_now_usec() - render_start;
+    g_stats[STAT_RENDER].add( cost );
+    // swap the buffers (offscreen: the frame is read back by the caller)
+    if( !g_headless )
+        glutSwapBuffers( );
+
+    // fit the next frames in the budget
+    shed_layers( cost );
 }
 
 
@@ -1901,70 +4243,161 @@ void displayFunc( )
 void extract_buffer( )
 {
     // static stuff
-    static fvec raw(g_buffer_size), in(SND_MARSYAS_SIZE),
-        centroid(1), flux(1), lpc(g_lpc->outSize()), mfcc(13), rms(1), rolloff(1),
-        rolloff2(1);
+    static fvec in(g_marsyas_size);
     
     // local
-    SAMPLE buffer[SND_BUFFER_SIZE], * ptr = in.getData();
+    SAMPLE * buffer = g_extract_buffer, * ptr = in.getData(), * multi;
     GLint i;
-
-    // wait for reading    
-    while( !g_ready )
-        usleep( 1000 );
-
-    // get data
-    if( !g_filename )
+    long pos;
+
+    // the callback's come when they come; the main loop's are there
+    if( g_audio )
+        wait_window( );
+    if( !g_windows.get( g_window_out, 1 ) )
+        return;
+    memcpy( buffer, window_mono( g_window_out ), g_buffer_size * sizeof(SAMPLE) );
+    multi = window_multi( g_window_out );
+    pos = ( (AudioWindow *)g_window_out )->pos;
+
+    // every channel on its own
+    if( g_multi )
     {
-        g_mutex.lock();
-        memcpy( buffer, g_audio_buffer, g_buffer_size * sizeof(SAMPLE) );
-        g_ready = FALSE;
-        g_mutex.unlock();
+        // spectra and the spectral features, all channels at once
+        double fft_start = stats_now_usec();
+        g_analyzer.analyze( multi );
+        g_stats[STAT_FFT].add( stats_now_usec() - fft_start );
+        double features_start = stats_now_usec();
+        g_analyzer.features( .5f, .8f );
+        g_stats[STAT_FEATURES].add( stats_now_usec() - features_start );
+
+        for( i = 0; i < g_channels; i++ )
+        {
+            // lpc and mfcc one channel at a time
+            g_analyzer.get_feature_spectrum( i, ptr );
+            g_stream.features( ptr, ANALYZE_LPC | ANALYZE_MFCC );
+
+            if( feature_output() )
+                output_features( i, (double)pos / g_srate, g_analyzer.centroid()[i],
+                                 g_analyzer.flux()[i], g_analyzer.rms()[i],
+                                 g_analyzer.rolloff()[i], g_analyzer.rolloff2()[i],
+                                 g_stream.mfcc() );
+        }
     }
     else
     {
-        memcpy( buffer, g_audio_buffer, g_buffer_size * sizeof(SAMPLE) );
-        g_ready = FALSE;
-    }
-
-    // apply the window
-    apply_window( (float*)buffer, g_window, g_buffer_size );
+        // window, fft, then centroid, flux, lpc, mfcc, rms, rolloffs
+        g_stream.analyze( buffer );
 
-    // take the forward fft, leaving fftsize/2 complex values
-    rfft( (float *)buffer, g_buffer_size/2, FFT_FORWARD );
-    // cast to complex
-    complex * cbuf = (complex *)buffer;
-
-    // get magnitude spectrum
-    for( i = 0; i < g_buffer_size/2; i++ )
-        ptr[i] = cmp_abs( cbuf[i] );
-
-    // centroid
-    g_centroid->process( in, centroid );
-    // flux
-    g_flux->process( in, flux );
-    // lpc
-    g_lpc->process( in, lpc );
-    // mfcc
-    g_mfcc->process( in, mfcc );
-    // rms
-    g_rms->process( in, rms );
-    // rolloff
-    g_rolloff->process( in, rolloff );
-    g_rolloff2->process( in, rolloff2 );
-
-    // print to console
-    if( g_stdout )
-    {
-        fprintf( stdout, "%.2f  %.2f  %.8f  %.2f  %.2f  ", centroid(0), flux(0), rms(0), rolloff(0), rolloff2(0) );
-        fprintf( stdout, "%.2f  %.2f  %.2f  %.2f  %.2f  %.2f  %.2f  %.2f  %.2f  %.2f  %.2f %.2f %.2f  ", 
-                 mfcc(0), mfcc(1), mfcc(2), mfcc(3), mfcc(4), mfcc(5), mfcc(6),
-                 mfcc(7), mfcc(8), mfcc(9), mfcc(10), mfcc(11), mfcc(12) );
-        fprintf( stdout, "\n" );
+        // print to console
+        if( feature_output() )
+            output_features( -1, (double)pos / g_srate, g_stream.centroid(),
+                             g_stream.flux(), g_stream.rms(), g_stream.rolloff(),
+                             g_stream.rolloff2(), g_stream.mfcc() );
     }
 
     // file reading stuff
     g_buffer_count_b++;
     if( g_filename && !g_file_running && g_buffer_count_a == g_buffer_count_b )
         g_running = FALSE;
+
+    // close the timing interval?
+    stats_poll( );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// Name: stats_poll( )
+// Desc: every g_stats_interval seconds, closes the timing interval and
+//       (with --stats) writes it out as one line of JSON
+//-----------------------------------------------------------------------------
+void stats_poll( )
+{
+    static double last = 0, begin = 0;
+    static unsigned long last_cb = 0, last_frames = 0, last_drawn = 0;
+    static StatsSnapshot snap;
+    double now = stats_now_usec();
+    GLint i;
+
+    if( !last ) { last = begin = now; return; }
+    if( now - last < g_stats_interval * 1e6 ) return;
+
+    // close the interval and read it back before the next roll() clears it
+    for( i = 0; i < NUM_STATS; i++ )
+    {
+        g_stats[i].roll();
+        g_stats[i].summarize( snap.stages[i] );
+    }
+
+    // throughput
+    double secs = ( now - last ) / 1e6;
+    snap.cb_rate = ( g_callbacks - last_cb ) / secs;
+    snap.frame_rate = ( g_buffer_count_b - last_frames ) / secs;
+    snap.draw_rate = ( g_frames_drawn - last_drawn ) / secs;
+    last_cb = g_callbacks;
+    last_frames = g_buffer_count_b;
+    last_drawn = g_frames_drawn;
+    last = now;
+
+    // for the HUD (full only if the display has stalled: skip it)
+    if( g_display || g_headless )
+        g_stats_out.put( &snap, 1 );
+
+    if( !g_stats_fp )
+        return;
+
+    fprintf( g_stats_fp, "{\"time\":%.3f,\"interval\":%.3f,\"callbacks_per_sec\":%.2f,"
+             "\"frames_per_sec\":%.2f,\"xruns\":%lu,\"underruns\":%d,\"windows_dropped\":%lu,",
+             ( now - begin ) / 1e6, secs, snap.cb_rate, snap.frame_rate,
+             g_xruns, g_read_underruns, g_windows_dropped );
+    // display: frames drawn, skipped to keep the pace, layers drawn
+    if( g_display )
+        fprintf( g_stats_fp, "\"draws_per_sec\":%.2f,\"draws_skipped\":%lu,\"rows_dropped\":%lu,"
+                 "\"draw_depth\":%u,", snap.draw_rate, g_frames_skipped, g_rows_dropped,
+                 g_draw_depth );
+    fprintf( g_stats_fp, "\"stages\":{" );
+    for( i = 0; i < NUM_STATS; i++ )
+    {
+        StatSummary & s = snap.stages[i];
+        fprintf( g_stats_fp, "%s\"%s\":{\"n\":%lu,\"mean\":%.1f,\"p50\":%.1f,\"p90\":%.1f,"
+                 "\"p99\":%.1f,\"max\":%.1f}", i ? "," : "", g_stat_names[i], s.count,
+                 s.mean, s.p50, s.p90, s.p99, s.max );
+    }
+    fprintf( g_stats_fp, "}}\n" );
+    fflush( g_stats_fp );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// Name: draw_stats( )
+// Desc: on-screen timing, last interval (usec; queue in frames), from
+//       the newest snapshot stats_poll() has handed over (g_stats_shown)
+//-----------------------------------------------------------------------------
+void draw_stats( )
+{
+    static char str[256];
+    const StatsSnapshot & snap = g_stats_shown;
+    GLfloat y = 1.0f;
+
+    glColor3f( 1.0f, .8f, .4f );
+    sprintf( str, "%.1f cb/s  %.1f frames/s  xruns %lu  underruns %d  windows dropped %lu",
+             snap.cb_rate, snap.frame_rate, g_xruns, g_read_underruns, g_windows_dropped );
+    draw_string( 0.45f, y, -.2f, str, .3f );
+    y -= .05f;
+    sprintf( str, "%.1f draws/s  skipped %lu  depth %u/%u  rows dropped %lu",
+             snap.draw_rate, g_frames_skipped, g_draw_depth, g_depth, g_rows_dropped );
+    draw_string( 0.45f, y, -.2f, str, .3f );
+
+    for( GLint i = 0; i < NUM_STATS; i++ )
+    {
+        const StatSummary & s = snap.stages[i];
+        if( !s.count ) continue;
+        y -= .05f;
+        sprintf( str, "%-10s p50 %7.1f  p99 %7.1f  max %7.1f", g_stat_names[i],
+                 s.p50, s.p99, s.max );
+        draw_string( 0.45f, y, -.2f, str, .3f );
+    }
 }
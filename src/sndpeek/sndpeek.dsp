@@ -151,6 +151,10 @@ SOURCE=..\marsyas\Rolloff.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\marsyas\Yin.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\RtAudio.cpp
 # End Source File
 # Begin Source File
@@ -173,6 +177,50 @@ SOURCE=.\Thread.cpp
 
 SOURCE=.\util_sndfile.c
 # End Source File
+# Begin Source File
+
+SOURCE=.\ringbuffer.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\stft_cache.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\lod.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\stats.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\multichannel.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\pcm_stream.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\feature_writer.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\marsyas\ShmCommunicator.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\marsyas\UnixCommunicator.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\stream_analyzer.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\recorder.cpp
+# End Source File
 # End Group
 # Begin Group "Header Files"
 
@@ -247,6 +295,10 @@ SOURCE=..\marsyas\Rolloff.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\marsyas\Yin.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\RtAudio.h
 # End Source File
 # Begin Source File
@@ -261,6 +313,50 @@ SOURCE=..\marsyas\System.h
 
 SOURCE=.\Thread.h
 # End Source File
+# Begin Source File
+
+SOURCE=.\ringbuffer.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\stft_cache.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\lod.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\stats.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\multichannel.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\pcm_stream.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\feature_writer.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\marsyas\ShmCommunicator.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\marsyas\UnixCommunicator.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\stream_analyzer.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\recorder.h
+# End Source File
 # End Group
 # Begin Group "Resource Files"
 
@@ -0,0 +1,646 @@
+/*----------------------------------------------------------------------------
+    sndpeekd - feature extraction for many live streams at once
+
+    Copyright (c) 2004 Ge Wang, Perry R. Cook, Ananya Misra.
+        All rights reserved.
+        http://soundlab.cs.princeton.edu/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+    U.S.A.
+-----------------------------------------------------------------------------*/
+
+//-----------------------------------------------------------------------------
+// name: sndpeekd.cpp
+// desc: sndpeek's features (no display, no audio device) for any number
+//       of streams - FIFOs, files or stdin - in one process.
+//
+//       every stream has a reader thread that only waits for input and
+//       queues each hop's window, and its own StreamAnalyzer.  a fixed
+//       pool of workers does all the analysis: a free worker takes the
+//       queued hop with the earliest deadline (its arrival plus one hop of
+//       audio, when the next one arrives), of a stream nobody else is
+//       working on, so each stream's frames stay in order.  if a stream
+//       gets a queue behind, its oldest hop is dropped.  lateness, drops
+//       and pool use are reported per stream every --stats seconds.
+//
+// usage: sndpeekd --[options] stream [stream ...]   ("-" is stdin)
+//-----------------------------------------------------------------------------
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <memory.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "chuck_fft.h"
+#include "stats.h"
+#include "pcm_stream.h"
+#include "feature_writer.h"
+#include "stream_analyzer.h"
+#include "ShmCommunicator.h"
+
+
+
+
+//-----------------------------------------------------------------------------
+// global variables and #defines
+//-----------------------------------------------------------------------------
+#define SND_MAX_STREAMS         1024
+// shared memory vector: time, stream, then the ANALYZE_COLUMNS features
+#define SND_BUS_SIZE            ( 2 + ANALYZE_COLUMNS )
+
+// one queued window
+struct Hop
+{
+    float * samples;
+    // frame the window starts at
+    long pos;
+    // when it was queued, when it should be done (usec)
+    double arrival;
+    double deadline;
+};
+
+// one input stream
+struct Stream
+{
+    int id;
+    const char * path;
+    FILE * fp;
+    pcm_stream pcm;
+    int srate;
+    int channels;
+    // regular file: read at the stream's own rate (unless --batch)
+    bool pace;
+    pthread_t reader;
+
+    // analysis state, only ever used by the worker that has the stream
+    StreamAnalyzer analyzer;
+    feature_writer out;
+    ShmCommunicator * shm;
+
+    // (guarded by g_mutex) queued hops, oldest at head
+    Hop * queue;
+    int head;
+    int count;
+    bool busy;
+    bool eof;
+    bool done;
+    // (guarded by g_mutex) since the start / the last report
+    unsigned long hops, late, dropped;
+    unsigned long last_hops, last_late, last_dropped;
+    // (guarded by g_mutex) queue to done, usec
+    StatHistogram latency;
+};
+
+// options
+int g_threads = 0;
+int g_win_size = 512;
+int g_hop_size = 0;
+int g_queue_size = 4;
+int g_format = PCM_FORMAT_WAV;
+int g_raw_srate = 44100;
+int g_raw_channels = 1;
+bool g_batch = false;
+bool g_stdout = false;
+const char * g_feat_prefix = NULL;
+const char * g_shm_prefix = NULL;
+double g_stats_interval = 5.0;
+FILE * g_stats_fp = stderr;
+
+// streams
+Stream * g_streams[SND_MAX_STREAMS];
+int g_num_streams = 0;
+// streams not done yet
+int g_open = 0;
+
+// the pool: one lock for the queues, workers wait on g_work, readers
+// with a full queue (--batch) on g_room
+pthread_mutex_t g_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t g_work = PTHREAD_COND_INITIALIZER;
+pthread_cond_t g_room = PTHREAD_COND_INITIALIZER;
+// text output from several workers
+pthread_mutex_t g_print_mutex = PTHREAD_MUTEX_INITIALIZER;
+// (guarded by g_mutex) usec spent analyzing, since the last report
+double g_busy_usec = 0;
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: usage()
+// desc: ...
+//-----------------------------------------------------------------------------
+void usage()
+{
+    fprintf( stderr, "usage: sndpeekd --[options] stream [stream ...]\n" );
+    fprintf( stderr, "  streams are FIFOs, files or - (stdin)\n" );
+    fprintf( stderr, "  number options: threads (default: cpus)|winsize|hop|queue (hops per stream)|\n" );
+    fprintf( stderr, "                  srate|channels (raw formats)|stats (report interval, sec)\n" );
+    fprintf( stderr, "   other options: format (wav|f32|s16)|batch (files as fast as possible, no drops)|\n" );
+    fprintf( stderr, "                  print|featfile (prefix)|shm (name prefix)|statsfile (file or -)\n" );
+    fprintf( stderr, "\n" );
+    fprintf( stderr, "example:\n" );
+    fprintf( stderr, "    sndpeekd --threads:4 --format:f32 --featfile:out/ /tmp/mic*\n" );
+    fprintf( stderr, "\n" );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: finish_stream()
+// desc: (g_mutex held) a stream's last hop is done
+//-----------------------------------------------------------------------------
+void finish_stream( Stream * s )
+{
+    if( s->done || !s->eof || s->count || s->busy )
+        return;
+
+    s->done = true;
+    g_open--;
+    // idle workers may be waiting for nothing now
+    if( !g_open )
+        pthread_cond_broadcast( &g_work );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: reader()
+// desc: one stream's thread: reads, downmixes and queues each hop
+//-----------------------------------------------------------------------------
+void * reader( void * arg )
+{
+    Stream * s = (Stream *)arg;
+    int W = g_win_size, H = g_hop_size, C = s->channels, i, c;
+    float * frames = new float[H * C];
+    float * window = new float[W];
+    double start = stats_now_usec();
+    long pos = 0, n;
+
+    memset( window, 0, W * sizeof(float) );
+
+    while( ( n = pcm_stream_read( s->pcm, frames, H ) ) > 0 )
+    {
+        // slide by a hop; a short read (the end) is zero padded
+        memmove( window, window + H, ( W - H ) * sizeof(float) );
+        for( i = 0; i < H; i++ )
+        {
+            float sum = 0;
+            if( i < n )
+                for( c = 0; c < C; c++ )
+                    sum += frames[i * C + c];
+            window[W - H + i] = sum / C;
+        }
+        pos += n;
+        // the first whole window
+        if( pos < W )
+            continue;
+
+        // a file arrives as fast as a live stream would
+        if( s->pace )
+        {
+            double due = start + 1e6 * pos / s->srate;
+            double now = stats_now_usec();
+            if( due > now )
+                usleep( (useconds_t)( due - now ) );
+        }
+
+        pthread_mutex_lock( &g_mutex );
+        if( s->count == g_queue_size )
+        {
+            if( g_batch )
+            {
+                while( s->count == g_queue_size )
+                    pthread_cond_wait( &g_room, &g_mutex );
+            }
+            else
+            {
+                // behind: the oldest hop is the least use
+                s->head = ( s->head + 1 ) % g_queue_size;
+                s->count--;
+                s->dropped++;
+            }
+        }
+        Hop & h = s->queue[( s->head + s->count ) % g_queue_size];
+        memcpy( h.samples, window, W * sizeof(float) );
+        h.pos = pos - W;
+        h.arrival = stats_now_usec();
+        h.deadline = h.arrival + 1e6 * H / s->srate;
+        s->count++;
+        pthread_cond_signal( &g_work );
+        pthread_mutex_unlock( &g_mutex );
+    }
+
+    pthread_mutex_lock( &g_mutex );
+    s->eof = true;
+    finish_stream( s );
+    pthread_mutex_unlock( &g_mutex );
+
+    delete [] frames;
+    delete [] window;
+
+    return NULL;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: output()
+// desc: one frame of one stream's features, wherever they go
+//-----------------------------------------------------------------------------
+void output( Stream * s, double time )
+{
+    float bus[SND_BUS_SIZE];
+    float * values = bus + 2;
+
+    s->analyzer.get_features( values );
+
+    if( s->out )
+        feature_writer_write( s->out, time, values );
+
+    if( s->shm )
+    {
+        bus[0] = (float)time;
+        bus[1] = (float)s->id;
+        s->shm->send_vector( bus, SND_BUS_SIZE );
+    }
+
+    if( g_stdout )
+    {
+        pthread_mutex_lock( &g_print_mutex );
+        fprintf( stdout, "s%i  %.3f  ", s->id, time );
+        for( int i = 0; i < ANALYZE_COLUMNS; i++ )
+            fprintf( stdout, i == 2 ? "%.8f  " : "%.2f  ", values[i] );
+        fprintf( stdout, "\n" );
+        pthread_mutex_unlock( &g_print_mutex );
+    }
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: worker()
+// desc: analyzes whichever queued hop is due first, until all streams end
+//-----------------------------------------------------------------------------
+void * worker( void * )
+{
+    float * frame = new float[g_win_size];
+    Stream * s;
+    int i;
+
+    pthread_mutex_lock( &g_mutex );
+    while( true )
+    {
+        // earliest deadline among the streams nobody has
+        s = NULL;
+        for( i = 0; i < g_num_streams; i++ )
+        {
+            Stream * t = g_streams[i];
+            if( t->busy || !t->count )
+                continue;
+            if( !s || t->queue[t->head].deadline < s->queue[s->head].deadline )
+                s = t;
+        }
+
+        if( !s )
+        {
+            if( !g_open )
+                break;
+            pthread_cond_wait( &g_work, &g_mutex );
+            continue;
+        }
+
+        // take it
+        Hop & h = s->queue[s->head];
+        double arrival = h.arrival, deadline = h.deadline;
+        long pos = h.pos;
+        memcpy( frame, h.samples, g_win_size * sizeof(float) );
+        s->head = ( s->head + 1 ) % g_queue_size;
+        s->count--;
+        s->busy = true;
+        if( g_batch )
+            pthread_cond_broadcast( &g_room );
+        pthread_mutex_unlock( &g_mutex );
+
+        // the work
+        double begin = stats_now_usec();
+        s->analyzer.analyze( frame );
+        output( s, (double)pos / s->srate );
+        double end = stats_now_usec();
+
+        pthread_mutex_lock( &g_mutex );
+        s->busy = false;
+        s->hops++;
+        if( end > deadline )
+            s->late++;
+        s->latency.add( end - arrival );
+        g_busy_usec += end - begin;
+        finish_stream( s );
+    }
+    pthread_mutex_unlock( &g_mutex );
+
+    delete [] frame;
+
+    return NULL;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: report()
+// desc: one line of JSON per interval: pool use, then per stream the hops
+//       done, late (done after the next hop arrived) and dropped, and the
+//       time from queue to done (usec)
+//-----------------------------------------------------------------------------
+void report( double begin, double & last )
+{
+    double now = stats_now_usec();
+    double secs = ( now - last ) / 1e6;
+    int i;
+
+    pthread_mutex_lock( &g_mutex );
+    fprintf( g_stats_fp, "{\"time\":%.3f,\"interval\":%.3f,\"threads\":%i,\"open\":%i,"
+             "\"utilization\":%.3f,\"streams\":[", ( now - begin ) / 1e6, secs,
+             g_threads, g_open, g_busy_usec / ( g_threads * ( now - last ) ) );
+    for( i = 0; i < g_num_streams; i++ )
+    {
+        Stream * s = g_streams[i];
+        s->latency.roll();
+        fprintf( g_stats_fp, "%s{\"id\":%i,\"hops\":%lu,\"late\":%lu,\"dropped\":%lu,"
+                 "\"queued\":%i,\"latency\":{\"p50\":%.1f,\"p99\":%.1f,\"max\":%.1f},"
+                 "\"budget\":%.1f}", i ? "," : "", s->id, s->hops - s->last_hops,
+                 s->late - s->last_late, s->dropped - s->last_dropped, s->count,
+                 s->latency.percentile( .5 ), s->latency.percentile( .99 ),
+                 s->latency.max(), 1e6 * g_hop_size / s->srate );
+        s->last_hops = s->hops;
+        s->last_late = s->late;
+        s->last_dropped = s->dropped;
+    }
+    g_busy_usec = 0;
+    pthread_mutex_unlock( &g_mutex );
+
+    fprintf( g_stats_fp, "]}\n" );
+    fflush( g_stats_fp );
+    last = now;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: open_stream()
+// desc: ...
+//-----------------------------------------------------------------------------
+Stream * open_stream( int id, const char * path )
+{
+    Stream * s = new Stream;
+    struct stat st;
+    char name[1024];
+    int i;
+
+    s->id = id;
+    s->path = path;
+    s->fp = strcmp( path, "-" ) ? fopen( path, "rb" ) : stdin;
+    s->pcm = NULL;
+    s->out = NULL;
+    s->shm = NULL;
+    s->queue = NULL;
+    s->head = s->count = 0;
+    s->busy = s->eof = s->done = false;
+    s->hops = s->late = s->dropped = 0;
+    s->last_hops = s->last_late = s->last_dropped = 0;
+
+    if( !s->fp )
+    {
+        fprintf( stderr, "[sndpeekd]: error: cannot open '%s'...\n", path );
+        return NULL;
+    }
+    s->pace = !g_batch && !fstat( fileno( s->fp ), &st ) && S_ISREG( st.st_mode );
+
+    // a FIFO's writer may come later, this waits for the header
+    s->pcm = pcm_stream_open( s->fp, g_format, g_raw_srate, g_raw_channels );
+    if( !s->pcm )
+    {
+        fprintf( stderr, "[sndpeekd]: error: '%s' is not a stream sndpeekd can read...\n", path );
+        return NULL;
+    }
+    s->srate = pcm_stream_srate( s->pcm );
+    s->channels = pcm_stream_channels( s->pcm );
+
+    if( !s->analyzer.initialize( g_win_size ) )
+    {
+        fprintf( stderr, "[sndpeekd]: error: cannot initialize analysis...\n" );
+        return NULL;
+    }
+
+    s->queue = new Hop[g_queue_size];
+    for( i = 0; i < g_queue_size; i++ )
+        s->queue[i].samples = new float[g_win_size];
+
+    // binary features, <prefix><id>.feat
+    if( g_feat_prefix )
+    {
+        const char * columns[ANALYZE_COLUMNS];
+        int n = s->analyzer.feature_names( columns );
+        sprintf( name, "%.1000s%i.feat", g_feat_prefix, id );
+        s->out = feature_writer_open( name, n, columns, 1, s->srate, g_win_size, g_win_size );
+        if( !s->out )
+        {
+            fprintf( stderr, "[sndpeekd]: error: cannot open feature file '%s'...\n", name );
+            return NULL;
+        }
+    }
+
+    // shared memory ring, <prefix><id>
+    if( g_shm_prefix )
+    {
+        sprintf( name, "%.1000s%i", g_shm_prefix, id );
+        s->shm = new ShmCommunicator( name, SND_BUS_SIZE );
+        if( !s->shm->ok() )
+        {
+            fprintf( stderr, "[sndpeekd]: error: cannot create shared memory '%s'...\n", name );
+            return NULL;
+        }
+    }
+
+    return s;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: close_stream()
+// desc: ...
+//-----------------------------------------------------------------------------
+void close_stream( Stream * s )
+{
+    feature_writer_close( s->out );
+    delete s->shm;
+    pcm_stream_close( s->pcm );
+    if( s->fp != stdin )
+        fclose( s->fp );
+    for( int i = 0; i < g_queue_size; i++ )
+        delete [] s->queue[i].samples;
+    delete [] s->queue;
+    delete s;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: main()
+// desc: entry point
+//-----------------------------------------------------------------------------
+int main( int argc, char ** argv )
+{
+    const char * paths[SND_MAX_STREAMS];
+    int num_paths = 0, i;
+
+    // command line arguments
+    for( i = 1; i < argc; i++ )
+    {
+        if( !strncmp( argv[i], "--", 2 ) )
+        {
+            if( !strncmp( argv[i], "--threads:", 10 ) )
+                g_threads = atoi( argv[i]+10 );
+            else if( !strncmp( argv[i], "--winsize:", 10 ) )
+                g_win_size = atoi( argv[i]+10 );
+            else if( !strncmp( argv[i], "--hop:", 6 ) )
+                g_hop_size = atoi( argv[i]+6 );
+            else if( !strncmp( argv[i], "--queue:", 8 ) )
+                g_queue_size = atoi( argv[i]+8 );
+            else if( !strncmp( argv[i], "--format:", 9 ) )
+                g_format = pcm_stream_format( argv[i]+9 );
+            else if( !strncmp( argv[i], "--srate:", 8 ) )
+                g_raw_srate = atoi( argv[i]+8 );
+            else if( !strncmp( argv[i], "--channels:", 11 ) )
+                g_raw_channels = atoi( argv[i]+11 );
+            else if( !strcmp( argv[i], "--batch" ) )
+                g_batch = true;
+            else if( !strcmp( argv[i], "--print" ) )
+                g_stdout = true;
+            else if( !strncmp( argv[i], "--featfile:", 11 ) )
+                g_feat_prefix = argv[i]+11;
+            else if( !strncmp( argv[i], "--shm:", 6 ) )
+                g_shm_prefix = argv[i]+6;
+            else if( !strncmp( argv[i], "--stats:", 8 ) )
+                g_stats_interval = atof( argv[i]+8 );
+            else if( !strncmp( argv[i], "--statsfile:", 12 ) )
+            {
+                g_stats_fp = strcmp( argv[i]+12, "-" ) ? fopen( argv[i]+12, "w" ) : stdout;
+                if( !g_stats_fp )
+                {
+                    fprintf( stderr, "[sndpeekd]: error: cannot open stats file '%s'...\n", argv[i]+12 );
+                    return -1;
+                }
+            }
+            else
+            {
+                fprintf( stderr, "[sndpeekd]: unrecognized option '%s'...\n", argv[i] );
+                usage();
+                return -1;
+            }
+        }
+        else if( num_paths < SND_MAX_STREAMS )
+            paths[num_paths++] = argv[i];
+        else
+        {
+            fprintf( stderr, "[sndpeekd]: error: more than %i streams...\n", SND_MAX_STREAMS );
+            return -1;
+        }
+    }
+
+    // check
+    if( !g_hop_size ) g_hop_size = g_win_size;
+    if( g_threads <= 0 ) g_threads = (int)sysconf( _SC_NPROCESSORS_ONLN );
+    if( g_threads <= 0 ) g_threads = 1;
+    if( !num_paths || g_win_size < 4 || ( g_win_size & ( g_win_size - 1 ) ) ||
+        g_hop_size < 1 || g_hop_size > g_win_size || g_queue_size < 1 || g_format < 0 ||
+        g_raw_srate <= 0 || g_raw_channels <= 0 || g_stats_interval <= 0 )
+    {
+        usage();
+        return -1;
+    }
+    if( g_stdout && g_stats_fp == stdout )
+    {
+        fprintf( stderr, "[sndpeekd]: error: --print and --statsfile:- both use stdout...\n" );
+        return -1;
+    }
+
+    // rfft sets up its constants on first use, before any threads
+    float warm[4] = { 0, 0, 0, 0 };
+    rfft( warm, 2, FFT_FORWARD );
+
+    // streams (each waits here for its header)
+    for( i = 0; i < num_paths; i++ )
+    {
+        if( !( g_streams[i] = open_stream( i, paths[i] ) ) )
+            return -1;
+        g_num_streams++;
+    }
+    g_open = g_num_streams;
+
+    // the pool, then the readers
+    pthread_t * workers = new pthread_t[g_threads];
+    for( i = 0; i < g_threads; i++ )
+        if( pthread_create( &workers[i], NULL, worker, NULL ) )
+        {
+            fprintf( stderr, "[sndpeekd]: error: cannot start worker threads...\n" );
+            return -1;
+        }
+    for( i = 0; i < g_num_streams; i++ )
+        if( pthread_create( &g_streams[i]->reader, NULL, reader, g_streams[i] ) )
+        {
+            fprintf( stderr, "[sndpeekd]: error: cannot start reader threads...\n" );
+            return -1;
+        }
+
+    fprintf( stderr, "[sndpeekd]: %i stream(s), %i thread(s), window %i, hop %i...\n",
+             g_num_streams, g_threads, g_win_size, g_hop_size );
+
+    // report until every stream has ended
+    double begin = stats_now_usec(), last = begin;
+    while( true )
+    {
+        pthread_mutex_lock( &g_mutex );
+        int open = g_open;
+        pthread_mutex_unlock( &g_mutex );
+        if( !open )
+            break;
+        usleep( 100000 );
+        if( stats_now_usec() - last >= g_stats_interval * 1e6 )
+            report( begin, last );
+    }
+    report( begin, last );
+
+    // done
+    for( i = 0; i < g_num_streams; i++ )
+        pthread_join( g_streams[i]->reader, NULL );
+    for( i = 0; i < g_threads; i++ )
+        pthread_join( workers[i], NULL );
+    for( i = 0; i < g_num_streams; i++ )
+        close_stream( g_streams[i] );
+    delete [] workers;
+
+    return 0;
+}
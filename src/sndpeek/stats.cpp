@@ -0,0 +1,183 @@
+//-----------------------------------------------------------------------------
+// name: stats.cpp
+// desc: timing / depth histograms for instrumenting the processing stages
+//-----------------------------------------------------------------------------
+#include "stats.h"
+#include "ringbuffer.h"
+#include <math.h>
+#include <memory.h>
+
+#if defined(_MSC_VER)
+  #include <windows.h>
+#else
+  #include <time.h>
+  #include <sys/time.h>
+#endif
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: stats_now_usec()
+// desc: ...
+//-----------------------------------------------------------------------------
+double stats_now_usec()
+{
+#if defined(_MSC_VER)
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER now;
+    if( !freq.QuadPart ) QueryPerformanceFrequency( &freq );
+    QueryPerformanceCounter( &now );
+    return now.QuadPart * 1e6 / (double)freq.QuadPart;
+#elif defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+#else
+    struct timeval tv;
+    gettimeofday( &tv, NULL );
+    return tv.tv_sec * 1e6 + tv.tv_usec;
+#endif
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: StatHistogram()
+// desc: ...
+//-----------------------------------------------------------------------------
+StatHistogram::StatHistogram()
+{
+    memset( m_banks, 0, sizeof(m_banks) );
+    m_cur = 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: bucket()
+// desc: 4 buckets per octave of (value + 1)
+//-----------------------------------------------------------------------------
+int StatHistogram::bucket( double value )
+{
+    if( !( value > 0 ) ) return 0;
+    int b = (int)( 4.0 * log( value + 1.0 ) / log( 2.0 ) );
+    return b < NUM_BUCKETS ? b : NUM_BUCKETS - 1;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: bucket_value()
+// desc: middle of a bucket (geometrically)
+//-----------------------------------------------------------------------------
+double StatHistogram::bucket_value( int b )
+{
+    return pow( 2.0, ( b + .5 ) / 4.0 ) - 1.0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: add()
+// desc: ...
+//-----------------------------------------------------------------------------
+void StatHistogram::add( double value )
+{
+    Bank & bank = m_banks[m_cur];
+
+    bank.counts[bucket( value )]++;
+    bank.n++;
+    bank.sum += value;
+    if( value > bank.max ) bank.max = value;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: roll()
+// desc: ...
+//-----------------------------------------------------------------------------
+void StatHistogram::roll()
+{
+    // the idle bank becomes the next interval (the writer isn't on it)
+    memset( &m_banks[!m_cur], 0, sizeof(Bank) );
+    RingBuffer::fence();
+    m_cur = !m_cur;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: count() / mean() / max()
+// desc: ...
+//-----------------------------------------------------------------------------
+unsigned long StatHistogram::count() const
+{
+    return m_banks[!m_cur].n;
+}
+
+double StatHistogram::mean() const
+{
+    const Bank & bank = m_banks[!m_cur];
+    return bank.n ? bank.sum / bank.n : 0;
+}
+
+double StatHistogram::max() const
+{
+    return m_banks[!m_cur].max;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: percentile()
+// desc: ...
+//-----------------------------------------------------------------------------
+double StatHistogram::percentile( double p ) const
+{
+    const Bank & bank = m_banks[!m_cur];
+    if( !bank.n ) return 0;
+
+    // rank of the sample we want
+    unsigned long rank = (unsigned long)( p * bank.n + .5 ), seen = 0;
+    if( rank < 1 ) rank = 1;
+    if( rank > bank.n ) rank = bank.n;
+
+    for( int b = 0; b < NUM_BUCKETS; b++ )
+    {
+        seen += bank.counts[b];
+        if( seen >= rank )
+        {
+            // never report past the largest value seen
+            double v = bucket_value( b );
+            return v < bank.max ? v : bank.max;
+        }
+    }
+
+    return bank.max;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: summarize()
+// desc: ...
+//-----------------------------------------------------------------------------
+void StatHistogram::summarize( StatSummary & s ) const
+{
+    s.count = count();
+    s.mean = mean();
+    s.p50 = percentile( .5 );
+    s.p90 = percentile( .9 );
+    s.p99 = percentile( .99 );
+    s.max = max();
+}
@@ -0,0 +1,87 @@
+//-----------------------------------------------------------------------------
+// name: stats.h
+// desc: timing / depth histograms for instrumenting the processing stages
+//
+//       values go into log-spaced buckets (4 per octave), so recording is
+//       a few instructions and percentiles cost nothing until asked for.
+//       a histogram collects over an interval; roll() closes the interval
+//       and the queries then describe the one just closed, while the
+//       writer carries on into a fresh one.  the rolling thread is the
+//       only one that may query; anyone else gets a StatSummary from it.
+//-----------------------------------------------------------------------------
+#ifndef __STATS_H__
+#define __STATS_H__
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: struct StatSummary
+// desc: the figures for one closed interval, as plain data to pass around
+//-----------------------------------------------------------------------------
+struct StatSummary
+{
+    unsigned long count;
+    double mean;
+    double p50, p90, p99;
+    double max;
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: class StatHistogram
+// desc: one writer thread add()s, one other thread roll()s and queries;
+//       the next roll() clears the bank the queries read, so no third
+//       thread may query -- hand it a summarize()d copy instead
+//-----------------------------------------------------------------------------
+class StatHistogram
+{
+public:
+    StatHistogram();
+
+public: // writer
+    void add( double value );
+
+public: // reader
+    // close the current interval
+    void roll();
+    // over the last closed interval
+    unsigned long count() const;
+    double mean() const;
+    double max() const;
+    // p in [0,1]; resolution is the bucket width (~19%)
+    double percentile( double p ) const;
+    // all of the above at once
+    void summarize( StatSummary & s ) const;
+
+protected:
+    enum { NUM_BUCKETS = 160 };
+    struct Bank
+    {
+        unsigned long counts[NUM_BUCKETS];
+        unsigned long n;
+        double sum;
+        double max;
+    };
+
+    static int bucket( double value );
+    static double bucket_value( int b );
+
+protected:
+    Bank m_banks[2];
+    // bank being written
+    volatile int m_cur;
+};
+
+
+
+
+// monotonic time in microseconds
+double stats_now_usec();
+
+
+
+
+#endif
@@ -0,0 +1,432 @@
+//-----------------------------------------------------------------------------
+// name: stft_cache.cpp
+// desc: persistent, memory-mapped cache of a sound file's magnitude STFT
+//-----------------------------------------------------------------------------
+#include "stft_cache.h"
+#include "chuck_fft.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <memory.h>
+#include <math.h>
+
+// libsndfile
+#if defined(__USE_SNDFILE_NATIVE__)
+#include <sndfile.h>
+#else
+#include "util_sndfile.h"
+#endif
+
+// mapping
+#if defined(__WINDOWS_DS__) || defined(__WINDOWS_ASIO__)
+  #define __STFT_NO_MMAP__
+#else
+  #include <sys/types.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+
+
+
+// file layout: header padded to one page, then frames x bins of uint16
+#define STFT_MAGIC          "SPKSTFT1"
+#define STFT_VERSION        1
+#define STFT_HEADER_SIZE    4096
+// quantization range (dB re: unit magnitude)
+#define STFT_DB_MIN         -100.0f
+#define STFT_DB_MAX         60.0f
+#define STFT_QMAX           65535.0f
+
+// on-disk header
+struct stft_header
+{
+    char magic[8];
+    unsigned int version;
+    unsigned int header_size;
+    unsigned long long file_hash;
+    unsigned long long file_size;
+    unsigned int srate;
+    unsigned int channels;
+    unsigned int win_size;
+    unsigned int fft_size;
+    unsigned int hop_size;
+    unsigned int bins;
+    unsigned int quant_bits;
+    float db_min;
+    float db_max;
+    unsigned long long frames;
+};
+
+// internal data structure
+struct stft_cache_
+{
+    stft_header header;
+    // start of the mapping (or of the malloc'ed copy)
+    unsigned char * base;
+    size_t base_size;
+    // first quantized frame
+    unsigned short * data;
+    // dB per quantization step
+    float step;
+};
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: stft_hash_file()
+// desc: FNV-1a 64 over the raw file contents
+//-----------------------------------------------------------------------------
+static bool stft_hash_file( const char * filename, unsigned long long * hash,
+                            unsigned long long * size )
+{
+    FILE * f = fopen( filename, "rb" );
+    if( !f ) return false;
+
+    static unsigned char block[65536];
+    unsigned long long h = 14695981039346656037ULL;
+    unsigned long long total = 0;
+    size_t n, i;
+
+    while( (n = fread( block, 1, sizeof(block), f )) > 0 )
+    {
+        for( i = 0; i < n; i++ )
+        {
+            h ^= block[i];
+            h *= 1099511628211ULL;
+        }
+        total += n;
+    }
+
+    fclose( f );
+    *hash = h;
+    *size = total;
+    return true;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: stft_quantize()
+// desc: magnitude -> 16-bit log
+//-----------------------------------------------------------------------------
+static inline unsigned short stft_quantize( float mag )
+{
+    if( mag <= 0.0f ) return 0;
+    float q = ( 20.0f * log10f( mag ) - STFT_DB_MIN ) /
+              ( STFT_DB_MAX - STFT_DB_MIN ) * STFT_QMAX;
+    if( q < 1.0f ) return 0;
+    if( q > STFT_QMAX ) return (unsigned short)STFT_QMAX;
+    return (unsigned short)( q + .5f );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: stft_read_mono()
+// desc: read up to len frames, mixed down to mono; returns frames read
+//-----------------------------------------------------------------------------
+static int stft_read_mono( SNDFILE * sf, float * interleaved, int chans,
+                           float * mono, int len )
+{
+    sf_count_t count = sf_readf_float( sf, interleaved, len );
+    if( count <= 0 ) return 0;
+
+    for( int i = 0; i < count; i++ )
+    {
+        float sum = 0.0f;
+        for( int c = 0; c < chans; c++ ) sum += interleaved[i*chans + c];
+        mono[i] = sum / chans;
+    }
+
+    return (int)count;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: stft_build()
+// desc: analyze the whole file and write the cache to 'cachefile'
+//-----------------------------------------------------------------------------
+static bool stft_build( const char * filename, const char * cachefile,
+                        stft_header * header )
+{
+    SF_INFO info;
+    memset( &info, 0, sizeof(info) );
+    SNDFILE * sf = sf_open( filename, SFM_READ, &info );
+    if( !sf ) return false;
+
+    // write to a temporary name, rename when complete
+    char * tmpfile = new char[strlen(cachefile) + 8];
+    sprintf( tmpfile, "%s.tmp", cachefile );
+    FILE * out = fopen( tmpfile, "wb" );
+    if( !out )
+    {
+        sf_close( sf );
+        delete [] tmpfile;
+        return false;
+    }
+
+    int win = header->win_size, fft = header->fft_size, hop = header->hop_size;
+    int bins = header->bins, chans = info.channels;
+    header->srate = info.samplerate;
+    header->channels = chans;
+
+    // reserve header space
+    unsigned char * pad = new unsigned char[STFT_HEADER_SIZE];
+    memset( pad, 0, STFT_HEADER_SIZE );
+    fwrite( pad, 1, STFT_HEADER_SIZE, out );
+
+    float * window = new float[win];
+    float * frame = new float[win];
+    float * buffer = new float[fft];
+    float * interleaved = new float[win * chans];
+    unsigned short * row = new unsigned short[bins];
+    hanning( window, win );
+
+    // frame k covers samples [k*hop, k*hop + win)
+    unsigned long long frames = 0;
+    int i, fill, got;
+    bool ok = true;
+
+    fprintf( stderr, "[sndpeek]: analyzing '%s' into cache...\n", filename );
+
+    // prime the first frame
+    fill = stft_read_mono( sf, interleaved, chans, frame, win );
+    while( fill > 0 )
+    {
+        // partial last frame: zero the tail
+        if( fill < win )
+            memset( frame + fill, 0, (win - fill) * sizeof(float) );
+
+        // window, zero-pad, transform
+        memset( buffer, 0, fft * sizeof(float) );
+        memcpy( buffer, frame, win * sizeof(float) );
+        apply_window( buffer, window, win );
+        rfft( buffer, fft/2, FFT_FORWARD );
+        complex * cbuf = (complex *)buffer;
+        for( i = 0; i < bins; i++ )
+            row[i] = stft_quantize( (float)cmp_abs( cbuf[i] ) );
+
+        if( fwrite( row, sizeof(unsigned short), bins, out ) != (size_t)bins )
+        {
+            ok = false;
+            break;
+        }
+        frames++;
+
+        // that was the last one
+        if( fill < win ) break;
+
+        // slide by one hop
+        memmove( frame, frame + hop, (win - hop) * sizeof(float) );
+        got = stft_read_mono( sf, interleaved, chans, frame + win - hop, hop );
+        if( got <= 0 ) break;
+        fill = win - hop + got;
+    }
+
+    // finish header
+    header->frames = frames;
+    fseek( out, 0, SEEK_SET );
+    if( fwrite( header, sizeof(stft_header), 1, out ) != 1 ) ok = false;
+    if( fclose( out ) ) ok = false;
+    sf_close( sf );
+
+    // publish (replacing any stale cache)
+    if( ok )
+    {
+        remove( cachefile );
+        ok = ( rename( tmpfile, cachefile ) == 0 );
+    }
+    if( !ok ) remove( tmpfile );
+    else fprintf( stderr, "[sndpeek]: wrote %llu frames to '%s'\n", frames, cachefile );
+
+    delete [] pad;
+    delete [] window;
+    delete [] frame;
+    delete [] buffer;
+    delete [] interleaved;
+    delete [] row;
+    delete [] tmpfile;
+
+    return ok;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: stft_map()
+// desc: map an existing cache; fails if it doesn't match 'want'
+//-----------------------------------------------------------------------------
+static bool stft_map( const char * cachefile, const stft_header * want,
+                      stft_cache_ * cache )
+{
+    stft_header h;
+    FILE * f = fopen( cachefile, "rb" );
+    if( !f ) return false;
+    bool ok = ( fread( &h, sizeof(h), 1, f ) == 1 );
+    fclose( f );
+
+    // validate key
+    if( !ok || memcmp( h.magic, STFT_MAGIC, 8 ) ||
+        h.version != STFT_VERSION ||
+        h.header_size != STFT_HEADER_SIZE ||
+        h.file_hash != want->file_hash ||
+        h.file_size != want->file_size ||
+        h.win_size != want->win_size ||
+        h.fft_size != want->fft_size ||
+        h.hop_size != want->hop_size ||
+        h.bins != want->bins ||
+        h.quant_bits != 16 )
+        return false;
+
+    size_t size = STFT_HEADER_SIZE + (size_t)h.frames * h.bins * sizeof(unsigned short);
+
+#if !defined(__STFT_NO_MMAP__)
+    int fd = open( cachefile, O_RDONLY );
+    if( fd < 0 ) return false;
+    struct stat st;
+    if( fstat( fd, &st ) || (size_t)st.st_size < size )
+    {
+        close( fd );
+        return false;
+    }
+    void * base = mmap( NULL, size, PROT_READ, MAP_SHARED, fd, 0 );
+    close( fd );
+    if( base == MAP_FAILED ) return false;
+#else
+    // no mmap: read it all in
+    f = fopen( cachefile, "rb" );
+    if( !f ) return false;
+    void * base = malloc( size );
+    if( !base || fread( base, 1, size, f ) != size )
+    {
+        if( base ) free( base );
+        fclose( f );
+        return false;
+    }
+    fclose( f );
+#endif
+
+    cache->header = h;
+    cache->base = (unsigned char *)base;
+    cache->base_size = size;
+    cache->data = (unsigned short *)( cache->base + STFT_HEADER_SIZE );
+    cache->step = ( h.db_max - h.db_min ) / STFT_QMAX;
+
+    return true;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: stft_cache_open()
+// desc: ...
+//-----------------------------------------------------------------------------
+stft_cache stft_cache_open( const char * filename, const char * cachefile,
+                            int win_size, int fft_size, int hop_size )
+{
+    // hop may not skip samples
+    if( hop_size <= 0 || hop_size > win_size || fft_size < win_size )
+        return NULL;
+
+    // the key
+    stft_header key;
+    memset( &key, 0, sizeof(key) );
+    memcpy( key.magic, STFT_MAGIC, 8 );
+    key.version = STFT_VERSION;
+    key.header_size = STFT_HEADER_SIZE;
+    key.win_size = win_size;
+    key.fft_size = fft_size;
+    key.hop_size = hop_size;
+    key.bins = fft_size / 2;
+    key.quant_bits = 16;
+    key.db_min = STFT_DB_MIN;
+    key.db_max = STFT_DB_MAX;
+    if( !stft_hash_file( filename, &key.file_hash, &key.file_size ) )
+        return NULL;
+
+    // default location
+    char * name = NULL;
+    if( !cachefile )
+    {
+        name = new char[strlen(filename) + 8];
+        sprintf( name, "%s.stft", filename );
+        cachefile = name;
+    }
+
+    stft_cache cache = new stft_cache_;
+    memset( cache, 0, sizeof(stft_cache_) );
+
+    // try existing, else analyze and try again
+    bool ok = stft_map( cachefile, &key, cache );
+    if( !ok )
+    {
+        stft_header h = key;
+        ok = stft_build( filename, cachefile, &h ) &&
+             stft_map( cachefile, &key, cache );
+    }
+    else
+        fprintf( stderr, "[sndpeek]: using STFT cache '%s'\n", cachefile );
+
+    if( name ) delete [] name;
+    if( !ok )
+    {
+        delete cache;
+        return NULL;
+    }
+
+    return cache;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: stft_cache_get()
+// desc: ...
+//-----------------------------------------------------------------------------
+bool stft_cache_get( stft_cache cache, long frame, float * mag )
+{
+    if( !cache || frame < 0 || frame >= (long)cache->header.frames )
+        return false;
+
+    int bins = cache->header.bins;
+    const unsigned short * row = cache->data + (size_t)frame * bins;
+    float db_min = cache->header.db_min, step = cache->step;
+
+    // q == 0 is silence, anything else is a log magnitude
+    for( int i = 0; i < bins; i++ )
+        mag[i] = row[i] ? (float)pow( 10.0, ( db_min + row[i] * step ) / 20.0 ) : 0;
+
+    return true;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: stft_cache_close()
+// desc: ...
+//-----------------------------------------------------------------------------
+void stft_cache_close( stft_cache & cache )
+{
+    if( !cache ) return;
+
+#if !defined(__STFT_NO_MMAP__)
+    if( cache->base ) munmap( cache->base, cache->base_size );
+#else
+    if( cache->base ) free( cache->base );
+#endif
+
+    delete cache;
+    cache = NULL;
+}
@@ -0,0 +1,29 @@
+//-----------------------------------------------------------------------------
+// name: stft_cache.h
+// desc: persistent, memory-mapped cache of a sound file's magnitude STFT
+//
+//       the whole file is analyzed once (same window/fft as the display),
+//       magnitudes are quantized to 16-bit log scale and written next to
+//       the file; later runs with the same file contents and analysis
+//       parameters map the cache instead of analyzing again.
+//-----------------------------------------------------------------------------
+#ifndef __STFT_CACHE_H__
+#define __STFT_CACHE_H__
+
+// forward reference
+typedef struct stft_cache_ * stft_cache;
+
+
+// open the cache for 'filename' (building it first if missing or stale)
+// cachefile may be NULL, in which case "<filename>.stft" is used
+stft_cache stft_cache_open( const char * filename, const char * cachefile,
+                            int win_size, int fft_size, int hop_size );
+// dequantize the magnitudes of one frame, false if out of range
+bool stft_cache_get( stft_cache cache, long frame, float * mag );
+// done
+void stft_cache_close( stft_cache & cache );
+
+
+
+
+#endif
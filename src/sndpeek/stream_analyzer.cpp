@@ -0,0 +1,246 @@
+//-----------------------------------------------------------------------------
+// name: stream_analyzer.cpp
+// desc: per-stream analysis state and the marsyas features
+//-----------------------------------------------------------------------------
+#include "stream_analyzer.h"
+#include "chuck_fft.h"
+#include "stats.h"
+#include "Centroid.h"
+#include "Flux.h"
+#include "LPC.h"
+#include "MFCC.h"
+#include "RMS.h"
+#include "Rolloff.h"
+#include "Yin.h"
+#include <stdlib.h>
+#include <memory.h>
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: StreamAnalyzer()
+// desc: ...
+//-----------------------------------------------------------------------------
+StreamAnalyzer::StreamAnalyzer()
+{
+    m_win_size = m_bins = 0;
+    m_window = m_fft = NULL;
+    m_stats = NULL;
+    m_centroid_sys = NULL; m_flux_sys = NULL; m_lpc_sys = NULL;
+    m_mfcc_sys = NULL; m_rms_sys = NULL;
+    m_rolloff_sys = m_rolloff2_sys = NULL;
+    m_yin_sys = NULL;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: ~StreamAnalyzer()
+// desc: ...
+//-----------------------------------------------------------------------------
+StreamAnalyzer::~StreamAnalyzer()
+{
+    this->cleanup();
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: initialize()
+// desc: ...
+//-----------------------------------------------------------------------------
+bool StreamAnalyzer::initialize( int win_size )
+{
+    this->cleanup();
+
+    if( win_size < 4 || ( win_size & ( win_size - 1 ) ) )
+        return false;
+
+    m_win_size = win_size;
+    m_bins = win_size / 2;
+
+    m_window = new float[win_size];
+    hanning( m_window, win_size );
+    m_fft = new float[win_size];
+
+    // the same modules, and sizes, sndpeek has always used
+    m_centroid_sys = new Centroid( m_bins );
+    m_flux_sys = new Flux( m_bins );
+    m_lpc_sys = new LPC( m_bins );
+    m_lpc_sys->init();
+    m_mfcc_sys = new MFCC( m_bins, 0 );
+    m_mfcc_sys->init();
+    m_rms_sys = new RMS( m_bins );
+    m_rolloff_sys = new Rolloff( m_bins, 0.5f );
+    m_rolloff2_sys = new Rolloff( m_bins, 0.8f );
+    // (on the samples, not the spectrum)
+    m_yin_sys = new Yin( win_size );
+
+    m_in.create( m_bins );
+    m_frame.create( win_size );
+    m_pitch.create( m_yin_sys->outSize() );
+    m_centroid.create( 1 ); m_flux.create( 1 ); m_rms.create( 1 );
+    m_rolloff.create( 1 ); m_rolloff2.create( 1 );
+    m_lpc.create( m_lpc_sys->outSize() );
+    m_mfcc.create( m_mfcc_sys->outSize() );
+
+    // in the order get_features() writes them
+    System * modules[] = { m_centroid_sys, m_flux_sys, m_rms_sys, m_rolloff_sys,
+                           m_rolloff2_sys, m_mfcc_sys };
+    for( unsigned int m = 0; m < sizeof(modules) / sizeof(modules[0]); m++ )
+    {
+        vector<string> own = modules[m]->featNames();
+        for( unsigned int i = 0; i < modules[m]->outSize(); i++ )
+            m_names.push_back( i < own.size() ? own[i] : string( "unnamed" ) );
+    }
+
+    return m_names.size() == ANALYZE_COLUMNS;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: cleanup()
+// desc: ...
+//-----------------------------------------------------------------------------
+void StreamAnalyzer::cleanup()
+{
+    delete [] m_window; delete [] m_fft;
+    delete m_centroid_sys; delete m_flux_sys; delete m_lpc_sys;
+    delete m_mfcc_sys; delete m_rms_sys;
+    delete m_rolloff_sys; delete m_rolloff2_sys;
+    delete m_yin_sys;
+
+    m_window = m_fft = NULL;
+    m_centroid_sys = NULL; m_flux_sys = NULL; m_lpc_sys = NULL;
+    m_mfcc_sys = NULL; m_rms_sys = NULL;
+    m_rolloff_sys = m_rolloff2_sys = NULL;
+    m_yin_sys = NULL;
+    m_names.clear();
+    m_win_size = m_bins = 0;
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: run()
+// desc: one module, timed if there are stats
+//-----------------------------------------------------------------------------
+void StreamAnalyzer::run( int stage, System * module, fvec & in, fvec & out )
+{
+    if( !m_stats )
+    {
+        module->process( in, out );
+        return;
+    }
+
+    double start = stats_now_usec();
+    module->process( in, out );
+    m_stats[stage].add( stats_now_usec() - start );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: analyze()
+// desc: ...
+//-----------------------------------------------------------------------------
+void StreamAnalyzer::analyze( const float * samples, int which )
+{
+    float * mag = m_in.getData();
+    int i;
+
+    if( which & ANALYZE_PITCH )
+        this->track_pitch( samples );
+
+    // windowed copy, the caller's frame stays as it is
+    for( i = 0; i < m_win_size; i++ )
+        m_fft[i] = samples[i] * m_window[i];
+
+    // forward fft, win_size/2 complex values
+    double start = m_stats ? stats_now_usec() : 0;
+    rfft( m_fft, m_bins, FFT_FORWARD );
+    if( m_stats ) m_stats[STAGE_FFT].add( stats_now_usec() - start );
+    complex * cbuf = (complex *)m_fft;
+
+    // magnitude spectrum, in place for the modules
+    for( i = 0; i < m_bins; i++ )
+        mag[i] = cmp_abs( cbuf[i] );
+
+    this->features( NULL, which );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: features()
+// desc: mag NULL: the spectrum from analyze()
+//-----------------------------------------------------------------------------
+void StreamAnalyzer::features( const float * mag, int which )
+{
+    if( mag )
+        memcpy( m_in.getData(), mag, m_bins * sizeof(float) );
+
+    if( which & ANALYZE_SPECTRAL )
+    {
+        run( STAGE_CENTROID, m_centroid_sys, m_centroid );
+        run( STAGE_FLUX, m_flux_sys, m_flux );
+        run( STAGE_RMS, m_rms_sys, m_rms );
+        run( STAGE_ROLLOFF, m_rolloff_sys, m_rolloff );
+        run( STAGE_ROLLOFF2, m_rolloff2_sys, m_rolloff2 );
+    }
+    if( which & ANALYZE_LPC )
+        run( STAGE_LPC, m_lpc_sys, m_lpc );
+    if( which & ANALYZE_MFCC )
+        run( STAGE_MFCC, m_mfcc_sys, m_mfcc );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: track_pitch()
+// desc: ...
+//-----------------------------------------------------------------------------
+void StreamAnalyzer::track_pitch( const float * samples )
+{
+    memcpy( m_frame.getData(), samples, m_win_size * sizeof(float) );
+    run( STAGE_PITCH, m_yin_sys, m_frame, m_pitch );
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: feature_names()
+// desc: names must hold ANALYZE_COLUMNS; valid while initialized
+//-----------------------------------------------------------------------------
+int StreamAnalyzer::feature_names( const char ** names ) const
+{
+    for( unsigned int i = 0; i < m_names.size(); i++ )
+        names[i] = m_names[i].c_str();
+
+    return (int)m_names.size();
+}
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: get_features()
+// desc: values must hold ANALYZE_COLUMNS
+//-----------------------------------------------------------------------------
+void StreamAnalyzer::get_features( float * values ) const
+{
+    values[0] = m_centroid(0); values[1] = m_flux(0); values[2] = m_rms(0);
+    values[3] = m_rolloff(0); values[4] = m_rolloff2(0);
+    for( int i = 0; i < 13; i++ )
+        values[5 + i] = m_mfcc(i);
+}
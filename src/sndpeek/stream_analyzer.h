@@ -0,0 +1,121 @@
+//-----------------------------------------------------------------------------
+// name: stream_analyzer.h
+// desc: everything it takes to analyze one stream - window, fft scratch,
+//       the marsyas modules (which keep state from frame to frame, e.g.
+//       flux) and their results - so any number of streams can be
+//       analyzed side by side, on any thread, one frame at a time each.
+//-----------------------------------------------------------------------------
+#ifndef __STREAM_ANALYZER_H__
+#define __STREAM_ANALYZER_H__
+
+#include "System.h"
+
+class Centroid;
+class Flux;
+class LPC;
+class MFCC;
+class RMS;
+class Rolloff;
+class StatHistogram;
+class Yin;
+
+
+
+
+// what to compute from a spectrum
+#define ANALYZE_SPECTRAL    0x1     // centroid, flux, rms, rolloffs
+#define ANALYZE_LPC         0x2
+#define ANALYZE_MFCC        0x4
+#define ANALYZE_ALL         0x7
+// and from the samples (asked for, analyze() only, not among the columns)
+#define ANALYZE_PITCH       0x8     // yin: period, voicing
+
+// stages timed by set_stats(), in this order
+enum { STAGE_FFT = 0, STAGE_CENTROID, STAGE_FLUX, STAGE_RMS, STAGE_ROLLOFF,
+       STAGE_ROLLOFF2, STAGE_LPC, STAGE_MFCC, STAGE_PITCH, NUM_STAGES };
+
+// columns of one frame's features: centroid, flux, rms, two rolloffs, mfcc
+#define ANALYZE_COLUMNS     ( 5 + 13 )
+
+
+
+
+//-----------------------------------------------------------------------------
+// name: class StreamAnalyzer
+// desc: not thread safe itself, but shares nothing with other instances
+//-----------------------------------------------------------------------------
+class StreamAnalyzer
+{
+public:
+    StreamAnalyzer();
+    ~StreamAnalyzer();
+
+public:
+    // win_size samples per frame, a power of two
+    bool initialize( int win_size );
+    void cleanup();
+    // optional: NUM_STAGES histograms, in STAGE_* order
+    void set_stats( StatHistogram * stages ) { m_stats = stages; }
+
+public:
+    // one frame of samples (not modified): hann window, fft, then features
+    void analyze( const float * samples, int which = ANALYZE_ALL );
+    // features from a magnitude spectrum of bins() values
+    void features( const float * mag, int which = ANALYZE_ALL );
+    // pitch of one frame of samples (not modified), on its own
+    void track_pitch( const float * samples );
+
+public:
+    int win_size() const { return m_win_size; }
+    // win_size / 2
+    int bins() const { return m_bins; }
+    // the last frame's magnitude spectrum (analyze() only)
+    const float * spectrum() const { return m_in.data_; }
+    // column names, as the modules name them
+    int feature_names( const char ** names ) const;
+    // the last frame's features, in feature_names() order
+    void get_features( float * values ) const;
+
+public: // the last frame's results
+    float centroid() const { return m_centroid(0); }
+    float flux() const { return m_flux(0); }
+    float rms() const { return m_rms(0); }
+    float rolloff() const { return m_rolloff(0); }
+    float rolloff2() const { return m_rolloff2(0); }
+    fvec & lpc() { return m_lpc; }
+    fvec & mfcc() { return m_mfcc; }
+    // period (samples, 0: unvoiced) and voicing confidence (0 to 1)
+    float pitch() const { return m_pitch(0); }
+    float voicing() const { return m_pitch(1); }
+
+protected:
+    void run( int stage, System * module, fvec & out ) { run( stage, module, m_in, out ); }
+    void run( int stage, System * module, fvec & in, fvec & out );
+
+protected:
+    int m_win_size;
+    int m_bins;
+    float * m_window;
+    float * m_fft;
+    StatHistogram * m_stats;
+
+    // modules
+    Centroid * m_centroid_sys;
+    Flux * m_flux_sys;
+    LPC * m_lpc_sys;
+    MFCC * m_mfcc_sys;
+    RMS * m_rms_sys;
+    Rolloff * m_rolloff_sys;
+    Rolloff * m_rolloff2_sys;
+    Yin * m_yin_sys;
+    // input (the magnitude spectrum, the samples for pitch) and outputs
+    fvec m_in, m_frame;
+    fvec m_centroid, m_flux, m_lpc, m_mfcc, m_rms, m_rolloff, m_rolloff2, m_pitch;
+    // column names
+    vector<string> m_names;
+};
+
+
+
+
+#endif